@@ -0,0 +1,91 @@
+// === CPU geometry benchmarks (Google Benchmark) ===
+// g++ -O2 -std=c++17 -I. bench/geometry_bench.cpp sculpture_geometry.cpp thread_pool.cpp -lbenchmark -pthread -o geometry_bench
+// ./geometry_bench --benchmark_format=json --benchmark_out=geometry.json
+#include "sculpture_geometry.h"
+#include "thread_pool.h"
+
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// pools are expensive to spin up, so one per thread count for the whole run; 1 thread means no pool
+ThreadPool* poolFor(int threads) {
+    static std::map<int, std::unique_ptr<ThreadPool>> pools;
+    if (threads <= 1) return nullptr;
+    auto& p = pools[threads];
+    if (!p) p.reset(new ThreadPool(threads));
+    return p.get();
+}
+
+const char* kernelName(GeometryKernel k) {
+    switch (k) {
+    case GeometryKernel::Table: return "table";
+    case GeometryKernel::Simd:  return "simd";
+    default:                    return "scalar";
+    }
+}
+
+// args: kernel, resolution (rows = cols), threads
+void BM_SculptureVertices(benchmark::State& state) {
+    GeometryKernel kernel = (GeometryKernel)state.range(0);
+    int res = (int)state.range(1), threads = (int)state.range(2);
+    ThreadPool* pool = poolFor(threads);
+    std::vector<float> v;
+    float t = 0.0f;
+    for (auto _ : state) {
+        sculptureVertices(v, res, res, t, nullptr, SculptureShape(), kernel, pool);
+        benchmark::DoNotOptimize(v.data());
+        benchmark::ClobberMemory();
+        t += 1.0f / 60.0f;
+    }
+    int64_t verts = (int64_t)res * res;
+    state.SetLabel(kernelName(kernel));
+    state.SetItemsProcessed(state.iterations() * verts);
+    state.SetBytesProcessed(state.iterations() * verts * kVertexFloats * (int64_t)sizeof(float));
+    state.counters["vertices/s"] = benchmark::Counter((double)verts, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void vertexArgs(benchmark::internal::Benchmark* b) {
+    for (int kernel : { (int)GeometryKernel::Scalar, (int)GeometryKernel::Table, (int)GeometryKernel::Simd })
+        for (int res = 64; res <= 2048; res *= 2)
+            for (int threads : { 1, 2, 4, 8 }) {
+                if (kernel == (int)GeometryKernel::Scalar && threads > 1) continue; // scalar is single-threaded
+                b->Args({ kernel, res, threads });
+            }
+    b->ArgNames({ "kernel", "res", "threads" });
+}
+BENCHMARK(BM_SculptureVertices)->Apply(vertexArgs)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+// args: resolution, threads
+void BM_SculptureIndices(benchmark::State& state) {
+    int res = (int)state.range(0), threads = (int)state.range(1);
+    ThreadPool* pool = poolFor(threads);
+    std::vector<unsigned int> idx;
+    for (auto _ : state) {
+        sculptureIndices(idx, res, res, pool);
+        benchmark::DoNotOptimize(idx.data());
+        benchmark::ClobberMemory();
+    }
+    int64_t count = (int64_t)(res - 1) * res * 6;
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetBytesProcessed(state.iterations() * count * (int64_t)sizeof(unsigned int));
+}
+BENCHMARK(BM_SculptureIndices)->ArgsProduct({ benchmark::CreateRange(64, 2048, 2), { 1, 4 } })
+    ->ArgNames({ "res", "threads" })->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+void BM_LightCube(benchmark::State& state) {
+    for (auto _ : state) {
+        CubeGeometry cube = lightCubeGeometry();
+        benchmark::DoNotOptimize(cube);
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)sizeof(CubeGeometry));
+}
+BENCHMARK(BM_LightCube);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,493 @@
+// === gl-replay: re-issue a GL capture (multiple_lights --capture) in a context of its own ===
+// Loads the whole stream, creates a hidden window of the captured size and replays every call, as
+// fast as the driver goes or, with --pace, at the capture's frame timestamps. Prints a "stats ..."
+// line (per-frame issue time and frame-to-frame time). --loop N replays everything after the first
+// frame N more times, for steady-state profiling longer than the capture. --dump FILE writes the
+// default framebuffer after the last frame as a PPM (meaningful for captures taken with a window).
+//
+// g++ -O2 -std=c++17 -I. bench/gl_replay.cpp gl_capture.cpp frame_stats.cpp glad.c -lglfw -ldl -o gl_replay
+// ./multiple_lights --capture frames.kglc --capture-frames 120
+// ./gl_replay frames.kglc [--pace] [--loop N] [--window] [--dump last.ppm]
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "frame_stats.h"
+#include "gl_capture.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// capturing process's object names -> ours; names are small and dense, so a vector
+struct NameMap {
+    std::vector<GLuint> to;
+    GLuint operator()(GLuint n) const { return n < to.size() ? to[n] : n; }
+    void set(GLuint from, GLuint name) {
+        if (from >= to.size()) to.resize(from + 1, 0);
+        to[from] = name;
+    }
+};
+
+struct Reader {
+    const unsigned char* p;
+    const unsigned char* end;
+    template <class T> T get() {
+        T v{};
+        if ((size_t)(end - p) >= sizeof(T)) memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+    // returns the bytes in place; the stream outlives every call that reads them
+    const void* payload(uint32_t& bytes) {
+        bytes = get<uint32_t>();
+        const void* at = p;
+        p += bytes;
+        return bytes ? at : nullptr;
+    }
+    bool ok() const { return p <= end; }
+};
+
+struct Replayer {
+    NameMap buffers, textures, arrays, framebuffers, renderbuffers, queries, objects;   // objects: shaders and programs
+    std::vector<std::string> strings;
+    std::vector<GLsync> syncs;
+    std::unordered_map<GLuint, std::vector<GLint>> locations;   // per captured program, captured location -> ours
+    std::unordered_map<GLuint, std::vector<GLuint>> blocks;
+    std::vector<GLint>* currentLocations = nullptr;
+    std::vector<std::pair<GLenum, void*>> maps;
+    std::vector<unsigned char> scratch;
+    uint64_t calls = 0;
+
+    GLint loc(GLint l) const {
+        if (l < 0 || !currentLocations || (size_t)l >= currentLocations->size()) return l;
+        return (*currentLocations)[l];
+    }
+};
+
+const void* offsetPtr(int64_t o) { return (const void*)(intptr_t)o; }
+
+void genNames(Reader& in, void (APIENTRY* gen)(GLsizei, GLuint*), NameMap& map) {
+    GLsizei n = in.get<GLsizei>();
+    std::vector<GLuint> ours(n > 0 ? n : 0);
+    if (n > 0) gen(n, ours.data());
+    for (GLsizei i = 0; i < n; ++i) map.set(in.get<GLuint>(), ours[i]);
+}
+
+void deleteNames(Reader& in, void (APIENTRY* del)(GLsizei, const GLuint*), NameMap& map) {
+    GLsizei n = in.get<GLsizei>();
+    std::vector<GLuint> ours(n > 0 ? n : 0);
+    for (GLsizei i = 0; i < n; ++i) ours[i] = map(in.get<GLuint>());
+    if (n > 0) del(n, ours.data());
+}
+
+// one record; false on a record we don't know (newer stream or corruption)
+bool replayOne(Replayer& r, Reader& in, GlOp op) {
+    uint32_t bytes = 0;
+    ++r.calls;
+    switch (op) {
+    case GlOp::String: {
+        uint32_t id = in.get<uint32_t>();
+        const void* s = in.payload(bytes);
+        if (id >= r.strings.size()) r.strings.resize(id + 1);
+        r.strings[id].assign(s ? (const char*)s : "", bytes);
+        --r.calls;
+        break;
+    }
+    case GlOp::ActiveTexture: glActiveTexture(in.get<GLenum>()); break;
+    case GlOp::AttachShader: { GLuint p = in.get<GLuint>(), s = in.get<GLuint>(); glAttachShader(r.objects(p), r.objects(s)); break; }
+    case GlOp::BeginQuery: { GLenum t = in.get<GLenum>(); glBeginQuery(t, r.queries(in.get<GLuint>())); break; }
+    case GlOp::BindBuffer: { GLenum t = in.get<GLenum>(); glBindBuffer(t, r.buffers(in.get<GLuint>())); break; }
+    case GlOp::BindBufferBase: {
+        GLenum t = in.get<GLenum>(); GLuint index = in.get<GLuint>();
+        glBindBufferBase(t, index, r.buffers(in.get<GLuint>()));
+        break;
+    }
+    case GlOp::BindBufferRange: {
+        GLenum t = in.get<GLenum>(); GLuint index = in.get<GLuint>(), b = in.get<GLuint>();
+        int64_t offset = in.get<int64_t>(), size = in.get<int64_t>();
+        glBindBufferRange(t, index, r.buffers(b), (GLintptr)offset, (GLsizeiptr)size);
+        break;
+    }
+    case GlOp::BindFramebuffer: { GLenum t = in.get<GLenum>(); glBindFramebuffer(t, r.framebuffers(in.get<GLuint>())); break; }
+    case GlOp::BindRenderbuffer: { GLenum t = in.get<GLenum>(); glBindRenderbuffer(t, r.renderbuffers(in.get<GLuint>())); break; }
+    case GlOp::BindTexture: { GLenum t = in.get<GLenum>(); glBindTexture(t, r.textures(in.get<GLuint>())); break; }
+    case GlOp::BindVertexArray: glBindVertexArray(r.arrays(in.get<GLuint>())); break;
+    case GlOp::BlendFunc: { GLenum s = in.get<GLenum>(), d = in.get<GLenum>(); glBlendFunc(s, d); break; }
+    case GlOp::BufferData: {
+        GLenum t = in.get<GLenum>(); int64_t size = in.get<int64_t>(); GLenum usage = in.get<GLenum>();
+        const void* data = in.payload(bytes);
+        glBufferData(t, (GLsizeiptr)size, data, usage);
+        break;
+    }
+    case GlOp::BufferSubData: {
+        GLenum t = in.get<GLenum>(); int64_t offset = in.get<int64_t>();
+        const void* data = in.payload(bytes);
+        glBufferSubData(t, (GLintptr)offset, bytes, data);
+        break;
+    }
+    case GlOp::Clear: glClear(in.get<GLbitfield>()); break;
+    case GlOp::ClearColor: {
+        float c[4];
+        for (float& v : c) v = in.get<float>();
+        glClearColor(c[0], c[1], c[2], c[3]);
+        break;
+    }
+    case GlOp::ClientWaitSync: {
+        uint32_t id = in.get<uint32_t>(); GLbitfield flags = in.get<GLbitfield>(); uint64_t timeout = in.get<uint64_t>();
+        if (id < r.syncs.size() && r.syncs[id]) glClientWaitSync(r.syncs[id], flags, timeout);
+        break;
+    }
+    case GlOp::CompileShader: glCompileShader(r.objects(in.get<GLuint>())); break;
+    case GlOp::CopyBufferSubData: {
+        GLenum rt = in.get<GLenum>(), wt = in.get<GLenum>();
+        int64_t ro = in.get<int64_t>(), wo = in.get<int64_t>(), size = in.get<int64_t>();
+        glCopyBufferSubData(rt, wt, (GLintptr)ro, (GLintptr)wo, (GLsizeiptr)size);
+        break;
+    }
+    case GlOp::CreateProgram: r.objects.set(in.get<GLuint>(), glCreateProgram()); break;
+    case GlOp::CreateShader: { GLenum type = in.get<GLenum>(); r.objects.set(in.get<GLuint>(), glCreateShader(type)); break; }
+    case GlOp::DeleteBuffers: deleteNames(in, glDeleteBuffers, r.buffers); break;
+    case GlOp::DeleteFramebuffers: deleteNames(in, glDeleteFramebuffers, r.framebuffers); break;
+    case GlOp::DeleteProgram: {
+        // cleared, not erased: the current program's table may be the one pointed at
+        GLuint p = in.get<GLuint>();
+        glDeleteProgram(r.objects(p));
+        r.locations[p].clear(); r.blocks[p].clear();
+        break;
+    }
+    case GlOp::DeleteQueries: deleteNames(in, glDeleteQueries, r.queries); break;
+    case GlOp::DeleteRenderbuffers: deleteNames(in, glDeleteRenderbuffers, r.renderbuffers); break;
+    case GlOp::DeleteShader: glDeleteShader(r.objects(in.get<GLuint>())); break;
+    case GlOp::DeleteSync: {
+        uint32_t id = in.get<uint32_t>();
+        if (id < r.syncs.size() && r.syncs[id]) { glDeleteSync(r.syncs[id]); r.syncs[id] = nullptr; }
+        break;
+    }
+    case GlOp::DeleteTextures: deleteNames(in, glDeleteTextures, r.textures); break;
+    case GlOp::DeleteVertexArrays: deleteNames(in, glDeleteVertexArrays, r.arrays); break;
+    case GlOp::DetachShader: { GLuint p = in.get<GLuint>(), s = in.get<GLuint>(); glDetachShader(r.objects(p), r.objects(s)); break; }
+    case GlOp::Disable: glDisable(in.get<GLenum>()); break;
+    case GlOp::DrawArrays: {
+        GLenum mode = in.get<GLenum>(); GLint first = in.get<GLint>(); GLsizei count = in.get<GLsizei>();
+        glDrawArrays(mode, first, count);
+        break;
+    }
+    case GlOp::DrawArraysInstanced: {
+        GLenum mode = in.get<GLenum>(); GLint first = in.get<GLint>(); GLsizei count = in.get<GLsizei>();
+        glDrawArraysInstanced(mode, first, count, in.get<GLsizei>());
+        break;
+    }
+    case GlOp::DrawElements: {
+        GLenum mode = in.get<GLenum>(); GLsizei count = in.get<GLsizei>(); GLenum type = in.get<GLenum>();
+        glDrawElements(mode, count, type, offsetPtr(in.get<int64_t>()));
+        break;
+    }
+    case GlOp::DrawElementsBaseVertex: {
+        GLenum mode = in.get<GLenum>(); GLsizei count = in.get<GLsizei>(); GLenum type = in.get<GLenum>();
+        const void* indices = offsetPtr(in.get<int64_t>());
+        glDrawElementsBaseVertex(mode, count, type, indices, in.get<GLint>());
+        break;
+    }
+    case GlOp::DrawElementsInstanced: {
+        GLenum mode = in.get<GLenum>(); GLsizei count = in.get<GLsizei>(); GLenum type = in.get<GLenum>();
+        const void* indices = offsetPtr(in.get<int64_t>());
+        glDrawElementsInstanced(mode, count, type, indices, in.get<GLsizei>());
+        break;
+    }
+    case GlOp::Enable: glEnable(in.get<GLenum>()); break;
+    case GlOp::EnableVertexAttribArray: glEnableVertexAttribArray(in.get<GLuint>()); break;
+    case GlOp::EndQuery: glEndQuery(in.get<GLenum>()); break;
+    case GlOp::FenceSync: {
+        GLenum condition = in.get<GLenum>(); GLbitfield flags = in.get<GLbitfield>(); uint32_t id = in.get<uint32_t>();
+        if (id >= r.syncs.size()) r.syncs.resize(id + 1, nullptr);
+        r.syncs[id] = glFenceSync(condition, flags);
+        break;
+    }
+    case GlOp::Finish: glFinish(); break;
+    case GlOp::FramebufferRenderbuffer: {
+        GLenum t = in.get<GLenum>(), attachment = in.get<GLenum>(), rbTarget = in.get<GLenum>();
+        glFramebufferRenderbuffer(t, attachment, rbTarget, r.renderbuffers(in.get<GLuint>()));
+        break;
+    }
+    case GlOp::FramebufferTexture2D: {
+        GLenum t = in.get<GLenum>(), attachment = in.get<GLenum>(), texTarget = in.get<GLenum>();
+        GLuint tex = in.get<GLuint>();
+        glFramebufferTexture2D(t, attachment, texTarget, r.textures(tex), in.get<GLint>());
+        break;
+    }
+    case GlOp::GenBuffers: genNames(in, glGenBuffers, r.buffers); break;
+    case GlOp::GenFramebuffers: genNames(in, glGenFramebuffers, r.framebuffers); break;
+    case GlOp::GenQueries: genNames(in, glGenQueries, r.queries); break;
+    case GlOp::GenRenderbuffers: genNames(in, glGenRenderbuffers, r.renderbuffers); break;
+    case GlOp::GenTextures: genNames(in, glGenTextures, r.textures); break;
+    case GlOp::GenVertexArrays: genNames(in, glGenVertexArrays, r.arrays); break;
+    case GlOp::GetUniformBlockIndex: {
+        GLuint p = in.get<GLuint>(); uint32_t name = in.get<uint32_t>(); GLuint theirs = in.get<GLuint>();
+        GLuint ours = glGetUniformBlockIndex(r.objects(p), name < r.strings.size() ? r.strings[name].c_str() : "");
+        std::vector<GLuint>& b = r.blocks[p];
+        if (theirs != GL_INVALID_INDEX) {
+            if (theirs >= b.size()) b.resize(theirs + 1, GL_INVALID_INDEX);
+            b[theirs] = ours;
+        }
+        break;
+    }
+    case GlOp::GetUniformLocation: {
+        GLuint p = in.get<GLuint>(); uint32_t name = in.get<uint32_t>(); GLint theirs = in.get<GLint>();
+        GLint ours = glGetUniformLocation(r.objects(p), name < r.strings.size() ? r.strings[name].c_str() : "");
+        if (theirs >= 0) {
+            std::vector<GLint>& l = r.locations[p];
+            if ((size_t)theirs >= l.size()) l.resize(theirs + 1, -1);
+            l[theirs] = ours;
+        }
+        break;
+    }
+    case GlOp::LinkProgram: glLinkProgram(r.objects(in.get<GLuint>())); break;
+    case GlOp::MapBufferRange: {
+        GLenum t = in.get<GLenum>(); int64_t offset = in.get<int64_t>(), length = in.get<int64_t>();
+        GLbitfield access = in.get<GLbitfield>();
+        if (void* p = glMapBufferRange(t, (GLintptr)offset, (GLsizeiptr)length, access)) r.maps.push_back({ t, p });
+        break;
+    }
+    case GlOp::MultiDrawElementsBaseVertex: {
+        GLenum mode = in.get<GLenum>(), type = in.get<GLenum>(); GLsizei n = in.get<GLsizei>();
+        std::vector<GLsizei> counts(n > 0 ? n : 0);
+        std::vector<const void*> indices(counts.size());
+        std::vector<GLint> bases(counts.size());
+        for (size_t i = 0; i < counts.size(); ++i) {
+            counts[i] = in.get<GLsizei>(); indices[i] = offsetPtr(in.get<int64_t>()); bases[i] = in.get<GLint>();
+        }
+        glMultiDrawElementsBaseVertex(mode, counts.data(), type, indices.data(), n, bases.data());
+        break;
+    }
+    case GlOp::PixelStorei: { GLenum pname = in.get<GLenum>(); glPixelStorei(pname, in.get<GLint>()); break; }
+    case GlOp::QueryCounter: { GLuint q = in.get<GLuint>(); glQueryCounter(r.queries(q), in.get<GLenum>()); break; }
+    case GlOp::ReadPixels: {
+        GLint x = in.get<GLint>(), y = in.get<GLint>(); GLsizei w = in.get<GLsizei>(), h = in.get<GLsizei>();
+        GLenum format = in.get<GLenum>(), type = in.get<GLenum>();
+        // pack alignment is at most 8; size for the worst case rather than track it
+        size_t need = glImageBytes(w, h, format, type, 8, 0);
+        if (r.scratch.size() < need) r.scratch.resize(need);
+        glReadPixels(x, y, w, h, format, type, r.scratch.data());
+        break;
+    }
+    case GlOp::RenderbufferStorage: {
+        GLenum t = in.get<GLenum>(), format = in.get<GLenum>(); GLsizei w = in.get<GLsizei>(), h = in.get<GLsizei>();
+        glRenderbufferStorage(t, format, w, h);
+        break;
+    }
+    case GlOp::ShaderSource: {
+        GLuint s = in.get<GLuint>();
+        const GLchar* src = (const GLchar*)in.payload(bytes);
+        GLint len = (GLint)bytes;
+        glShaderSource(r.objects(s), 1, &src, &len);
+        break;
+    }
+    case GlOp::TexBuffer: {
+        GLenum t = in.get<GLenum>(), format = in.get<GLenum>();
+        glTexBuffer(t, format, r.buffers(in.get<GLuint>()));
+        break;
+    }
+    case GlOp::TexImage2D: {
+        GLenum t = in.get<GLenum>(); GLint level = in.get<GLint>(), internalFormat = in.get<GLint>();
+        GLsizei w = in.get<GLsizei>(), h = in.get<GLsizei>(); GLint border = in.get<GLint>();
+        GLenum format = in.get<GLenum>(), type = in.get<GLenum>();
+        glTexImage2D(t, level, internalFormat, w, h, border, format, type, in.payload(bytes));
+        break;
+    }
+    case GlOp::TexParameteri: {
+        GLenum t = in.get<GLenum>(), pname = in.get<GLenum>();
+        glTexParameteri(t, pname, in.get<GLint>());
+        break;
+    }
+    case GlOp::TexSubImage2D: {
+        GLenum t = in.get<GLenum>(); GLint level = in.get<GLint>(), x = in.get<GLint>(), y = in.get<GLint>();
+        GLsizei w = in.get<GLsizei>(), h = in.get<GLsizei>();
+        GLenum format = in.get<GLenum>(), type = in.get<GLenum>();
+        glTexSubImage2D(t, level, x, y, w, h, format, type, in.payload(bytes));
+        break;
+    }
+    case GlOp::Uniform1f: { GLint l = r.loc(in.get<GLint>()); glUniform1f(l, in.get<float>()); break; }
+    case GlOp::Uniform1i: { GLint l = r.loc(in.get<GLint>()); glUniform1i(l, in.get<GLint>()); break; }
+    case GlOp::Uniform2f: { GLint l = r.loc(in.get<GLint>()); float x = in.get<float>(); glUniform2f(l, x, in.get<float>()); break; }
+    case GlOp::Uniform3f: {
+        GLint l = r.loc(in.get<GLint>()); float x = in.get<float>(), y = in.get<float>();
+        glUniform3f(l, x, y, in.get<float>());
+        break;
+    }
+    case GlOp::Uniform3fv: {
+        GLint l = r.loc(in.get<GLint>()); const void* v = in.payload(bytes);
+        glUniform3fv(l, (GLsizei)(bytes / (3 * sizeof(float))), (const GLfloat*)v);
+        break;
+    }
+    case GlOp::Uniform4fv: {
+        GLint l = r.loc(in.get<GLint>()); const void* v = in.payload(bytes);
+        glUniform4fv(l, (GLsizei)(bytes / (4 * sizeof(float))), (const GLfloat*)v);
+        break;
+    }
+    case GlOp::UniformBlockBinding: {
+        GLuint p = in.get<GLuint>(), index = in.get<GLuint>(), binding = in.get<GLuint>();
+        auto it = r.blocks.find(p);
+        if (it != r.blocks.end() && index < it->second.size()) index = it->second[index];
+        if (index != GL_INVALID_INDEX) glUniformBlockBinding(r.objects(p), index, binding);
+        break;
+    }
+    case GlOp::UniformMatrix4fv: {
+        GLint l = r.loc(in.get<GLint>()); GLboolean transpose = in.get<GLboolean>(); const void* v = in.payload(bytes);
+        glUniformMatrix4fv(l, (GLsizei)(bytes / (16 * sizeof(float))), transpose, (const GLfloat*)v);
+        break;
+    }
+    case GlOp::UnmapBuffer: {
+        GLenum t = in.get<GLenum>(); const void* data = in.payload(bytes);
+        size_t i = 0;
+        while (i < r.maps.size() && r.maps[i].first != t) ++i;
+        if (i < r.maps.size()) {
+            if (data) memcpy(r.maps[i].second, data, bytes);
+            r.maps.erase(r.maps.begin() + i);
+        }
+        glUnmapBuffer(t);
+        break;
+    }
+    case GlOp::UseProgram: {
+        // the app usually looks its locations up after making the program current
+        GLuint p = in.get<GLuint>();
+        r.currentLocations = &r.locations[p];
+        glUseProgram(r.objects(p));
+        break;
+    }
+    case GlOp::VertexAttribDivisor: { GLuint index = in.get<GLuint>(); glVertexAttribDivisor(index, in.get<GLuint>()); break; }
+    case GlOp::VertexAttribPointer: {
+        GLuint index = in.get<GLuint>(); GLint size = in.get<GLint>(); GLenum type = in.get<GLenum>();
+        GLboolean normalized = in.get<GLboolean>(); GLsizei stride = in.get<GLsizei>();
+        glVertexAttribPointer(index, size, type, normalized, stride, offsetPtr(in.get<int64_t>()));
+        break;
+    }
+    case GlOp::Viewport: {
+        GLint x = in.get<GLint>(), y = in.get<GLint>(); GLsizei w = in.get<GLsizei>(), h = in.get<GLsizei>();
+        glViewport(x, y, w, h);
+        break;
+    }
+    default:
+        return false;
+    }
+    return true;
+}
+
+bool writePpm(const std::string& path, int w, int h) {
+    std::vector<unsigned char> px((size_t)w * h * 3);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, px.data());
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    fprintf(f, "P6 %d %d 255\n", w, h);
+    // GL rows run bottom-up
+    for (int y = h - 1; y >= 0; --y) fwrite(&px[(size_t)y * w * 3], 1, (size_t)w * 3, f);
+    return fclose(f) == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    processMs();
+    std::string path, dumpPath;
+    bool pace = false, window = false;
+    int loops = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--pace")) pace = true;
+        else if (!strcmp(argv[i], "--window")) window = true;
+        else if (!strcmp(argv[i], "--loop") && i + 1 < argc) loops = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--dump") && i + 1 < argc) dumpPath = argv[++i];
+        else path = argv[i];
+    }
+    if (path.empty()) {
+        fprintf(stderr, "usage: gl_replay CAPTURE [--pace] [--loop N] [--window] [--dump FILE.ppm]\n");
+        return 2;
+    }
+
+    std::vector<unsigned char> data;
+    if (FILE* f = fopen(path.c_str(), "rb")) {
+        unsigned char chunk[1 << 16];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+        fclose(f);
+    }
+    GlCaptureHeader header;
+    if (data.size() < sizeof(header)) { fprintf(stderr, "can't read %s\n", path.c_str()); return 1; }
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != kGlCaptureMagic || header.version != kGlCaptureVersion) {
+        fprintf(stderr, "%s is not a version %u GL capture\n", path.c_str(), kGlCaptureVersion);
+        return 1;
+    }
+
+    if (!glfwInit()) { fprintf(stderr, "GLFW init failed\n"); return 1; }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    if (!window) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    int w = header.width > 0 ? header.width : 64, h = header.height > 0 ? header.height : 64;
+    GLFWwindow* win = glfwCreateWindow(w, h, "gl_replay", nullptr, nullptr);
+    if (!win) { glfwTerminate(); return 1; }
+    glfwMakeContextCurrent(win);
+    glfwSwapInterval(0);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) { fprintf(stderr, "GLAD load failed\n"); return 1; }
+
+    Replayer r;
+    Reader in{ data.data() + sizeof(header), data.data() + data.size() };
+    const unsigned char* loopStart = nullptr;   // just after the first frame
+    double loopStamp = 0.0, lastStamp = 0.0;
+    FrameStats stats;
+    double replayStart = processMs(), frameStart = replayStart, stampOffset = 0.0;
+    int frames = 0;
+    bool failed = false;
+    for (;;) {
+        if (in.p >= in.end) {
+            if (loops-- <= 0 || !loopStart) break;
+            in.p = loopStart;
+            stampOffset += lastStamp - loopStamp;
+            continue;
+        }
+        GlOp op = (GlOp)in.get<uint8_t>();
+        if (op == GlOp::Frame) {
+            double stamp = in.get<double>();
+            lastStamp = stamp;
+            stats.cpuMs.push_back(processMs() - frameStart);
+            if (pace) {
+                // the capture's timeline, shifted by however many loops came before
+                double due = replayStart + stampOffset + stamp;
+                double wait = due - processMs();
+                if (wait > 0.0) std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(wait));
+            }
+            glfwSwapBuffers(win);
+            double now = processMs();
+            stats.frameMs.push_back(now - frameStart);
+            frameStart = now;
+            if (++frames == 1) { loopStart = in.p; loopStamp = stamp; stats.startupMs = now; }
+            continue;
+        }
+        if (!replayOne(r, in, op) || !in.ok()) {
+            fprintf(stderr, "bad record (op %d) at byte %lld\n", (int)op, (long long)(in.p - data.data()));
+            failed = true;
+            break;
+        }
+    }
+    glFinish();
+    double totalMs = processMs() - replayStart;
+    if (!dumpPath.empty() && !writePpm(dumpPath, w, h)) fprintf(stderr, "can't write %s\n", dumpPath.c_str());
+
+    char extra[256];
+    snprintf(extra, sizeof(extra), "frames=%d calls=%llu capture_mb=%.3f total_ms=%.3f calls_per_s=%.0f", frames,
+             (unsigned long long)r.calls, data.size() / (1024.0 * 1024.0), totalMs,
+             totalMs > 0.0 ? r.calls / (totalMs * 1e-3) : 0.0);
+    printf("%s\n", statsLine(stats, extra).c_str());
+    glfwDestroyWindow(win); glfwTerminate();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,275 @@
+// === golden-check: every render path against golden images, with its frame time beside the picture ===
+// Renders one fixed-timeline frame per scenario headless on llvmpipe (--screenshot) and compares it with
+// the golden of the path it must match: PSNR over RGB, mean SSIM over luma (8x8 windows, stride 4) and
+// the largest per-channel error. Exact paths (kernels, index layouts) must match their reference all but
+// bit for bit; lossy ones (LOD, light approximations, shader shortcuts) only within their thresholds, so
+// a speedup can't quietly cost more picture than it was meant to. Next to the metrics is the median
+// frame time and the speedup over the scenario that renders the reference path in the same run.
+// For each scenario --out gets the frame (<name>.ppm) and a heatmap of the error (<name>_diff.ppm).
+//
+// Goldens live in bench/golden/<path>.ppm and are rasterizer-specific: the committed ones are llvmpipe,
+// and the tool forces it unless --any-driver. The streamed modes (--stream, --gallery) fill in over
+// several frames on worker threads and aren't deterministic per frame, so they aren't covered.
+//
+// g++ -O2 -std=c++17 bench/golden_check.cpp -o golden_check
+// ./golden_check --exe ./multiple_lights                      compare, exit 1 if a scenario is off
+// ./golden_check --exe ./multiple_lights --record             re-record the reference goldens
+// ./golden_check --exe ./multiple_lights --only lod1 --out d  one scenario, images in d/
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+struct Scenario {
+    const char* name;
+    const char* golden;     // the path it has to look like; a scenario named after its golden records it
+    const char* args;       // on top of --headless --size --screenshot FILE --samples FILE
+    double minPsnr, minSsim;
+};
+const double kExactPsnr = 45.0, kExactSsim = 0.995;
+// fixed timelines; change a reference's args and its golden has to be re-recorded
+const Scenario kScenarios[] = {
+    { "default",         "default",   "--frames 60",                                   kExactPsnr, kExactSsim },
+    { "kernel-scalar",   "default",   "--frames 60 --kernel scalar",                   kExactPsnr, kExactSsim },
+    { "kernel-table",    "default",   "--frames 60 --kernel table",                    kExactPsnr, kExactSsim },
+    { "strip",           "default",   "--frames 60 --index-layout strip",              kExactPsnr, kExactSsim },
+    { "lod1",            "default",   "--frames 60 --lod 1",                           30.0, 0.97 },
+    { "lod2",            "default",   "--frames 60 --lod 2",                           24.0, 0.90 },
+    { "fast-shading",    "default",   "--frames 60 --define SPEC_BLINN --define SPEC_FASTPOW --define ATT_CUTOFF",
+                                                                                       28.0, 0.95 },
+    { "lights64",        "lights64",  "--frames 60 --lights 64",                       kExactPsnr, kExactSsim },
+    { "lights64-tree",   "lights64",  "--frames 60 --lights 64 --lighttree",           30.0, 0.97 },
+    { "lights64-sh",     "lights64",  "--frames 60 --lights 64 --shlights",            28.0, 0.95 },
+    { "wavefield",       "wavefield", "--frames 60 --wavefield",                       kExactPsnr, kExactSsim },
+    { "wavefield-gpu",   "wavefield", "--frames 60 --wavefield-gpu",                   30.0, 0.97 },
+    { "softbody",        "softbody",  "--frames 60 --softbody",                        kExactPsnr, kExactSsim },
+    { "morph",           "morph",     "--frames 60 --morph",                           kExactPsnr, kExactSsim },
+    { "instances",       "instances", "--frames 60 --instances 9",                     kExactPsnr, kExactSsim },
+};
+const int kWidth = 320, kHeight = 180;
+const int kWarmupFrames = 10;       // dropped from the timings: shader compiles, first uploads
+const int kHeatScale = 64;          // heatmap saturates at this error
+
+struct Image {
+    int width = 0, height = 0;
+    std::vector<unsigned char> rgb;
+};
+
+bool readPpm(const std::string& path, Image& out) {
+    std::ifstream f(path, std::ios::binary);
+    std::string magic;
+    int maxval = 0;
+    if (!(f >> magic >> out.width >> out.height >> maxval) || magic != "P6" || maxval != 255 || out.width < 1 || out.height < 1)
+        return false;
+    f.get();
+    out.rgb.resize((size_t)out.width * out.height * 3);
+    return (bool)f.read((char*)out.rgb.data(), out.rgb.size());
+}
+
+bool writePpm(const std::string& path, const Image& img) {
+    std::ofstream f(path, std::ios::binary);
+    f << "P6\n" << img.width << " " << img.height << "\n255\n";
+    f.write((const char*)img.rgb.data(), img.rgb.size());
+    return (bool)f;
+}
+
+struct Diff {
+    double psnr = 0.0, ssim = 0.0;
+    int maxError = 0;
+    double errorPixels = 0.0;   // fraction off by more than 8
+};
+
+// mean SSIM of two luma planes over 8x8 windows
+double ssim(const std::vector<float>& a, const std::vector<float>& b, int w, int h) {
+    const int win = 8, stride = 4;
+    const double c1 = (0.01 * 255) * (0.01 * 255), c2 = (0.03 * 255) * (0.03 * 255), n = win * win;
+    double sum = 0.0;
+    int windows = 0;
+    for (int y = 0; y + win <= h; y += stride) {
+        for (int x = 0; x + win <= w; x += stride) {
+            double ma = 0, mb = 0, va = 0, vb = 0, cov = 0;
+            for (int j = 0; j < win; ++j)
+                for (int i = 0; i < win; ++i) { ma += a[(y + j) * w + x + i]; mb += b[(y + j) * w + x + i]; }
+            ma /= n; mb /= n;
+            for (int j = 0; j < win; ++j) {
+                for (int i = 0; i < win; ++i) {
+                    double da = a[(y + j) * w + x + i] - ma, db = b[(y + j) * w + x + i] - mb;
+                    va += da * da; vb += db * db; cov += da * db;
+                }
+            }
+            va /= n - 1; vb /= n - 1; cov /= n - 1;
+            sum += ((2 * ma * mb + c1) * (2 * cov + c2)) / ((ma * ma + mb * mb + c1) * (va + vb + c2));
+            ++windows;
+        }
+    }
+    return windows ? sum / windows : 1.0;
+}
+
+// black through red and yellow to white as the error grows
+Diff compare(const Image& golden, const Image& cur, Image& heat) {
+    Diff d;
+    size_t pixels = (size_t)cur.width * cur.height;
+    std::vector<float> la(pixels), lb(pixels);
+    heat.width = cur.width; heat.height = cur.height;
+    heat.rgb.assign(pixels * 3, 0);
+    double se = 0.0;
+    size_t off = 0;
+    for (size_t p = 0; p < pixels; ++p) {
+        const unsigned char* a = &golden.rgb[p * 3];
+        const unsigned char* b = &cur.rgb[p * 3];
+        int e = 0;
+        for (int c = 0; c < 3; ++c) {
+            int diff = abs((int)a[c] - (int)b[c]);
+            se += (double)diff * diff;
+            e = std::max(e, diff);
+        }
+        d.maxError = std::max(d.maxError, e);
+        if (e > 8) ++off;
+        la[p] = 0.299f * a[0] + 0.587f * a[1] + 0.114f * a[2];
+        lb[p] = 0.299f * b[0] + 0.587f * b[1] + 0.114f * b[2];
+        float t = std::min(1.0f, (float)e / kHeatScale) * 3.0f;
+        heat.rgb[p * 3 + 0] = (unsigned char)(255 * std::min(1.0f, t));
+        heat.rgb[p * 3 + 1] = (unsigned char)(255 * std::min(1.0f, std::max(0.0f, t - 1.0f)));
+        heat.rgb[p * 3 + 2] = (unsigned char)(255 * std::max(0.0f, t - 2.0f));
+    }
+    double mse = se / (pixels * 3.0);
+    d.psnr = mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : INFINITY;
+    d.ssim = ssim(la, lb, cur.width, cur.height);
+    d.errorPixels = (double)off / pixels;
+    return d;
+}
+
+// frame_ms out of the renderer's --samples JSON; nothing else in it is needed
+std::vector<double> frameTimes(const std::string& path) {
+    std::ifstream f(path);
+    std::stringstream ss; ss << f.rdbuf();
+    std::string text = ss.str();
+    std::vector<double> v;
+    size_t at = text.find("\"frame_ms\"");
+    if (at == std::string::npos || (at = text.find('[', at)) == std::string::npos) return v;
+    const char* p = text.c_str() + at + 1;
+    while (*p && *p != ']') {
+        char* end = nullptr;
+        double x = strtod(p, &end);
+        if (end == p) { ++p; continue; }
+        v.push_back(x);
+        p = end;
+    }
+    return v;
+}
+
+double median(std::vector<double> v) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+struct Result {
+    bool ran = false;
+    Image image;
+    double frameMs = 0.0;
+};
+
+bool runScenario(const std::string& exe, const Scenario& sc, Result& out) {
+    char shot[] = "/tmp/golden_check_XXXXXX", samples[] = "/tmp/golden_check_XXXXXX";
+    int fa = mkstemp(shot), fb = mkstemp(samples);
+    if (fa < 0 || fb < 0) return false;
+    close(fa); close(fb);
+    std::string cmd = exe + " --headless --size " + std::to_string(kWidth) + "x" + std::to_string(kHeight) + " " + sc.args
+                    + " --screenshot " + shot + " --samples " + samples + " >/dev/null 2>&1";
+    std::cerr << "  " << sc.name << "\n";
+    out.ran = std::system(cmd.c_str()) == 0 && readPpm(shot, out.image);
+    std::vector<double> frames = frameTimes(samples);
+    if ((int)frames.size() > kWarmupFrames) frames.erase(frames.begin(), frames.begin() + kWarmupFrames);
+    out.frameMs = median(frames);
+    remove(shot); remove(samples);
+    return out.ran;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string exe = "./multiple_lights", goldenDir = "bench/golden", outDir = "golden_out", only;
+    bool record = false, anyDriver = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--exe" && i + 1 < argc) exe = argv[++i];
+        else if (a == "--golden" && i + 1 < argc) goldenDir = argv[++i];
+        else if (a == "--out" && i + 1 < argc) outDir = argv[++i];
+        else if (a == "--only" && i + 1 < argc) only = argv[++i];
+        else if (a == "--record") record = true;
+        else if (a == "--any-driver") anyDriver = true;
+        else { std::cerr << "unknown argument " << a << "\n"; return 2; }
+    }
+    if (!anyDriver) {
+        // goldens are only comparable on the rasterizer that made them
+        setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+        setenv("GALLIUM_DRIVER", "llvmpipe", 1);
+    }
+
+    const int count = sizeof(kScenarios) / sizeof(kScenarios[0]);
+    // --only still runs the scenario's reference path, for the speedup
+    std::string onlyGolden;
+    for (const Scenario& sc : kScenarios) if (only == sc.name) onlyGolden = sc.golden;
+    if (!only.empty() && onlyGolden.empty()) { std::cerr << "no scenario " << only << "\n"; return 2; }
+    std::vector<Result> results(count);
+    for (int k = 0; k < count; ++k) {
+        const Scenario& sc = kScenarios[k];
+        bool reference = !strcmp(sc.name, sc.golden);
+        if (record ? !reference : !only.empty() && only != sc.name && onlyGolden != sc.name) continue;
+        if (!runScenario(exe, sc, results[k])) { std::cerr << "scenario " << sc.name << " failed to run\n"; return 2; }
+    }
+
+    if (record) {
+        mkdir(goldenDir.c_str(), 0755);
+        for (int k = 0; k < count; ++k) {
+            if (!results[k].ran) continue;
+            std::string path = goldenDir + "/" + kScenarios[k].name + ".ppm";
+            if (!writePpm(path, results[k].image)) { std::cerr << "can't write " << path << "\n"; return 2; }
+            std::cerr << "golden written to " << path << "\n";
+        }
+        return 0;
+    }
+
+    mkdir(outDir.c_str(), 0755);
+    int failures = 0;
+    printf("%-15s %-10s %8s %7s %5s %7s %9s %8s  %s\n", "scenario", "golden", "PSNR dB", "SSIM", "max", ">8 px", "p50 ms", "speedup", "verdict");
+    for (int k = 0; k < count; ++k) {
+        const Scenario& sc = kScenarios[k];
+        const Result& r = results[k];
+        if (!r.ran) continue;
+        Image golden, heat;
+        std::string goldenPath = goldenDir + "/" + sc.golden + ".ppm";
+        if (!readPpm(goldenPath, golden)) { std::cerr << "can't read " << goldenPath << "; run --record\n"; return 2; }
+        if (golden.width != r.image.width || golden.height != r.image.height) {
+            std::cerr << goldenPath << " is " << golden.width << "x" << golden.height << "; re-record it\n";
+            return 2;
+        }
+        Diff d = compare(golden, r.image, heat);
+        writePpm(outDir + "/" + sc.name + ".ppm", r.image);
+        writePpm(outDir + "/" + sc.name + "_diff.ppm", heat);
+        // the reference path's time from this run, if it ran
+        double refMs = 0.0;
+        for (int j = 0; j < count; ++j)
+            if (!strcmp(kScenarios[j].name, sc.golden) && results[j].ran) refMs = results[j].frameMs;
+        bool ok = d.psnr >= sc.minPsnr && d.ssim >= sc.minSsim;
+        if (!ok) ++failures;
+        char speedup[16] = "-";
+        if (refMs > 0.0 && r.frameMs > 0.0) snprintf(speedup, sizeof(speedup), "%.2fx", refMs / r.frameMs);
+        printf("%-15s %-10s %8.2f %7.4f %5d %6.2f%% %9.3f %8s  %s\n", sc.name, sc.golden, std::isinf(d.psnr) ? 99.99 : d.psnr,
+               d.ssim, d.maxError, d.errorPixels * 100.0, r.frameMs, speedup, ok ? "ok" : "DIFFERS");
+    }
+    if (failures) printf("%d scenario(s) outside their thresholds; heatmaps in %s/\n", failures, outDir.c_str());
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,162 @@
+// === kseq-check: mesh sequences round-trip through decodeSequenceFrame() ===
+// Exports the same timeline as float, quantized and delta sequences (exportSequence(), the --export
+// path), reads each file back the way a player would and compares every frame with sculptureVertices()
+// at that frame's time. Float must come back bit for bit. Quantized and delta positions must be within
+// half a quantization step of the frame's bounds (about 2.4e-5 for the default sculpture, padding
+// included). Octahedral normals must be within kNormalTolerance. The topology block is checked too.
+// Delta runs with short key intervals, so both key frames and delta frames are decoded.
+//
+// g++ -O2 -std=c++17 -I. bench/kseq_check.cpp mesh_export.cpp sculpture_geometry.cpp thread_pool.cpp -pthread -o kseq_check
+// ./kseq_check                              140x180, 120 frames, files in /tmp
+// ./kseq_check --res 64x96 --frames 300 --out d
+#include "mesh_export.h"
+#include "sculpture_geometry.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+const float kNormalTolerance = 5e-5f;   // per component; 2 x snorm16 octahedral is about 1.5 / 32767
+
+struct Mode {
+    const char* name;
+    bool quantize, delta;
+};
+const Mode kModes[] = {
+    { "float",     false, false },
+    { "quantized", true,  false },
+    { "delta",     true,  true },
+};
+
+struct Result {
+    int frames = 0, keys = 0;
+    double posError = 0.0, posBound = 0.0;  // worst error, and the worst frame's half step
+    double normalError = 0.0;
+    bool ok = true;
+    std::string problem;
+};
+
+bool fail(Result& r, const std::string& problem) {
+    if (r.ok) r.problem = problem;
+    r.ok = false;
+    return false;
+}
+
+bool checkSequence(const std::string& path, const SequenceSettings& s, ThreadPool& pool, Result& r) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size_t at = 0;
+    auto take = [&](void* out, size_t bytes) {
+        if (file.size() - at < bytes) return false;
+        memcpy(out, file.data() + at, bytes);
+        at += bytes;
+        return true;
+    };
+
+    SequenceHeader h;
+    if (!take(&h, sizeof(h)) || h.magic != kSequenceMagic || h.version != kSequenceVersion)
+        return fail(r, "bad header");
+    size_t n = h.vertexCount;
+    if (h.rows != s.rows || h.cols != s.cols || n != (size_t)s.rows * s.cols || (int)h.frameCount != s.frames)
+        return fail(r, "header doesn't match the settings");
+
+    std::vector<unsigned int> idx, wantIdx;
+    std::vector<float> uv(n * 2), ref;
+    idx.resize(h.indexCount);
+    if (!take(idx.data(), idx.size() * sizeof(unsigned int)) || !take(uv.data(), uv.size() * sizeof(float)))
+        return fail(r, "truncated topology");
+    sculptureIndices(wantIdx, s.rows, s.cols, &pool);
+    sculptureVertices(ref, s.rows, s.cols, h.startTime, nullptr, s.shape, GeometryKernel::Simd, &pool);
+    if (idx != wantIdx) return fail(r, "indices differ");
+    for (size_t i = 0; i < n; ++i) {
+        if (uv[i * 2] != ref[i * kVertexFloats + 6] || uv[i * 2 + 1] != ref[i * kVertexFloats + 7])
+            return fail(r, "texture coordinates differ");
+    }
+
+    std::vector<uint16_t> quantized;
+    std::vector<float> decoded;
+    std::vector<uint8_t> payload;
+    for (uint32_t f = 0; f < h.frameCount; ++f) {
+        SequenceFrameHeader fh;
+        if (!take(&fh, sizeof(fh)) || fh.index != f || fh.payloadBytes > file.size() - at)
+            return fail(r, "frame " + std::to_string(f) + ": bad record");
+        payload.assign(file.begin() + at, file.begin() + at + fh.payloadBytes);
+        at += fh.payloadBytes;
+        if (!decodeSequenceFrame(h, fh, payload.data(), quantized, decoded))
+            return fail(r, "frame " + std::to_string(f) + ": doesn't decode");
+        // the exporter's own timeline: float start + frame * step
+        sculptureVertices(ref, s.rows, s.cols, h.startTime + f * h.frameTime, nullptr, s.shape, GeometryKernel::Simd, &pool);
+
+        double bound = 0.0, magnitude = 0.0;
+        for (int k = 0; k < 3; ++k) {
+            bound = std::max(bound, 0.5 * ((double)fh.bmax[k] - fh.bmin[k]) / 65535.0);
+            magnitude = std::max(magnitude, (double)std::max(std::fabs(fh.bmin[k]), std::fabs(fh.bmax[k])));
+        }
+        bound += 4.0 * FLT_EPSILON * magnitude;    // encoder and decoder both round in float
+        double posError = 0.0, normalError = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                posError = std::max(posError, (double)std::fabs(decoded[i * 6 + k] - ref[i * kVertexFloats + k]));
+                normalError = std::max(normalError, (double)std::fabs(decoded[i * 6 + 3 + k] - ref[i * kVertexFloats + 3 + k]));
+            }
+        }
+        r.frames += 1;
+        r.keys += fh.key ? 1 : 0;
+        r.posError = std::max(r.posError, posError);
+        r.posBound = std::max(r.posBound, bound);
+        r.normalError = std::max(r.normalError, normalError);
+        std::string where = "frame " + std::to_string(f) + ": ";
+        if (!s.quantize && (posError != 0.0 || normalError != 0.0)) return fail(r, where + "float frame isn't exact");
+        if (s.quantize && posError > bound) return fail(r, where + "position error above half a step");
+        if (s.quantize && normalError > kNormalTolerance) return fail(r, where + "normal error above tolerance");
+    }
+    if (at != file.size()) return fail(r, "bytes after the last frame");
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string outDir = "/tmp";
+    int rows = 140, cols = 180, frames = 120;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--out") && i + 1 < argc) outDir = argv[++i];
+        else if (!strcmp(argv[i], "--res") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &rows, &cols) == 1) cols = rows;
+        }
+        else if (!strcmp(argv[i], "--frames") && i + 1 < argc) frames = atoi(argv[++i]);
+        else { fprintf(stderr, "unknown argument %s\n", argv[i]); return 2; }
+    }
+    if (rows < 2 || cols < 3 || frames < 1) { fprintf(stderr, "--res needs 2x3 or more, --frames 1 or more\n"); return 2; }
+
+    ThreadPool pool;
+    bool allOk = true;
+    printf("%-10s %6s %5s %12s %12s %12s  %s\n", "sequence", "frames", "keys", "pos_error", "half_step", "normal_error", "verdict");
+    for (const Mode& m : kModes) {
+        SequenceSettings s;
+        s.path = outDir + "/kseq_check_" + m.name + ".kseq";
+        s.rows = rows; s.cols = cols;
+        s.frames = frames;
+        s.startTime = 1.25f;
+        s.quantize = m.quantize; s.delta = m.delta;
+        s.keyInterval = 16;
+        Result r;
+        if (!exportSequence(s, pool)) fail(r, "export failed");
+        else checkSequence(s.path, s, pool, r);
+        remove(s.path.c_str());
+        printf("%-10s %6d %5d %12.3g %12.3g %12.3g  %s%s\n", m.name, r.frames, r.keys, r.posError, m.quantize ? r.posBound : 0.0,
+               r.normalError, r.ok ? "ok" : "FAIL ", r.problem.c_str());
+        allOk = allOk && r.ok;
+    }
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,316 @@
+// === perf-check: fail on statistically significant performance regressions ===
+// Runs fixed-timeline headless scenarios several times, then compares frame time (median and p99),
+// startup time and peak RSS against a committed baseline. Each comparison is a bootstrap 95% confidence
+// interval on current / baseline - 1. The check fails only when the whole interval is above the metric's
+// tolerance, so noise alone doesn't trip it.
+// The resampling unit is the run, not the frame: frames of one run share a process, caches, clocks and
+// whatever else the machine was doing, so they aren't independent samples. Startup and peak RSS are one
+// number per run, which is why every side needs at least kMinRuns runs.
+// The baseline is only meaningful on the machine that recorded it; re-record it after moving machines.
+//
+// g++ -O2 -std=c++17 bench/perf_check.cpp -o perf_check
+// ./perf_check --exe ./multiple_lights                                   compare, exit 1 on regression
+// ./perf_check --exe ./multiple_lights --record bench/perf_baseline.json re-record (reference machine only)
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+struct Scenario {
+    const char* name;
+    const char* args;   // on top of --headless --frames N --samples FILE
+};
+// fixed timelines; change one and the baseline has to be re-recorded
+const Scenario kScenarios[] = {
+    { "default",    "--frames 120 --size 640x360" },
+    { "many-lights", "--frames 120 --size 640x360 --lights 256 --lighttree" },
+    { "wavefield",  "--frames 120 --size 640x360 --wavefield" },
+    { "dense-mesh", "--frames 60 --size 640x360 --res 1024" },
+};
+const int kWarmupFrames = 10;       // dropped from every run: shader compiles, first uploads
+const int kResamples = 2000;
+const int kMinRuns = 5;             // per side; fewer and the run-level intervals are mostly noise
+
+// --- just enough JSON for our own files: objects, arrays, numbers, strings ---
+struct Json {
+    enum Type { Null, Number, String, Array, Object } type = Null;
+    double num = 0.0;
+    std::string str;
+    std::vector<Json> arr;
+    std::vector<std::pair<std::string, Json>> obj;
+
+    const Json* get(const std::string& key) const {
+        for (const auto& kv : obj) if (kv.first == key) return &kv.second;
+        return nullptr;
+    }
+};
+
+struct JsonParser {
+    const std::string& s;
+    size_t i = 0;
+    bool ok = true;
+
+    explicit JsonParser(const std::string& text) : s(text) {}
+    void ws() { while (i < s.size() && isspace((unsigned char)s[i])) ++i; }
+    bool eat(char c) { ws(); if (i < s.size() && s[i] == c) { ++i; return true; } return false; }
+
+    std::string string() {
+        std::string out;
+        if (!eat('"')) { ok = false; return out; }
+        while (i < s.size() && s[i] != '"') {
+            if (s[i] == '\\' && i + 1 < s.size()) ++i;
+            out += s[i++];
+        }
+        ++i;
+        return out;
+    }
+    Json value() {
+        Json v;
+        ws();
+        if (i >= s.size()) { ok = false; return v; }
+        if (s[i] == '{') {
+            ++i; v.type = Json::Object;
+            if (eat('}')) return v;
+            do {
+                std::string key = string();
+                if (!eat(':')) { ok = false; return v; }
+                v.obj.push_back({ key, value() });
+            } while (ok && eat(','));
+            if (!eat('}')) ok = false;
+        } else if (s[i] == '[') {
+            ++i; v.type = Json::Array;
+            if (eat(']')) return v;
+            do v.arr.push_back(value()); while (ok && eat(','));
+            if (!eat(']')) ok = false;
+        } else if (s[i] == '"') {
+            v.type = Json::String; v.str = string();
+        } else if (!s.compare(i, 4, "null")) {
+            i += 4;
+        } else {
+            char* end = nullptr;
+            v.type = Json::Number; v.num = strtod(s.c_str() + i, &end);
+            if (end == s.c_str() + i) ok = false;
+            i = end - s.c_str();
+        }
+        return v;
+    }
+};
+
+bool readJson(const std::string& path, Json& out) {
+    std::ifstream f(path);
+    if (!f) return false;
+    std::stringstream ss; ss << f.rdbuf();
+    std::string text = ss.str();
+    JsonParser p(text);
+    out = p.value();
+    return p.ok;
+}
+
+std::vector<double> numbers(const Json* a) {
+    std::vector<double> v;
+    if (a) for (const Json& x : a->arr) v.push_back(x.num);
+    return v;
+}
+
+// --- samples of one scenario, one entry per run ---
+struct Samples {
+    std::vector<std::vector<double>> frameMs;   // each run's frames after warm-up
+    std::vector<double> startupMs, peakRssMb;
+};
+
+bool runScenario(const std::string& exe, const Scenario& sc, int runs, Samples& out) {
+    char path[] = "/tmp/perf_check_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return false;
+    close(fd);
+    for (int r = 0; r < runs; ++r) {
+        std::string cmd = exe + " --headless " + sc.args + " --samples " + path + " >/dev/null 2>&1";
+        std::cerr << "  " << sc.name << " run " << r + 1 << "/" << runs << "\n";
+        Json j;
+        if (std::system(cmd.c_str()) != 0 || !readJson(path, j)) { remove(path); return false; }
+        std::vector<double> frames = numbers(j.get("frame_ms"));
+        const Json* startup = j.get("startup_ms");
+        const Json* rss = j.get("peak_rss_mb");
+        if ((int)frames.size() <= kWarmupFrames || !startup || !rss) { remove(path); return false; }
+        out.frameMs.emplace_back(frames.begin() + kWarmupFrames, frames.end());
+        out.startupMs.push_back(startup->num);
+        out.peakRssMb.push_back(rss->num);
+    }
+    remove(path);
+    return true;
+}
+
+double quantile(std::vector<double> v, double q) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(q * (v.size() - 1) + 0.5))];
+}
+
+// every run's samples pooled
+std::vector<double> pooled(const std::vector<std::vector<double>>& runs) {
+    std::vector<double> v;
+    for (const std::vector<double>& r : runs) v.insert(v.end(), r.begin(), r.end());
+    return v;
+}
+
+// as many runs as there are, drawn with replacement, pooled
+std::vector<double> resampleRuns(const std::vector<std::vector<double>>& runs, std::mt19937& rng) {
+    std::uniform_int_distribution<size_t> pick(0, runs.size() - 1);
+    std::vector<double> v;
+    for (size_t r = 0; r < runs.size(); ++r) {
+        const std::vector<double>& run = runs[pick(rng)];
+        v.insert(v.end(), run.begin(), run.end());
+    }
+    return v;
+}
+
+// 95% interval of quantile(cur, q) / quantile(base, q) - 1, whole runs resampled on both sides independently;
+// a per-run metric is a run of one sample
+void bootstrap(const std::vector<std::vector<double>>& base, const std::vector<std::vector<double>>& cur, double q,
+               std::mt19937& rng, double& lo, double& mid, double& hi) {
+    std::vector<double> ratios(kResamples);
+    for (int k = 0; k < kResamples; ++k) {
+        double qa = quantile(resampleRuns(base, rng), q);
+        ratios[k] = qa > 0.0 ? quantile(resampleRuns(cur, rng), q) / qa - 1.0 : 0.0;
+    }
+    lo = quantile(ratios, 0.025); hi = quantile(ratios, 0.975);
+    double qb = quantile(pooled(base), q);
+    mid = qb > 0.0 ? quantile(pooled(cur), q) / qb - 1.0 : 0.0;
+}
+
+std::vector<std::vector<double>> perRun(const std::vector<double>& v) {
+    std::vector<std::vector<double>> runs;
+    for (double x : v) runs.push_back({ x });
+    return runs;
+}
+
+void writeNumbers(std::ostream& o, const std::vector<double>& v, const char* wrap) {
+    o << "[";
+    for (size_t i = 0; i < v.size(); ++i) o << (i ? (i % 16 ? ", " : wrap) : "") << v[i];
+    o << "]";
+}
+
+void writeArray(std::ostream& o, const char* name, const std::vector<double>& v, bool last) {
+    o << "      \"" << name << "\": ";
+    writeNumbers(o, v, ",\n        ");
+    o << (last ? "\n" : ",\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string exe = "./multiple_lights", baselinePath = "bench/perf_baseline.json", recordPath;
+    int runs = 10;
+    double toleranceScale = 1.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--exe" && i + 1 < argc) exe = argv[++i];
+        else if (a == "--baseline" && i + 1 < argc) baselinePath = argv[++i];
+        else if (a == "--record" && i + 1 < argc) recordPath = argv[++i];
+        else if (a == "--runs" && i + 1 < argc) runs = std::max(1, atoi(argv[++i]));
+        else if (a == "--tolerance-scale" && i + 1 < argc) toleranceScale = atof(argv[++i]);
+        else { std::cerr << "unknown argument " << a << "\n"; return 2; }
+    }
+    if (runs < kMinRuns) {
+        std::cerr << "--runs " << runs << ": at least " << kMinRuns << " runs are needed to judge per-run metrics\n";
+        return 2;
+    }
+
+    std::vector<Samples> results;
+    for (const Scenario& sc : kScenarios) {
+        Samples s;
+        if (!runScenario(exe, sc, runs, s)) { std::cerr << "scenario " << sc.name << " failed to run\n"; return 2; }
+        results.push_back(s);
+    }
+
+    if (!recordPath.empty()) {
+        std::ofstream o(recordPath);
+        o.precision(4);
+        o << std::fixed << "{\n  \"runs\": " << runs << ",\n  \"scenarios\": {\n";
+        for (size_t k = 0; k < results.size(); ++k) {
+            o << "    \"" << kScenarios[k].name << "\": {\n      \"args\": \"" << kScenarios[k].args << "\",\n";
+            // one array per run: runs are the bootstrap's unit
+            o << "      \"frame_ms\": [\n";
+            for (size_t r = 0; r < results[k].frameMs.size(); ++r) {
+                o << "        ";
+                writeNumbers(o, results[k].frameMs[r], ",\n         ");
+                o << (r + 1 < results[k].frameMs.size() ? ",\n" : "\n");
+            }
+            o << "      ],\n";
+            writeArray(o, "startup_ms", results[k].startupMs, false);
+            writeArray(o, "peak_rss_mb", results[k].peakRssMb, true);
+            o << "    }" << (k + 1 < results.size() ? ",\n" : "\n");
+        }
+        o << "  }\n}\n";
+        std::cerr << "baseline written to " << recordPath << "\n";
+        return o ? 0 : 2;
+    }
+
+    Json baseline;
+    if (!readJson(baselinePath, baseline)) { std::cerr << "can't read baseline " << baselinePath << "\n"; return 2; }
+    const Json* scenarios = baseline.get("scenarios");
+    const Json* baselineRuns = baseline.get("runs");
+    if (!baselineRuns || baselineRuns->num < kMinRuns) {
+        std::cerr << "baseline " << baselinePath << " has fewer than " << kMinRuns << " runs per scenario; re-record it\n";
+        return 2;
+    }
+
+    struct Check { const char* metric; double q; double tolerance; };
+    const Check checks[] = {
+        { "frame_ms",    0.50, 0.05 },
+        { "frame_ms",    0.99, 0.10 },
+        { "startup_ms",  0.50, 0.10 },
+        { "peak_rss_mb", 0.50, 0.05 },
+    };
+    std::mt19937 rng(12345); // fixed seed: the same samples always give the same verdict
+    int regressions = 0;
+    printf("%-12s %-12s %4s %11s %11s %8s %18s  %s\n", "scenario", "metric", "q", "baseline", "current", "change", "95% CI", "verdict");
+    for (size_t k = 0; k < results.size(); ++k) {
+        const Json* b = scenarios ? scenarios->get(kScenarios[k].name) : nullptr;
+        const Json* args = b ? b->get("args") : nullptr;
+        if (!args || args->str != kScenarios[k].args) {
+            std::cerr << "baseline has no matching '" << kScenarios[k].name << "' scenario; re-record it\n";
+            return 2;
+        }
+        for (const Check& c : checks) {
+            std::vector<std::vector<double>> base, cur;
+            const Samples& s = results[k];
+            if (c.metric[0] == 'f') {
+                const Json* runsJson = b->get(c.metric);
+                if (runsJson) for (const Json& r : runsJson->arr) base.push_back(numbers(&r));
+                cur = s.frameMs;
+            } else {
+                base = perRun(numbers(b->get(c.metric)));
+                cur = perRun(c.metric[0] == 's' ? s.startupMs : s.peakRssMb);
+            }
+            bool runsOk = (int)base.size() >= kMinRuns;
+            for (const std::vector<double>& r : base) runsOk = runsOk && !r.empty();
+            if (!runsOk) {
+                std::cerr << "baseline '" << kScenarios[k].name << "' " << c.metric << " isn't " << kMinRuns
+                          << " or more runs of samples; re-record it\n";
+                return 2;
+            }
+            double lo, mid, hi;
+            bootstrap(base, cur, c.q, rng, lo, mid, hi);
+            double tol = c.tolerance * toleranceScale;
+            const char* verdict = "ok";
+            if (lo > tol) { verdict = "REGRESSION"; ++regressions; }
+            else if (hi < -tol) verdict = "faster";
+            printf("%-12s %-12s %4.2f %11.3f %11.3f %+7.1f%% [%+6.1f%%, %+6.1f%%]  %s\n", kScenarios[k].name, c.metric, c.q,
+                   quantile(pooled(base), c.q), quantile(pooled(cur), c.q), mid * 100.0, lo * 100.0, hi * 100.0, verdict);
+        }
+    }
+    if (regressions) printf("%d significant regression(s)\n", regressions);
+    return regressions ? 1 : 0;
+}
@@ -0,0 +1,175 @@
+// === parameter sweep over the headless renderer ===
+// Runs `multiple_lights --headless --frames N --stats` once per configuration, a fresh process each so
+// startup and peak RSS belong to that point alone, and collects the "stats ..." lines into CSV and JSON.
+//
+// g++ -O2 -std=c++17 bench/sweep.cpp -o sweep
+// ./sweep --exe ./multiple_lights --out sweep             one axis at a time around the base point
+// ./sweep --full --res 64,256,1024 --lights 4,64          full grid over the given values
+//
+// Axes: --res (square rings x segments), --lights, --instances, --size (WxH), --variant (default,
+// lighttree, shlights). Each takes a comma-separated list; the first value of an axis is not special,
+// the base point is --base-res/--base-lights/... (defaults 256, 4, 1, 1280x720, default).
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Axis {
+    const char* name;           // also the renderer flag, without the dashes
+    std::string base;
+    std::vector<std::string> values;
+};
+
+std::vector<std::string> splitList(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    for (std::string item; std::getline(ss, item, ',');)
+        if (!item.empty()) out.push_back(item);
+    return out;
+}
+
+typedef std::vector<std::pair<std::string, std::string>> Record;
+
+// key=value pairs of the renderer's stats line; empty if the run printed none
+Record runPoint(const std::string& cmd) {
+    Record r;
+    FILE* p = popen(cmd.c_str(), "r");
+    if (!p) return r;
+    char line[4096];
+    while (fgets(line, sizeof(line), p)) {
+        if (strncmp(line, "stats ", 6)) continue;
+        std::stringstream ss(line + 6);
+        for (std::string kv; ss >> kv;) {
+            size_t eq = kv.find('=');
+            if (eq != std::string::npos) r.push_back({ kv.substr(0, eq), kv.substr(eq + 1) });
+        }
+    }
+    int status = pclose(p);
+    if (status != 0) r.push_back({ "exit_status", std::to_string(status) });
+    return r;
+}
+
+bool isNumber(const std::string& s) {
+    if (s.empty()) return false;
+    char* end = nullptr;
+    strtod(s.c_str(), &end);
+    return *end == '\0';
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<Axis> axes = {
+        { "res",       "256",      { "64", "128", "256", "512", "1024", "2048", "4096" } },
+        { "lights",    "4",        { "1", "4", "16", "64", "256", "1024", "4096" } },
+        { "instances", "1",        { "1", "4", "16", "64", "256" } },
+        { "size",      "1280x720", { "320x180", "640x360", "1280x720", "1920x1080", "3840x2160" } },
+        { "variant",   "default",  { "default", "lighttree", "shlights" } },
+    };
+    std::string exe = "./multiple_lights", out = "sweep";
+    int frames = 120;
+    bool full = false, dryRun = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (a == "--full") full = true;
+        else if (a == "--dry-run") dryRun = true;
+        else if (a == "--exe" && hasValue) exe = argv[++i];
+        else if (a == "--out" && hasValue) out = argv[++i];
+        else if (a == "--frames" && hasValue) frames = atoi(argv[++i]);
+        else {
+            bool known = false;
+            for (Axis& ax : axes) {
+                if (!hasValue) break;
+                if (a == std::string("--") + ax.name) { ax.values = splitList(argv[++i]); known = true; break; }
+                if (a == std::string("--base-") + ax.name) { ax.base = argv[++i]; known = true; break; }
+            }
+            if (!known) { std::cerr << "unknown argument " << a << "\n"; return 1; }
+        }
+    }
+
+    // every point as one value per axis
+    std::vector<std::vector<std::string>> points;
+    if (full) {
+        points.push_back({});
+        for (const Axis& ax : axes) {
+            std::vector<std::vector<std::string>> next;
+            for (const auto& p : points)
+                for (const std::string& v : ax.values) { next.push_back(p); next.back().push_back(v); }
+            points.swap(next);
+        }
+    } else {
+        std::vector<std::string> base;
+        for (const Axis& ax : axes) base.push_back(ax.base);
+        points.push_back(base);
+        for (size_t k = 0; k < axes.size(); ++k)
+            for (const std::string& v : axes[k].values) {
+                if (v == axes[k].base) continue;
+                points.push_back(base);
+                points.back()[k] = v;
+            }
+    }
+
+    std::ofstream csv(out + ".csv"), json(out + ".json");
+    if (!dryRun && (!csv || !json)) { std::cerr << "can't write " << out << ".csv/.json\n"; return 1; }
+    std::vector<std::string> columns; // from the first successful run; later runs print the same keys
+    json << "[\n";
+    bool firstJson = true;
+    int failed = 0;
+
+    for (size_t n = 0; n < points.size(); ++n) {
+        const auto& p = points[n];
+        std::string cmd = exe + " --headless --stats --frames " + std::to_string(frames);
+        for (size_t k = 0; k < axes.size(); ++k) {
+            if (!strcmp(axes[k].name, "variant")) {
+                if (p[k] != "default") cmd += " --" + p[k];
+            } else {
+                cmd += std::string(" --") + axes[k].name + " " + p[k];
+            }
+        }
+        cmd += " 2>/dev/null";
+        std::cerr << "[" << n + 1 << "/" << points.size() << "] " << cmd << "\n";
+        if (dryRun) continue;
+
+        Record r = runPoint(cmd);
+        // the requested point first, so failed runs still say what they were
+        Record row;
+        for (size_t k = 0; k < axes.size(); ++k) row.push_back({ std::string("req_") + axes[k].name, p[k] });
+        bool ok = false;
+        for (const auto& kv : r) { row.push_back(kv); ok = ok || kv.first == "frames"; }
+        if (!ok) { ++failed; std::cerr << "  no stats line\n"; }
+
+        if (columns.empty() && ok) {
+            for (const auto& kv : row) columns.push_back(kv.first);
+            for (size_t c = 0; c < columns.size(); ++c) csv << (c ? "," : "") << columns[c];
+            csv << "\n";
+        }
+        if (ok) {
+            for (size_t c = 0; c < columns.size(); ++c) {
+                std::string v;
+                for (const auto& kv : row) if (kv.first == columns[c]) { v = kv.second; break; }
+                csv << (c ? "," : "") << v;
+            }
+            csv << "\n" << std::flush;
+        }
+
+        json << (firstJson ? "  {" : ",\n  {");
+        firstJson = false;
+        for (size_t c = 0; c < row.size(); ++c) {
+            json << (c ? ", " : "") << "\"" << row[c].first << "\": ";
+            if (isNumber(row[c].second)) json << row[c].second;
+            else json << "\"" << row[c].second << "\"";
+        }
+        json << ", \"ok\": " << (ok ? "true" : "false") << "}" << std::flush;
+    }
+    json << "\n]\n";
+    std::cerr << points.size() - failed << " of " << points.size() << " points ran, results in " << out << ".csv / .json\n";
+    return failed ? 2 : 0;
+}
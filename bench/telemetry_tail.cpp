@@ -0,0 +1,64 @@
+// === telemetry-tail: minimal sidecar for the renderer's shared-memory telemetry ring ===
+// Polls the ring and prints one line per frame record, or a once-a-second summary with --summary.
+//
+// g++ -O2 -std=c++17 -I. bench/telemetry_tail.cpp telemetry.cpp -pthread -o telemetry_tail
+// ./multiple_lights --telemetry-shm /kinetic-telemetry &
+// ./telemetry_tail /kinetic-telemetry
+#include "telemetry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv) {
+    std::string name = "/kinetic-telemetry";
+    bool summary = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--summary")) summary = true;
+        else name = argv[i];
+    }
+
+    TelemetryReader reader;
+    // the renderer may not be up yet
+    for (int tries = 0; !openTelemetryReader(reader, name); ++tries) {
+        if (tries == 0) fprintf(stderr, "waiting for %s\n", name.c_str());
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    std::vector<TelemetryRecord> batch(256);
+    uint64_t lastDropped = 0, frames = 0;
+    double worstMs = 0.0, sumMs = 0.0;
+    auto lastPrint = std::chrono::steady_clock::now();
+    for (;;) {
+        size_t n = readTelemetry(reader, batch.data(), batch.size());
+        for (size_t i = 0; i < n; ++i) {
+            const TelemetryRecord& r = batch[i];
+            if (!summary) {
+                printf("frame=%llu t=%.3f frame_ms=%.3f cpu_ms=%.3f gpu_ms=%.3f lights=%u triangles=%llu upload_bytes=%llu allocs=%llu "
+                       "gpu_bytes=%llu cpu_bytes=%llu\n",
+                       (unsigned long long)r.frame, r.timeS, r.frameMs, r.cpuMs, r.gpuMs, r.lights,
+                       (unsigned long long)r.triangles, (unsigned long long)r.uploadBytes, (unsigned long long)r.allocations,
+                       (unsigned long long)r.gpuBytes, (unsigned long long)r.cpuBytes);
+            }
+            ++frames; sumMs += r.frameMs;
+            if (r.frameMs > worstMs) worstMs = r.frameMs;
+        }
+        uint64_t dropped = reader.ring->dropped.load(std::memory_order_relaxed);
+        if (dropped != lastDropped) {
+            fprintf(stderr, "%llu records dropped (reader too slow)\n", (unsigned long long)(dropped - lastDropped));
+            lastDropped = dropped;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (summary && now - lastPrint >= std::chrono::seconds(1)) {
+            printf("frames=%llu mean_frame_ms=%.3f max_frame_ms=%.3f\n", (unsigned long long)frames,
+                   frames ? sumMs / frames : 0.0, worstMs);
+            frames = 0; sumMs = worstMs = 0.0;
+            lastPrint = now;
+        }
+        fflush(stdout);
+        if (n == 0) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+}
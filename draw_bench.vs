@@ -0,0 +1,30 @@
+#version 330 core
+// --bench-draws: where the per-object matrix comes from; MODEL_FROM is set per strategy
+//   0 uniform (glUniformMatrix4fv per draw)   1 uniform block range (glBindBufferRange per draw)
+//   2 per-instance attribute (instanced and indirect draws)   3 texture buffer indexed by a per-vertex object id
+// the matrix is the whole transform, the benchmark has no camera
+#ifndef MODEL_FROM
+#define MODEL_FROM 0
+#endif
+layout(location=0) in vec3 aPos;
+#if MODEL_FROM == 0
+uniform mat4 uModel;
+#elif MODEL_FROM == 1
+layout(std140) uniform DrawModel { mat4 uModel; };
+#elif MODEL_FROM == 2
+layout(location=1) in mat4 aModel;      // locations 1-4, divisor 1
+#else
+layout(location=5) in float aObject;
+uniform samplerBuffer uModels;          // 4 RGBA32F texels per matrix
+#endif
+void main(){
+#if MODEL_FROM == 2
+    mat4 model = aModel;
+#elif MODEL_FROM == 3
+    int b = int(aObject) * 4;
+    mat4 model = mat4(texelFetch(uModels, b), texelFetch(uModels, b + 1), texelFetch(uModels, b + 2), texelFetch(uModels, b + 3));
+#else
+    mat4 model = uModel;
+#endif
+    gl_Position = model * vec4(aPos, 1.0);
+}
@@ -0,0 +1,91 @@
+#include "frame_stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+SampleSummary summarize(const std::vector<double>& samples) {
+    SampleSummary s;
+    if (samples.empty()) return s;
+    std::vector<double> v(samples);
+    std::sort(v.begin(), v.end());
+    double sum = 0.0;
+    for (double x : v) sum += x;
+    auto at = [&](double q) { return v[std::min(v.size() - 1, (size_t)(q * (v.size() - 1) + 0.5))]; };
+    s.mean = sum / v.size();
+    s.p50 = at(0.5); s.p99 = at(0.99); s.max = v.back();
+    return s;
+}
+
+double processMs() {
+    static const auto t0 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+#ifdef __linux__
+double processCpuSeconds() {
+    rusage ru; getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1e-6;
+}
+size_t currentRssBytes() {
+    // second field of statm is resident pages
+    long pages = 0, resident = 0;
+    if (FILE* f = fopen("/proc/self/statm", "r")) {
+        if (fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        fclose(f);
+    }
+    return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+}
+size_t peakRssBytes() {
+    rusage ru; getrusage(RUSAGE_SELF, &ru);
+    return (size_t)ru.ru_maxrss * 1024; // kilobytes on Linux
+}
+#else
+double processCpuSeconds() { return 0.0; }
+size_t currentRssBytes() { return 0; }
+size_t peakRssBytes() { return 0; }
+#endif
+
+std::string statsLine(const FrameStats& s, const std::string& extra) {
+    SampleSummary cpu = summarize(s.cpuMs), gpu = summarize(s.gpuMs), frame = summarize(s.frameMs);
+    std::ostringstream o;
+    o.precision(4);
+    o << std::fixed << "stats frames=" << s.cpuMs.size()
+      << " startup_ms=" << s.startupMs
+      << " cpu_ms=" << cpu.mean << " cpu_p50_ms=" << cpu.p50 << " cpu_p99_ms=" << cpu.p99
+      << " gpu_ms=" << gpu.mean << " gpu_p50_ms=" << gpu.p50 << " gpu_p99_ms=" << gpu.p99
+      << " frame_ms=" << frame.mean << " frame_p50_ms=" << frame.p50 << " frame_p99_ms=" << frame.p99
+      << " frame_max_ms=" << frame.max
+      << " process_cpu_s=" << processCpuSeconds()
+      << " rss_mb=" << currentRssBytes() / (1024.0 * 1024.0)
+      << " peak_rss_mb=" << peakRssBytes() / (1024.0 * 1024.0);
+    if (!extra.empty()) o << ' ' << extra;
+    return o.str();
+}
+
+bool writeSamplesJson(const FrameStats& s, const std::string& path, const std::string& extra) {
+    std::ofstream f(path);
+    if (!f) return false;
+    auto array = [&](const char* name, const std::vector<double>& v) {
+        f << "  \"" << name << "\": [";
+        for (size_t i = 0; i < v.size(); ++i) f << (i ? (i % 16 ? ", " : ",\n    ") : "") << v[i];
+        f << "],\n";
+    };
+    f.precision(4);
+    f << std::fixed << "{\n";
+    array("frame_ms", s.frameMs);
+    array("cpu_ms", s.cpuMs);
+    array("gpu_ms", s.gpuMs);
+    f << "  \"startup_ms\": " << s.startupMs << ",\n"
+      << "  \"peak_rss_mb\": " << peakRssBytes() / (1024.0 * 1024.0);
+    if (!extra.empty()) f << ",\n  " << extra;
+    f << "\n}\n";
+    return (bool)f;
+}
@@ -0,0 +1,34 @@
+#pragma once
+// === frame timing samples and process counters for the benchmark modes ===
+// GL-free: the renderer feeds it CPU and GPU milliseconds per frame, the summary goes out as one
+// "stats key=value ..." line that bench/sweep.cpp (and anything else) can parse.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct SampleSummary {
+    double mean = 0.0, p50 = 0.0, p99 = 0.0, max = 0.0;
+};
+// copies and sorts; empty input gives all zeros
+SampleSummary summarize(const std::vector<double>& samples);
+
+struct FrameStats {
+    std::vector<double> cpuMs;      // CPU work per frame, from frame start to just before the swap
+    std::vector<double> gpuMs;      // GL_TIME_ELAPSED over the frame's GL commands
+    std::vector<double> frameMs;    // frame start to next frame start
+    double startupMs = 0.0;         // process start (first call of processMs()) to the end of the first frame
+};
+
+// milliseconds since the first call; call it early in main() so it marks process start
+double processMs();
+// user + system time of every thread in the process, seconds
+double processCpuSeconds();
+// resident set size; peak is the high-water mark the kernel keeps for us
+size_t currentRssBytes();
+size_t peakRssBytes();
+
+// the summary line; `extra` is appended as is ("key=value key=value")
+std::string statsLine(const FrameStats& s, const std::string& extra);
+// every sample plus startup and peak RSS as one JSON object (bench/perf_check.cpp bootstraps from these);
+// `extra` is more members as is ("\"key\": value, ...")
+bool writeSamplesJson(const FrameStats& s, const std::string& path, const std::string& extra = std::string());
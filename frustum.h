@@ -0,0 +1,32 @@
+#pragma once
+// === view frustum planes for culling, shared by the sculpture and gallery streamers ===
+#include <glm/glm.hpp>
+
+struct Frustum {
+    glm::vec4 planes[6];        // normalized, inside where dot(xyz, p) + w >= 0
+};
+
+// planes of a clip matrix: proj * view gives world space, proj * view * model the model's space
+inline Frustum frustumOf(const glm::mat4& clip) {
+    glm::mat4 m = glm::transpose(clip);
+    Frustum f;
+    f.planes[0] = m[3] + m[0]; f.planes[1] = m[3] - m[0];
+    f.planes[2] = m[3] + m[1]; f.planes[3] = m[3] - m[1];
+    f.planes[4] = m[3] + m[2]; f.planes[5] = m[3] - m[2];
+    for (glm::vec4& p : f.planes) p = p * (1.0f / glm::length(glm::vec3(p)));
+    return f;
+}
+
+inline bool sphereVisible(const Frustum& f, glm::vec3 c, float r) {
+    for (const glm::vec4& p : f.planes)
+        if (glm::dot(glm::vec3(p), c) + p.w < -r) return false;
+    return true;
+}
+
+inline bool boxVisible(const Frustum& f, glm::vec3 lo, glm::vec3 hi) {
+    for (const glm::vec4& p : f.planes) {
+        glm::vec3 far(p.x > 0 ? hi.x : lo.x, p.y > 0 ? hi.y : lo.y, p.z > 0 ? hi.z : lo.z);
+        if (glm::dot(glm::vec3(p), far) + p.w < 0.0f) return false;
+    }
+    return true;
+}
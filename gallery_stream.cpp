@@ -0,0 +1,263 @@
+#include "gallery_stream.h"
+
+#include "frustum.h"
+#include "memory_registry.h"
+#include "sculpture_geometry.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace {
+
+const uint64_t kSectorJob = 1ull << 63;
+const float kUnloadSlack = 1.25f;           // hysteresis: a sector at the edge doesn't load and drop every frame
+const float kPrefetchPriority = 1000.0f;    // instances in range but outside the view come after all visible ones
+const float kUnknownRadius = 2.5f;          // a design's reach before its mesh exists
+const size_t kMaxReadyBytes = 32u << 20;    // generated and waiting for upload
+const size_t kMaxQueue = 4096;
+
+uint64_t sectorKey(int x, int z) { return kSectorJob | (uint64_t)(uint32_t)x << 24 | (uint64_t)(uint32_t)z; }
+
+float boxDistance(glm::vec3 p, glm::vec3 lo, glm::vec3 hi) {
+    return glm::length(glm::max(glm::max(lo - p, p - hi), glm::vec3(0.0f)));
+}
+
+void workerLoop(GalleryStream* g) {
+    std::unique_lock<std::mutex> lock(g->mtx);
+    for (;;) {
+        g->wake.wait(lock, [&] { return g->quit || (!g->queue.empty() && g->readyBytes < kMaxReadyBytes); });
+        if (g->quit) return;
+        GalleryJob job = g->queue.back();
+        g->queue.pop_back();
+        if (g->inFlight.count(job.key)) continue;
+        g->inFlight.insert(job.key);
+        lock.unlock();
+
+        if (job.key & kSectorJob) {
+            GallerySector s;
+            int x = (int)(job.key >> 24 & 0xffffff), z = (int)(job.key & 0xffffff);
+            bool ok = readGallerySector(g->world, x, z, s);
+            lock.lock();
+            // an unreadable sector stays empty rather than being asked for again every frame
+            if (!ok) { s = GallerySector(); s.x = x; s.z = z; }
+            g->readySectors.push_back(std::move(s));
+        } else {
+            const GalleryDesign& d = g->world.designs[job.key];
+            std::vector<float> v;
+            sculptureVertices(v, d.rows, d.cols, d.time, nullptr, d.shape, GeometryKernel::Simd);
+            lock.lock();
+            g->readyBytes += v.size() * sizeof(float);
+            g->readyMeshes.push_back({ (uint32_t)job.key, std::move(v) });
+        }
+    }
+}
+
+// makes room for `bytes` more under the cap, least recently drawn first; false if that would take a
+// mesh drawn last frame
+bool makeRoom(GalleryStream& g, size_t bytes) {
+    while (g.stats.meshBytes + bytes > g.settings.gpuBytes || !memoryFits(MemDomain::Gpu, bytes)) {
+        auto victim = g.meshes.end();
+        for (auto it = g.meshes.begin(); it != g.meshes.end(); ++it)
+            if (victim == g.meshes.end() || it->second.lastUsed < victim->second.lastUsed) victim = it;
+        if (victim == g.meshes.end() || victim->second.lastUsed + 1 >= g.frame) return false;
+        g.stats.meshBytes -= victim->second.bytes;
+        g.meshes.erase(victim);         // the buffer goes back to the pool
+        ++g.stats.meshEvictions;
+    }
+    return true;
+}
+
+void uploadMesh(GalleryStream& g, uint32_t design, const std::vector<float>& v) {
+    const GalleryDesign& d = g.world.designs[design];
+    size_t bytes = v.size() * sizeof(float);
+    if (!makeRoom(g, bytes)) {
+        ++g.stats.meshDropped;          // everything resident is in view; asked for again while it's needed
+        return;
+    }
+    GalleryMesh& m = g.meshes[design];
+    m.bytes = bytes;
+    m.lastUsed = g.frame;
+    m.topology = acquireGridTopology(d.rows, d.cols, IndexLayout::Triangles);
+    m.vao = genVertexArray();
+    m.vbo = acquireBuffer(*g.buffers, bytes, MemTag::Sculpture, GL_STATIC_DRAW);
+    glBindVertexArray(m.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)bytes, v.data());
+    GLsizei stride = kVertexFloats * sizeof(float);
+    glEnableVertexAttribArray(0); glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glEnableVertexAttribArray(1); glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(2); glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m.topology->ebo);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    float r2 = 0.0f;
+    for (size_t i = 0; i + kVertexFloats <= v.size(); i += kVertexFloats)
+        r2 = std::max(r2, v[i] * v[i] + v[i + 1] * v[i + 1] + v[i + 2] * v[i + 2]);
+    m.radius = sqrtf(r2);
+    g.stats.meshBytes += bytes;
+    ++g.stats.meshUploads;
+}
+
+} // namespace
+
+void startGallery(GalleryStream& g, const GalleryWorld& world, const GallerySettings& settings, BufferPool& buffers) {
+    g.world = world;
+    g.settings = settings;
+    g.buffers = &buffers;
+    int workers = settings.workers > 0 ? settings.workers : (int)std::thread::hardware_concurrency() / 2;
+    if (workers < 1) workers = 1;
+    for (int i = 0; i < workers; ++i) g.workers.emplace_back(workerLoop, &g);
+}
+
+void updateGallery(GalleryStream& g, const glm::mat4& proj, const glm::mat4& view) {
+    ++g.frame;
+    const GallerySettings& st = g.settings;
+    const GalleryWorld& w = g.world;
+    glm::vec3 eye = glm::vec3(glm::inverse(view)[3]);
+
+    // finished work, within this frame's budgets
+    std::vector<GallerySector> sectors;
+    std::vector<std::pair<uint32_t, std::vector<float>>> meshes;
+    {
+        std::lock_guard<std::mutex> lock(g.mtx);
+        size_t n = std::min(g.readySectors.size(), (size_t)std::max(st.sectorsPerFrame, 1));
+        std::move(g.readySectors.begin(), g.readySectors.begin() + n, std::back_inserter(sectors));
+        g.readySectors.erase(g.readySectors.begin(), g.readySectors.begin() + n);
+        size_t bytes = 0, m = 0;
+        while (m < g.readyMeshes.size() && (m == 0 || bytes + g.readyMeshes[m].second.size() * sizeof(float) <= st.uploadBytesPerFrame))
+            bytes += g.readyMeshes[m++].second.size() * sizeof(float);
+        std::move(g.readyMeshes.begin(), g.readyMeshes.begin() + m, std::back_inserter(meshes));
+        g.readyMeshes.erase(g.readyMeshes.begin(), g.readyMeshes.begin() + m);
+        g.readyBytes -= bytes;
+        for (const GallerySector& s : sectors) g.inFlight.erase(sectorKey(s.x, s.z));
+        for (auto& mesh : meshes) g.inFlight.erase(mesh.first);
+        trackCpu(&g.readyMeshes, MemTag::Scratch, g.readyBytes);
+    }
+    bool changed = false;
+    for (GallerySector& s : sectors) {
+        std::pair<int, int> key(s.x, s.z);
+        // a sector dropped while its read was in flight isn't wanted any more
+        if (boxDistance(eye, sectorMin(w, s.x, s.z), sectorMax(w, s.x, s.z)) > st.loadRadius * kUnloadSlack) continue;
+        g.sectors[key] = std::move(s);
+        ++g.stats.sectorLoads;
+        changed = true;
+    }
+    for (auto& mesh : meshes)
+        if (!g.meshes.count(mesh.first)) uploadMesh(g, mesh.first, mesh.second);
+
+    for (auto it = g.sectors.begin(); it != g.sectors.end();) {
+        int x = it->first.first, z = it->first.second;
+        if (boxDistance(eye, sectorMin(w, x, z), sectorMax(w, x, z)) > st.loadRadius * kUnloadSlack) {
+            it = g.sectors.erase(it);
+            ++g.stats.sectorUnloads;
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+    if (changed) {
+        g.lights.clear();
+        for (auto& s : g.sectors) g.lights.insert(g.lights.end(), s.second.lights.begin(), s.second.lights.end());
+        g.lightsChanged = true;
+    }
+
+    // sectors in reach that aren't loaded yet
+    std::vector<GalleryJob> jobs;
+    int reach = (int)ceil(st.loadRadius / w.sectorSize) + 1;
+    int cx = (int)floor(eye.x / w.sectorSize), cz = (int)floor(eye.z / w.sectorSize);
+    for (int z = std::max(cz - reach, 0); z <= std::min(cz + reach, w.sectorsZ - 1); ++z) {
+        for (int x = std::max(cx - reach, 0); x <= std::min(cx + reach, w.sectorsX - 1); ++x) {
+            float d = boxDistance(eye, sectorMin(w, x, z), sectorMax(w, x, z));
+            if (d <= st.loadRadius && !g.sectors.count({ x, z })) jobs.push_back({ sectorKey(x, z), -1.0f / (1.0f + d) });
+        }
+    }
+
+    // draw list; visible instances without a mesh ask for it, ones in range behind the camera prefetch it
+    Frustum f = frustumOf(proj * view);
+    g.drawList.clear();
+    g.stats.drawn = g.stats.missing = 0;
+    g.stats.triangles = 0;
+    for (auto& entry : g.sectors) {
+        const GallerySector& s = entry.second;
+        if (boxDistance(eye, sectorMin(w, s.x, s.z), sectorMax(w, s.x, s.z)) > st.drawRadius) continue;
+        bool sectorVisible = boxVisible(f, sectorMin(w, s.x, s.z), sectorMax(w, s.x, s.z));
+        for (const GalleryInstance& in : s.instances) {
+            float dist = glm::length(in.position - eye);
+            if (dist > st.drawRadius) continue;
+            auto mesh = g.meshes.find(in.design);
+            float radius = (mesh != g.meshes.end() ? mesh->second.radius : kUnknownRadius) * in.scale;
+            bool visible = sectorVisible && sphereVisible(f, in.position, radius);
+            if (mesh == g.meshes.end()) {
+                jobs.push_back({ in.design, dist + (visible ? 0.0f : kPrefetchPriority) });
+                g.stats.missing += visible;
+                continue;
+            }
+            if (!visible) continue;
+            mesh->second.lastUsed = g.frame;
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), in.position);
+            model = glm::rotate(model, in.yaw, glm::vec3(0, 1, 0));
+            model = glm::scale(model, glm::vec3(in.scale));
+            g.drawList.push_back({ in.design, model });
+            g.stats.triangles += mesh->second.topology->triangles;
+        }
+    }
+    // one VAO bind per design
+    std::sort(g.drawList.begin(), g.drawList.end(),
+              [](const GalleryDraw& a, const GalleryDraw& b) { return a.design < b.design; });
+    g.stats.drawn = (int)g.drawList.size();
+
+    // best last, one entry per job
+    std::sort(jobs.begin(), jobs.end(), [](const GalleryJob& a, const GalleryJob& b) {
+        return a.key != b.key ? a.key < b.key : a.priority < b.priority;
+    });
+    jobs.erase(std::unique(jobs.begin(), jobs.end(), [](const GalleryJob& a, const GalleryJob& b) { return a.key == b.key; }),
+               jobs.end());
+    std::sort(jobs.begin(), jobs.end(), [](const GalleryJob& a, const GalleryJob& b) { return a.priority > b.priority; });
+    if (jobs.size() > kMaxQueue) jobs.erase(jobs.begin(), jobs.end() - kMaxQueue);
+    {
+        std::lock_guard<std::mutex> lock(g.mtx);
+        g.queue.clear();
+        for (const GalleryJob& j : jobs)
+            if (!g.inFlight.count(j.key)) g.queue.push_back(j);
+        g.stats.pending = (int)(g.queue.size() + g.inFlight.size());
+    }
+    g.wake.notify_all();
+
+    g.stats.sectorsLoaded = (int)g.sectors.size();
+    g.stats.meshesResident = (int)g.meshes.size();
+}
+
+void drawGallery(GalleryStream& g, GLint modelLoc) {
+    uint32_t bound = UINT32_MAX;
+    const GalleryMesh* mesh = nullptr;
+    for (const GalleryDraw& d : g.drawList) {
+        if (d.design != bound) {
+            bound = d.design;
+            mesh = &g.meshes[d.design];
+            glBindVertexArray(mesh->vao);
+        }
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(d.model));
+        glDrawElements(mesh->topology->mode, mesh->topology->indexCount, GL_UNSIGNED_INT, 0);
+    }
+    glBindVertexArray(0);
+}
+
+void stopGallery(GalleryStream& g) {
+    {
+        std::lock_guard<std::mutex> lock(g.mtx);
+        g.quit = true;
+    }
+    g.wake.notify_all();
+    for (std::thread& t : g.workers) t.join();
+    g.workers.clear();
+    untrackCpu(&g.readyMeshes);
+    g.readyMeshes.clear();
+    g.readySectors.clear();
+    g.meshes.clear();
+    g.sectors.clear();
+    g.drawList.clear();
+}
@@ -0,0 +1,98 @@
+#pragma once
+// === gallery streaming: sectors and design meshes loaded around the camera on worker threads ===
+// Sectors whose bounds come within `loadRadius` of the camera are read from disk on the workers; those
+// that drift past 1.25x that are dropped with their lights. Each visible instance within `drawRadius`
+// needs its design's mesh. Meshes are generated on the workers, then shared by every instance of that
+// design. The main thread only integrates finished work, within per-frame budgets (sectors, upload
+// bytes), so streaming never turns into a hitch. Resident mesh memory is capped: past `gpuBytes` the
+// least recently drawn meshes are evicted, never one drawn last frame. Until its mesh arrives an
+// instance simply isn't drawn.
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "gallery_world.h"
+#include "gl_resources.h"
+#include "grid_topology.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+struct GallerySettings {
+    float loadRadius = 72.0f;
+    float drawRadius = 60.0f;
+    size_t gpuBytes = 256u << 20;               // resident mesh vertices
+    size_t uploadBytesPerFrame = 4u << 20;      // at least one mesh a frame goes up regardless
+    int sectorsPerFrame = 2;                    // finished sector reads integrated per frame
+    int workers = 0;                            // 0 = half the hardware threads, at least one
+};
+
+struct GalleryStats {
+    uint64_t sectorLoads = 0, sectorUnloads = 0, meshUploads = 0, meshEvictions = 0, meshDropped = 0;
+    int sectorsLoaded = 0, meshesResident = 0, pending = 0;
+    size_t meshBytes = 0;
+    int drawn = 0, missing = 0;                 // this frame: instances drawn, visible ones still waiting
+    long long triangles = 0;
+};
+
+struct GalleryMesh {
+    GlVertexArray vao;
+    PooledBuffer vbo;
+    GridTopologyRef topology;
+    size_t bytes = 0;
+    float radius = 0.0f;                        // about the instance origin at scale 1
+    uint64_t lastUsed = 0;
+};
+
+struct GalleryDraw {
+    uint32_t design = 0;
+    glm::mat4 model = glm::mat4(1.0f);
+};
+
+struct GalleryJob {
+    uint64_t key = 0;                           // a sector (top bit set) or a design
+    float priority = 0.0f;                      // lower first
+};
+
+struct GalleryStream {
+    GalleryWorld world;
+    GallerySettings settings;
+    BufferPool* buffers = nullptr;
+
+    // main thread
+    std::map<std::pair<int, int>, GallerySector> sectors;
+    std::unordered_map<uint32_t, GalleryMesh> meshes;
+    std::vector<GalleryDraw> drawList;
+    std::vector<PointLight> lights;             // every loaded sector's, in sector order
+    bool lightsChanged = false;                 // set when `lights` was rebuilt; the caller clears it
+    uint64_t frame = 0;
+    GalleryStats stats;
+
+    // shared with the workers, under mtx
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::vector<GalleryJob> queue;              // replaced every frame, best last
+    std::unordered_set<uint64_t> inFlight;      // being worked on or waiting to be integrated
+    std::vector<GallerySector> readySectors;
+    std::vector<std::pair<uint32_t, std::vector<float>>> readyMeshes;
+    size_t readyBytes = 0;                      // generated vertices not yet uploaded; bounds CPU memory
+    bool quit = false;
+    std::vector<std::thread> workers;
+};
+
+// reads nothing yet beyond the world, which the caller has loaded; starts the workers
+void startGallery(GalleryStream& g, const GalleryWorld& world, const GallerySettings& settings, BufferPool& buffers);
+// once per frame before drawing: integrates finished work, drops far sectors, builds the draw list and
+// queues what the view needs next, nearest first
+void updateGallery(GalleryStream& g, const glm::mat4& proj, const glm::mat4& view);
+// the draw list with the sculpture program bound; `modelLoc` is its uModel
+void drawGallery(GalleryStream& g, GLint modelLoc);
+// joins the workers and frees every mesh
+void stopGallery(GalleryStream& g);
@@ -0,0 +1,236 @@
+#include "gallery_world.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <sys/stat.h>
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace {
+
+// on-disk records; fixed-size fields only, so the structs are the file layout
+struct WorldHeader {
+    uint32_t magic = kGalleryWorldMagic, version = kGalleryVersion;
+    float sectorSize = 0.0f;
+    int32_t sectorsX = 0, sectorsZ = 0;
+    uint32_t designCount = 0;
+};
+struct DesignRecord {
+    float a, b, n;
+    uint32_t profile;
+    float twist, waveAmp, waveU, waveV, waveSpeed;
+    int32_t rows, cols;
+    float time;
+};
+struct SectorHeader {
+    uint32_t magic = kGallerySectorMagic, version = kGalleryVersion;
+    int32_t x = 0, z = 0;
+    uint32_t instanceCount = 0, lightCount = 0;
+};
+struct InstanceRecord {
+    uint32_t design;
+    float position[3];
+    float yaw, scale;
+};
+struct LightRecord {
+    float position[3], color[3];
+    float linear, quadratic;
+};
+static_assert(sizeof(WorldHeader) == 24 && sizeof(DesignRecord) == 48 && sizeof(SectorHeader) == 24 &&
+              sizeof(InstanceRecord) == 24 && sizeof(LightRecord) == 32, "gallery records must stay packed");
+
+const float kTallest = 6.0f;            // sculptures stand up to 4.5 units, lights hang below 5.5
+const float kOverhang = 2.0f;           // how far a sculpture near the edge reaches into the next sector
+const uint32_t kMaxRecords = 1u << 20;  // per file; anything bigger is a corrupt count
+const int32_t kMaxDesignSide = 16384;   // design rings or segments; the scene's grid limit too
+
+template<class T> bool readAll(FILE* f, T* out, size_t n) { return fread(out, sizeof(T), n, f) == n; }
+
+} // namespace
+
+glm::vec3 sectorMin(const GalleryWorld& w, int x, int z) {
+    return glm::vec3(x * w.sectorSize - kOverhang, 0.0f, z * w.sectorSize - kOverhang);
+}
+
+glm::vec3 sectorMax(const GalleryWorld& w, int x, int z) {
+    return glm::vec3((x + 1) * w.sectorSize + kOverhang, kTallest, (z + 1) * w.sectorSize + kOverhang);
+}
+
+std::string sectorPath(const GalleryWorld& w, int x, int z) {
+    return w.dir + "/sector_" + std::to_string(x) + "_" + std::to_string(z) + ".bin";
+}
+
+bool readGalleryWorld(const std::string& dir, GalleryWorld& out) {
+    std::string path = dir + "/world.bin";
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    WorldHeader h;
+    bool ok = readAll(f, &h, 1) && h.magic == kGalleryWorldMagic && h.version == kGalleryVersion && h.sectorSize > 0.0f
+           && h.sectorsX > 0 && h.sectorsZ > 0 && h.designCount > 0 && h.designCount <= kMaxRecords;
+    std::vector<DesignRecord> records(ok ? h.designCount : 0);
+    ok = ok && readAll(f, records.data(), records.size());
+    fclose(f);
+    for (const DesignRecord& r : records) ok = ok && r.rows <= kMaxDesignSide && r.cols <= kMaxDesignSide;
+    if (!ok) {
+        fprintf(stderr, "%s is not a version %u gallery world\n", path.c_str(), kGalleryVersion);
+        return false;
+    }
+    out = GalleryWorld();
+    out.dir = dir;
+    out.sectorSize = h.sectorSize;
+    out.sectorsX = h.sectorsX; out.sectorsZ = h.sectorsZ;
+    for (const DesignRecord& r : records) {
+        GalleryDesign d;
+        d.shape.a = r.a; d.shape.b = r.b; d.shape.n = r.n;
+        d.shape.profile = r.profile <= (uint32_t)Profile::Bulb ? (Profile)r.profile : Profile::Straight;
+        d.shape.twist = r.twist; d.shape.waveAmp = r.waveAmp; d.shape.waveU = r.waveU; d.shape.waveV = r.waveV;
+        d.shape.waveSpeed = r.waveSpeed;
+        d.rows = r.rows < 2 ? 2 : r.rows; d.cols = r.cols < 3 ? 3 : r.cols;
+        d.time = r.time;
+        out.designs.push_back(d);
+    }
+    return true;
+}
+
+bool readGallerySector(const GalleryWorld& w, int x, int z, GallerySector& out) {
+    std::string path = sectorPath(w, x, z);
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        fprintf(stderr, "can't open %s\n", path.c_str());
+        return false;
+    }
+    SectorHeader h;
+    bool ok = readAll(f, &h, 1) && h.magic == kGallerySectorMagic && h.version == kGalleryVersion && h.x == x && h.z == z
+           && h.instanceCount <= kMaxRecords && h.lightCount <= kMaxRecords;
+    std::vector<InstanceRecord> instances(ok ? h.instanceCount : 0);
+    std::vector<LightRecord> lights(ok ? h.lightCount : 0);
+    ok = ok && readAll(f, instances.data(), instances.size()) && readAll(f, lights.data(), lights.size());
+    fclose(f);
+    for (const InstanceRecord& r : instances) ok = ok && r.design < w.designs.size();
+    if (!ok) {
+        fprintf(stderr, "%s is not a version %u sector %d,%d\n", path.c_str(), kGalleryVersion, x, z);
+        return false;
+    }
+    out = GallerySector();
+    out.x = x; out.z = z;
+    for (const InstanceRecord& r : instances) {
+        GalleryInstance in;
+        in.design = r.design;
+        in.position = glm::vec3(r.position[0], r.position[1], r.position[2]);
+        in.yaw = r.yaw; in.scale = r.scale;
+        out.instances.push_back(in);
+    }
+    for (const LightRecord& r : lights) {
+        PointLight L;
+        L.position = glm::vec3(r.position[0], r.position[1], r.position[2]);
+        L.ambient = glm::vec3(0.0f);
+        L.diffuse = L.specular = glm::vec3(r.color[0], r.color[1], r.color[2]);
+        L.linear = r.linear; L.quadratic = r.quadratic;
+        out.lights.push_back(L);
+    }
+    return true;
+}
+
+bool writeGalleryWorld(const GalleryWorld& w) {
+    std::string path = w.dir + "/world.bin";
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    WorldHeader h;
+    h.sectorSize = w.sectorSize;
+    h.sectorsX = w.sectorsX; h.sectorsZ = w.sectorsZ;
+    h.designCount = (uint32_t)w.designs.size();
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    for (const GalleryDesign& d : w.designs) {
+        const SculptureShape& s = d.shape;
+        DesignRecord r = { s.a, s.b, s.n, (uint32_t)s.profile, s.twist, s.waveAmp, s.waveU, s.waveV, s.waveSpeed,
+                           d.rows, d.cols, d.time };
+        ok = ok && fwrite(&r, sizeof(r), 1, f) == 1;
+    }
+    return fclose(f) == 0 && ok;
+}
+
+bool writeGallerySector(const GalleryWorld& w, const GallerySector& s) {
+    FILE* f = fopen(sectorPath(w, s.x, s.z).c_str(), "wb");
+    if (!f) return false;
+    SectorHeader h;
+    h.x = s.x; h.z = s.z;
+    h.instanceCount = (uint32_t)s.instances.size();
+    h.lightCount = (uint32_t)s.lights.size();
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    for (const GalleryInstance& in : s.instances) {
+        InstanceRecord r = { in.design, { in.position.x, in.position.y, in.position.z }, in.yaw, in.scale };
+        ok = ok && fwrite(&r, sizeof(r), 1, f) == 1;
+    }
+    for (const PointLight& L : s.lights) {
+        LightRecord r = { { L.position.x, L.position.y, L.position.z }, { L.diffuse.x, L.diffuse.y, L.diffuse.z },
+                          L.linear, L.quadratic };
+        ok = ok && fwrite(&r, sizeof(r), 1, f) == 1;
+    }
+    return fclose(f) == 0 && ok;
+}
+
+bool makeGalleryWorld(const std::string& dir, int sectors, uint32_t seed) {
+    mkdir(dir.c_str(), 0755);       // an existing directory is fine; fopen reports anything else
+    std::mt19937 rng(seed);
+    auto uniform = [&](float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(rng); };
+
+    GalleryWorld w;
+    w.dir = dir;
+    w.sectorsX = w.sectorsZ = sectors < 1 ? 1 : sectors;
+    // a palette of designs at a few resolutions, so meshes and index buffers are shared widely
+    const int kDesigns = 24;
+    const int res[3][2] = { { 32, 48 }, { 48, 64 }, { 64, 96 } };
+    for (int i = 0; i < kDesigns; ++i) {
+        GalleryDesign d;
+        d.shape.a = uniform(0.6f, 1.2f); d.shape.b = uniform(0.35f, 1.0f); d.shape.n = uniform(1.2f, 6.0f);
+        d.shape.profile = (Profile)(rng() % 4);
+        d.shape.twist = rng() % 3 == 0 ? uniform(0.0f, glm::pi<float>()) : 0.0f;
+        d.shape.waveAmp = uniform(0.05f, 0.3f); d.shape.waveU = (float)(2 + rng() % 8); d.shape.waveV = (float)(1 + rng() % 6);
+        d.rows = res[i % 3][0]; d.cols = res[i % 3][1];
+        d.time = uniform(0.0f, 10.0f);
+        w.designs.push_back(d);
+    }
+    if (!writeGalleryWorld(w)) {
+        fprintf(stderr, "can't write %s/world.bin\n", dir.c_str());
+        return false;
+    }
+
+    // per sector: plinths on a jittered 4 x 4 grid, about a quarter left empty, and three coloured lights
+    const int kPlinths = 4, kLights = 3;
+    for (int z = 0; z < w.sectorsZ; ++z) {
+        for (int x = 0; x < w.sectorsX; ++x) {
+            GallerySector s;
+            s.x = x; s.z = z;
+            float cell = w.sectorSize / kPlinths;
+            for (int j = 0; j < kPlinths; ++j) {
+                for (int i = 0; i < kPlinths; ++i) {
+                    if (rng() % 4 == 0) continue;
+                    GalleryInstance in;
+                    in.design = rng() % kDesigns;
+                    in.scale = uniform(0.6f, 1.4f);
+                    in.yaw = uniform(0.0f, glm::two_pi<float>());
+                    in.position = glm::vec3((x * kPlinths + i + 0.5f + uniform(-0.15f, 0.15f)) * cell, 1.5f * in.scale,
+                                            (z * kPlinths + j + 0.5f + uniform(-0.15f, 0.15f)) * cell);
+                    s.instances.push_back(in);
+                }
+            }
+            for (int k = 0; k < kLights; ++k) {
+                PointLight L;
+                float hue = uniform(0.0f, glm::two_pi<float>());
+                glm::vec3 tint(0.6f + 0.4f * cos(hue), 0.6f + 0.4f * cos(hue - 2.094f), 0.6f + 0.4f * cos(hue + 2.094f));
+                L.position = glm::vec3((x + uniform(0.1f, 0.9f)) * w.sectorSize, uniform(3.5f, 5.5f),
+                                       (z + uniform(0.1f, 0.9f)) * w.sectorSize);
+                L.diffuse = L.specular = tint * 1.5f;
+                L.linear = 0.09f; L.quadratic = 0.032f;    // reaches about 50 units
+                s.lights.push_back(L);
+            }
+            if (!writeGallerySector(w, s)) {
+                fprintf(stderr, "can't write %s\n", sectorPath(w, x, z).c_str());
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+// === gallery world: sculptures and lights partitioned into square sectors on disk ===
+// A directory holds world.bin (the sector grid plus a palette of sculpture designs) and one
+// sector_X_Z.bin per sector (instances that name a design, with their placement, and the sector's
+// lights). A design is everything makeSculpture-style generation needs, so every instance of it shares
+// one mesh however many sectors it appears in. All values are little-endian and fixed-size.
+// No GL here: gallery_stream.h does the loading, generation and residency.
+#include "lights.h"
+#include "sculpture_geometry.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+const uint32_t kGalleryWorldMagic = 0x444c5747;     // "GWLD"
+const uint32_t kGallerySectorMagic = 0x43455347;    // "GSEC"
+const uint32_t kGalleryVersion = 1;
+
+struct GalleryDesign {
+    SculptureShape shape;
+    int rows = 48, cols = 64;
+    float time = 0.0f;                  // the pose it is generated at
+};
+
+struct GalleryWorld {
+    std::string dir;
+    float sectorSize = 24.0f;           // world units per sector side; sector (0, 0) starts at the origin
+    int sectorsX = 0, sectorsZ = 0;
+    std::vector<GalleryDesign> designs;
+};
+
+struct GalleryInstance {
+    uint32_t design = 0;
+    glm::vec3 position = glm::vec3(0.0f);
+    float yaw = 0.0f, scale = 1.0f;
+};
+
+struct GallerySector {
+    int x = 0, z = 0;
+    std::vector<GalleryInstance> instances;
+    std::vector<PointLight> lights;     // diffuse and specular are the stored colour, no ambient (the sun gives it)
+};
+
+// world space bounds of a sector, padded up by the tallest sculpture
+glm::vec3 sectorMin(const GalleryWorld& w, int x, int z);
+glm::vec3 sectorMax(const GalleryWorld& w, int x, int z);
+std::string sectorPath(const GalleryWorld& w, int x, int z);
+
+// false when there is no world.bin yet (silently, so the caller can generate one) and, with a message on
+// stderr, when it is truncated or of another version
+bool readGalleryWorld(const std::string& dir, GalleryWorld& out);
+// false with a message on stderr when the sector is missing, truncated or of another version
+bool readGallerySector(const GalleryWorld& w, int x, int z, GallerySector& out);
+bool writeGalleryWorld(const GalleryWorld& w);
+bool writeGallerySector(const GalleryWorld& w, const GallerySector& s);
+
+// a procedural gallery of sectors x sectors: a palette of designs, a few plinths and lights per sector;
+// creates the directory if needed
+bool makeGalleryWorld(const std::string& dir, int sectors, uint32_t seed = 1);
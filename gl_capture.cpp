@@ -0,0 +1,392 @@
+#include "gl_capture.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// every entry point the renderer calls that changes GL state; decltype keeps glad's exact types
+#define GL_CAPTURE_HOOKS(X) \
+    X(ActiveTexture) X(AttachShader) X(BeginQuery) X(BindBuffer) X(BindBufferBase) X(BindBufferRange) \
+    X(BindFramebuffer) X(BindRenderbuffer) X(BindTexture) X(BindVertexArray) X(BlendFunc) X(BufferData) \
+    X(BufferSubData) X(Clear) X(ClearColor) X(ClientWaitSync) X(CompileShader) X(CopyBufferSubData) \
+    X(CreateProgram) X(CreateShader) X(DeleteBuffers) X(DeleteFramebuffers) X(DeleteProgram) X(DeleteQueries) \
+    X(DeleteRenderbuffers) X(DeleteShader) X(DeleteSync) X(DeleteTextures) X(DeleteVertexArrays) \
+    X(DetachShader) X(Disable) X(DrawArrays) X(DrawArraysInstanced) X(DrawElements) X(DrawElementsBaseVertex) \
+    X(DrawElementsInstanced) X(Enable) X(EnableVertexAttribArray) X(EndQuery) X(FenceSync) X(Finish) \
+    X(FramebufferRenderbuffer) X(FramebufferTexture2D) X(GenBuffers) X(GenFramebuffers) X(GenQueries) \
+    X(GenRenderbuffers) X(GenTextures) X(GenVertexArrays) X(GetUniformBlockIndex) X(GetUniformLocation) \
+    X(LinkProgram) X(MapBufferRange) X(MultiDrawElementsBaseVertex) X(PixelStorei) X(QueryCounter) \
+    X(ReadPixels) X(RenderbufferStorage) X(ShaderSource) X(TexBuffer) X(TexImage2D) X(TexParameteri) \
+    X(TexSubImage2D) X(Uniform1f) X(Uniform1i) X(Uniform2f) X(Uniform3f) X(Uniform3fv) X(Uniform4fv) \
+    X(UniformBlockBinding) X(UniformMatrix4fv) X(UnmapBuffer) X(UseProgram) X(VertexAttribDivisor) \
+    X(VertexAttribPointer) X(Viewport)
+
+namespace {
+
+#define DECLARE_REAL(name) decltype(glad_gl##name) r_##name = nullptr;
+GL_CAPTURE_HOOKS(DECLARE_REAL)
+#undef DECLARE_REAL
+
+struct Mapping {
+    GLenum target;
+    void* ptr;
+    GLsizeiptr length;
+    GLbitfield access;
+};
+
+struct Capture {
+    FILE* file = nullptr;
+    std::string path;
+    std::vector<unsigned char> buf;     // flushed to the file in ~1 MB pieces
+    uint64_t written = 0, calls = 0;
+    int frames = 0, frameLimit = 0;
+    std::chrono::steady_clock::time_point start;
+    std::unordered_map<std::string, uint32_t> strings;
+    std::unordered_map<GLsync, uint32_t> syncs;
+    uint32_t nextSync = 1;
+    GLint unpackAlignment = 4, unpackRowLength = 0;
+    std::vector<Mapping> maps;
+};
+Capture* g_capture = nullptr;
+
+void flush(Capture& c) {
+    if (c.buf.empty()) return;
+    fwrite(c.buf.data(), 1, c.buf.size(), c.file);
+    c.written += c.buf.size();
+    c.buf.clear();
+}
+
+template <class T>
+void put(T v) {
+    static_assert(std::is_arithmetic<T>::value, "fixed-size values only");
+    size_t at = g_capture->buf.size();
+    g_capture->buf.resize(at + sizeof(T));
+    memcpy(&g_capture->buf[at], &v, sizeof(T));
+}
+void put(GlOp op) { put((uint8_t)op); }
+void putPayload(const void* p, size_t bytes) {
+    put((uint32_t)bytes);
+    if (!bytes) return;
+    const unsigned char* b = (const unsigned char*)p;
+    g_capture->buf.insert(g_capture->buf.end(), b, b + bytes);
+}
+
+// sizes and offsets are 8 bytes on every platform
+int64_t wide(GLsizeiptr v) { return (int64_t)v; }
+int64_t offsetOf(const void* p) { return (int64_t)(intptr_t)p; }
+
+template <class... T>
+void rec(GlOp op, T... v) {
+    ++g_capture->calls;
+    put(op);
+    (put(v), ...);
+    if (g_capture->buf.size() >= (1u << 20)) flush(*g_capture);
+}
+
+uint32_t stringId(const char* s) {
+    auto it = g_capture->strings.find(s);
+    if (it != g_capture->strings.end()) return it->second;
+    uint32_t id = (uint32_t)g_capture->strings.size();
+    g_capture->strings.emplace(s, id);
+    put(GlOp::String); put(id); putPayload(s, strlen(s));
+    return id;
+}
+
+uint32_t syncId(GLsync s) {
+    auto it = g_capture->syncs.find(s);
+    return it == g_capture->syncs.end() ? 0 : it->second;
+}
+
+void recNames(GlOp op, GLsizei n, const GLuint* names) {
+    rec(op, n);
+    for (GLsizei i = 0; i < n; ++i) put(names[i]);
+}
+
+// === wrappers: record, then call the driver (or the other way round when the result is recorded) ===
+
+void APIENTRY c_ActiveTexture(GLenum texture) { rec(GlOp::ActiveTexture, texture); r_ActiveTexture(texture); }
+void APIENTRY c_AttachShader(GLuint program, GLuint shader) { rec(GlOp::AttachShader, program, shader); r_AttachShader(program, shader); }
+void APIENTRY c_BeginQuery(GLenum target, GLuint id) { rec(GlOp::BeginQuery, target, id); r_BeginQuery(target, id); }
+void APIENTRY c_BindBuffer(GLenum target, GLuint buffer) { rec(GlOp::BindBuffer, target, buffer); r_BindBuffer(target, buffer); }
+void APIENTRY c_BindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    rec(GlOp::BindBufferBase, target, index, buffer);
+    r_BindBufferBase(target, index, buffer);
+}
+void APIENTRY c_BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    rec(GlOp::BindBufferRange, target, index, buffer, wide(offset), wide(size));
+    r_BindBufferRange(target, index, buffer, offset, size);
+}
+void APIENTRY c_BindFramebuffer(GLenum target, GLuint fb) { rec(GlOp::BindFramebuffer, target, fb); r_BindFramebuffer(target, fb); }
+void APIENTRY c_BindRenderbuffer(GLenum target, GLuint rb) { rec(GlOp::BindRenderbuffer, target, rb); r_BindRenderbuffer(target, rb); }
+void APIENTRY c_BindTexture(GLenum target, GLuint texture) { rec(GlOp::BindTexture, target, texture); r_BindTexture(target, texture); }
+void APIENTRY c_BindVertexArray(GLuint array) { rec(GlOp::BindVertexArray, array); r_BindVertexArray(array); }
+void APIENTRY c_BlendFunc(GLenum s, GLenum d) { rec(GlOp::BlendFunc, s, d); r_BlendFunc(s, d); }
+void APIENTRY c_BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    // a null upload is a zero-length payload
+    rec(GlOp::BufferData, target, wide(size), usage);
+    putPayload(data, data ? (size_t)size : 0);
+    r_BufferData(target, size, data, usage);
+}
+void APIENTRY c_BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    rec(GlOp::BufferSubData, target, wide(offset));
+    putPayload(data, (size_t)size);
+    r_BufferSubData(target, offset, size, data);
+}
+void APIENTRY c_Clear(GLbitfield mask) { rec(GlOp::Clear, mask); r_Clear(mask); }
+void APIENTRY c_ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) { rec(GlOp::ClearColor, r, g, b, a); r_ClearColor(r, g, b, a); }
+GLenum APIENTRY c_ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
+    rec(GlOp::ClientWaitSync, syncId(sync), flags, (uint64_t)timeout);
+    return r_ClientWaitSync(sync, flags, timeout);
+}
+void APIENTRY c_CompileShader(GLuint shader) { rec(GlOp::CompileShader, shader); r_CompileShader(shader); }
+void APIENTRY c_CopyBufferSubData(GLenum rt, GLenum wt, GLintptr ro, GLintptr wo, GLsizeiptr size) {
+    rec(GlOp::CopyBufferSubData, rt, wt, wide(ro), wide(wo), wide(size));
+    r_CopyBufferSubData(rt, wt, ro, wo, size);
+}
+GLuint APIENTRY c_CreateProgram() { GLuint p = r_CreateProgram(); rec(GlOp::CreateProgram, p); return p; }
+GLuint APIENTRY c_CreateShader(GLenum type) { GLuint s = r_CreateShader(type); rec(GlOp::CreateShader, type, s); return s; }
+void APIENTRY c_DeleteBuffers(GLsizei n, const GLuint* names) { recNames(GlOp::DeleteBuffers, n, names); r_DeleteBuffers(n, names); }
+void APIENTRY c_DeleteFramebuffers(GLsizei n, const GLuint* names) {
+    recNames(GlOp::DeleteFramebuffers, n, names);
+    r_DeleteFramebuffers(n, names);
+}
+void APIENTRY c_DeleteProgram(GLuint program) { rec(GlOp::DeleteProgram, program); r_DeleteProgram(program); }
+void APIENTRY c_DeleteQueries(GLsizei n, const GLuint* names) { recNames(GlOp::DeleteQueries, n, names); r_DeleteQueries(n, names); }
+void APIENTRY c_DeleteRenderbuffers(GLsizei n, const GLuint* names) {
+    recNames(GlOp::DeleteRenderbuffers, n, names);
+    r_DeleteRenderbuffers(n, names);
+}
+void APIENTRY c_DeleteShader(GLuint shader) { rec(GlOp::DeleteShader, shader); r_DeleteShader(shader); }
+void APIENTRY c_DeleteSync(GLsync sync) {
+    rec(GlOp::DeleteSync, syncId(sync));
+    g_capture->syncs.erase(sync);
+    r_DeleteSync(sync);
+}
+void APIENTRY c_DeleteTextures(GLsizei n, const GLuint* names) { recNames(GlOp::DeleteTextures, n, names); r_DeleteTextures(n, names); }
+void APIENTRY c_DeleteVertexArrays(GLsizei n, const GLuint* names) {
+    recNames(GlOp::DeleteVertexArrays, n, names);
+    r_DeleteVertexArrays(n, names);
+}
+void APIENTRY c_DetachShader(GLuint program, GLuint shader) { rec(GlOp::DetachShader, program, shader); r_DetachShader(program, shader); }
+void APIENTRY c_Disable(GLenum cap) { rec(GlOp::Disable, cap); r_Disable(cap); }
+void APIENTRY c_DrawArrays(GLenum mode, GLint first, GLsizei count) { rec(GlOp::DrawArrays, mode, first, count); r_DrawArrays(mode, first, count); }
+void APIENTRY c_DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) {
+    rec(GlOp::DrawArraysInstanced, mode, first, count, instances);
+    r_DrawArraysInstanced(mode, first, count, instances);
+}
+void APIENTRY c_DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+    rec(GlOp::DrawElements, mode, count, type, offsetOf(indices));
+    r_DrawElements(mode, count, type, indices);
+}
+void APIENTRY c_DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint base) {
+    rec(GlOp::DrawElementsBaseVertex, mode, count, type, offsetOf(indices), base);
+    r_DrawElementsBaseVertex(mode, count, type, indices, base);
+}
+void APIENTRY c_DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances) {
+    rec(GlOp::DrawElementsInstanced, mode, count, type, offsetOf(indices), instances);
+    r_DrawElementsInstanced(mode, count, type, indices, instances);
+}
+void APIENTRY c_Enable(GLenum cap) { rec(GlOp::Enable, cap); r_Enable(cap); }
+void APIENTRY c_EnableVertexAttribArray(GLuint index) { rec(GlOp::EnableVertexAttribArray, index); r_EnableVertexAttribArray(index); }
+void APIENTRY c_EndQuery(GLenum target) { rec(GlOp::EndQuery, target); r_EndQuery(target); }
+GLsync APIENTRY c_FenceSync(GLenum condition, GLbitfield flags) {
+    GLsync s = r_FenceSync(condition, flags);
+    uint32_t id = g_capture->nextSync++;
+    g_capture->syncs[s] = id;
+    rec(GlOp::FenceSync, condition, flags, id);
+    return s;
+}
+void APIENTRY c_Finish() { rec(GlOp::Finish); r_Finish(); }
+void APIENTRY c_FramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum rbTarget, GLuint rb) {
+    rec(GlOp::FramebufferRenderbuffer, target, attachment, rbTarget, rb);
+    r_FramebufferRenderbuffer(target, attachment, rbTarget, rb);
+}
+void APIENTRY c_FramebufferTexture2D(GLenum target, GLenum attachment, GLenum texTarget, GLuint texture, GLint level) {
+    rec(GlOp::FramebufferTexture2D, target, attachment, texTarget, texture, level);
+    r_FramebufferTexture2D(target, attachment, texTarget, texture, level);
+}
+void APIENTRY c_GenBuffers(GLsizei n, GLuint* names) { r_GenBuffers(n, names); recNames(GlOp::GenBuffers, n, names); }
+void APIENTRY c_GenFramebuffers(GLsizei n, GLuint* names) { r_GenFramebuffers(n, names); recNames(GlOp::GenFramebuffers, n, names); }
+void APIENTRY c_GenQueries(GLsizei n, GLuint* names) { r_GenQueries(n, names); recNames(GlOp::GenQueries, n, names); }
+void APIENTRY c_GenRenderbuffers(GLsizei n, GLuint* names) { r_GenRenderbuffers(n, names); recNames(GlOp::GenRenderbuffers, n, names); }
+void APIENTRY c_GenTextures(GLsizei n, GLuint* names) { r_GenTextures(n, names); recNames(GlOp::GenTextures, n, names); }
+void APIENTRY c_GenVertexArrays(GLsizei n, GLuint* names) { r_GenVertexArrays(n, names); recNames(GlOp::GenVertexArrays, n, names); }
+GLuint APIENTRY c_GetUniformBlockIndex(GLuint program, const GLchar* name) {
+    GLuint index = r_GetUniformBlockIndex(program, name);
+    uint32_t id = stringId(name);
+    rec(GlOp::GetUniformBlockIndex, program, id, index);
+    return index;
+}
+GLint APIENTRY c_GetUniformLocation(GLuint program, const GLchar* name) {
+    GLint loc = r_GetUniformLocation(program, name);
+    uint32_t id = stringId(name);
+    rec(GlOp::GetUniformLocation, program, id, loc);
+    return loc;
+}
+void APIENTRY c_LinkProgram(GLuint program) { rec(GlOp::LinkProgram, program); r_LinkProgram(program); }
+void* APIENTRY c_MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    void* p = r_MapBufferRange(target, offset, length, access);
+    rec(GlOp::MapBufferRange, target, wide(offset), wide(length), access);
+    if (p) g_capture->maps.push_back({ target, p, length, access });
+    return p;
+}
+void APIENTRY c_MultiDrawElementsBaseVertex(GLenum mode, const GLsizei* count, GLenum type, const void* const* indices,
+                                            GLsizei drawcount, const GLint* base) {
+    rec(GlOp::MultiDrawElementsBaseVertex, mode, type, drawcount);
+    for (GLsizei i = 0; i < drawcount; ++i) { put(count[i]); put(offsetOf(indices[i])); put(base[i]); }
+    r_MultiDrawElementsBaseVertex(mode, count, type, indices, drawcount, base);
+}
+void APIENTRY c_PixelStorei(GLenum pname, GLint param) {
+    if (pname == GL_UNPACK_ALIGNMENT) g_capture->unpackAlignment = param;
+    if (pname == GL_UNPACK_ROW_LENGTH) g_capture->unpackRowLength = param;
+    rec(GlOp::PixelStorei, pname, param);
+    r_PixelStorei(pname, param);
+}
+void APIENTRY c_QueryCounter(GLuint id, GLenum target) { rec(GlOp::QueryCounter, id, target); r_QueryCounter(id, target); }
+void APIENTRY c_ReadPixels(GLint x, GLint y, GLsizei w, GLsizei h, GLenum format, GLenum type, void* pixels) {
+    rec(GlOp::ReadPixels, x, y, w, h, format, type);
+    r_ReadPixels(x, y, w, h, format, type, pixels);
+}
+void APIENTRY c_RenderbufferStorage(GLenum target, GLenum format, GLsizei w, GLsizei h) {
+    rec(GlOp::RenderbufferStorage, target, format, w, h);
+    r_RenderbufferStorage(target, format, w, h);
+}
+void APIENTRY c_ShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths) {
+    // joined into one string; the compiler sees the same text
+    std::string src;
+    for (GLsizei i = 0; i < count; ++i) {
+        if (lengths && lengths[i] >= 0) src.append(strings[i], (size_t)lengths[i]);
+        else src += strings[i];
+    }
+    rec(GlOp::ShaderSource, shader);
+    putPayload(src.data(), src.size());
+    r_ShaderSource(shader, count, strings, lengths);
+}
+void APIENTRY c_TexBuffer(GLenum target, GLenum format, GLuint buffer) { rec(GlOp::TexBuffer, target, format, buffer); r_TexBuffer(target, format, buffer); }
+void APIENTRY c_TexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei w, GLsizei h, GLint border, GLenum format,
+                           GLenum type, const void* pixels) {
+    rec(GlOp::TexImage2D, target, level, internalFormat, w, h, border, format, type);
+    putPayload(pixels, pixels ? glImageBytes(w, h, format, type, g_capture->unpackAlignment, g_capture->unpackRowLength) : 0);
+    r_TexImage2D(target, level, internalFormat, w, h, border, format, type, pixels);
+}
+void APIENTRY c_TexParameteri(GLenum target, GLenum pname, GLint param) { rec(GlOp::TexParameteri, target, pname, param); r_TexParameteri(target, pname, param); }
+void APIENTRY c_TexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei w, GLsizei h, GLenum format, GLenum type,
+                              const void* pixels) {
+    rec(GlOp::TexSubImage2D, target, level, x, y, w, h, format, type);
+    putPayload(pixels, glImageBytes(w, h, format, type, g_capture->unpackAlignment, g_capture->unpackRowLength));
+    r_TexSubImage2D(target, level, x, y, w, h, format, type, pixels);
+}
+void APIENTRY c_Uniform1f(GLint loc, GLfloat x) { rec(GlOp::Uniform1f, loc, x); r_Uniform1f(loc, x); }
+void APIENTRY c_Uniform1i(GLint loc, GLint x) { rec(GlOp::Uniform1i, loc, x); r_Uniform1i(loc, x); }
+void APIENTRY c_Uniform2f(GLint loc, GLfloat x, GLfloat y) { rec(GlOp::Uniform2f, loc, x, y); r_Uniform2f(loc, x, y); }
+void APIENTRY c_Uniform3f(GLint loc, GLfloat x, GLfloat y, GLfloat z) { rec(GlOp::Uniform3f, loc, x, y, z); r_Uniform3f(loc, x, y, z); }
+void APIENTRY c_Uniform3fv(GLint loc, GLsizei count, const GLfloat* v) {
+    rec(GlOp::Uniform3fv, loc);
+    putPayload(v, (size_t)count * 3 * sizeof(float));
+    r_Uniform3fv(loc, count, v);
+}
+void APIENTRY c_Uniform4fv(GLint loc, GLsizei count, const GLfloat* v) {
+    rec(GlOp::Uniform4fv, loc);
+    putPayload(v, (size_t)count * 4 * sizeof(float));
+    r_Uniform4fv(loc, count, v);
+}
+void APIENTRY c_UniformBlockBinding(GLuint program, GLuint index, GLuint binding) {
+    rec(GlOp::UniformBlockBinding, program, index, binding);
+    r_UniformBlockBinding(program, index, binding);
+}
+void APIENTRY c_UniformMatrix4fv(GLint loc, GLsizei count, GLboolean transpose, const GLfloat* v) {
+    rec(GlOp::UniformMatrix4fv, loc, transpose);
+    putPayload(v, (size_t)count * 16 * sizeof(float));
+    r_UniformMatrix4fv(loc, count, transpose, v);
+}
+GLboolean APIENTRY c_UnmapBuffer(GLenum target) {
+    // whatever the app wrote through the pointer; read back before the driver takes the range away
+    std::vector<Mapping>& maps = g_capture->maps;
+    size_t i = 0;
+    while (i < maps.size() && maps[i].target != target) ++i;
+    rec(GlOp::UnmapBuffer, target);
+    if (i < maps.size()) {
+        putPayload(maps[i].ptr, (maps[i].access & GL_MAP_WRITE_BIT) ? (size_t)maps[i].length : 0);
+        maps.erase(maps.begin() + i);
+    } else {
+        putPayload(nullptr, 0);
+    }
+    return r_UnmapBuffer(target);
+}
+void APIENTRY c_UseProgram(GLuint program) { rec(GlOp::UseProgram, program); r_UseProgram(program); }
+void APIENTRY c_VertexAttribDivisor(GLuint index, GLuint divisor) { rec(GlOp::VertexAttribDivisor, index, divisor); r_VertexAttribDivisor(index, divisor); }
+void APIENTRY c_VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* p) {
+    rec(GlOp::VertexAttribPointer, index, size, type, normalized, stride, offsetOf(p));
+    r_VertexAttribPointer(index, size, type, normalized, stride, p);
+}
+void APIENTRY c_Viewport(GLint x, GLint y, GLsizei w, GLsizei h) { rec(GlOp::Viewport, x, y, w, h); r_Viewport(x, y, w, h); }
+
+} // namespace
+
+size_t glImageBytes(int width, int height, GLenum format, GLenum type, int alignment, int rowLength) {
+    if (width <= 0 || height <= 0) return 0;
+    size_t comps = format == GL_RG || format == GL_RG_INTEGER ? 2
+                 : format == GL_RGB || format == GL_BGR || format == GL_RGB_INTEGER ? 3
+                 : format == GL_RGBA || format == GL_BGRA || format == GL_RGBA_INTEGER ? 4 : 1;
+    size_t size = type == GL_UNSIGNED_BYTE || type == GL_BYTE ? 1
+                : type == GL_HALF_FLOAT || type == GL_UNSIGNED_SHORT || type == GL_SHORT ? 2 : 4;
+    size_t pixel = comps * size;
+    size_t row = (size_t)(rowLength > 0 ? rowLength : width) * pixel;
+    size_t a = alignment > 0 ? (size_t)alignment : 1;
+    if (size < a) row = (row + a - 1) / a * a;   // alignment doesn't apply when the type is wider
+    return row * (size_t)(height - 1) + (size_t)width * pixel;
+}
+
+bool startGlCapture(const std::string& path, int width, int height, int frames) {
+    if (g_capture) return false;
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) { std::cerr << "can't write capture " << path << "\n"; return false; }
+    GlCaptureHeader h;
+    h.width = width; h.height = height;
+    fwrite(&h, sizeof(h), 1, f);
+
+    g_capture = new Capture();
+    g_capture->file = f;
+    g_capture->path = path;
+    g_capture->written = sizeof(h);
+    g_capture->frameLimit = frames;
+    g_capture->start = std::chrono::steady_clock::now();
+    // the default unpack state; the app may have changed it before capturing
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &g_capture->unpackAlignment);
+    glGetIntegerv(GL_UNPACK_ROW_LENGTH, &g_capture->unpackRowLength);
+#define HOOK(name) r_##name = glad_gl##name; if (r_##name) glad_gl##name = c_##name;
+    GL_CAPTURE_HOOKS(HOOK)
+#undef HOOK
+    return true;
+}
+
+void glCaptureFrame() {
+    if (!g_capture) return;
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - g_capture->start).count();
+    put(GlOp::Frame); put(ms);
+    if (++g_capture->frames == g_capture->frameLimit) stopGlCapture();
+}
+
+bool glCaptureActive() { return g_capture != nullptr; }
+
+void stopGlCapture() {
+    if (!g_capture) return;
+#define UNHOOK(name) if (r_##name) glad_gl##name = r_##name;
+    GL_CAPTURE_HOOKS(UNHOOK)
+#undef UNHOOK
+    Capture& c = *g_capture;
+    flush(c);
+    bool ok = fclose(c.file) == 0;
+    if (ok) {
+        std::cout << "capture: " << c.frames << " frames, " << c.calls << " calls, " << c.written / (1024.0 * 1024.0)
+                  << " MB -> " << c.path << "\n";
+    } else {
+        std::cerr << "can't write capture " << c.path << "\n";
+    }
+    delete g_capture;
+    g_capture = nullptr;
+}
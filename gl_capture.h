@@ -0,0 +1,55 @@
+#pragma once
+// === GL command stream capture ===
+// Swaps glad's function pointers for wrappers that append each call, with the data it reads (buffer
+// and texture uploads, uniform values, shader sources, mapped ranges at unmap), to a binary stream and
+// then call the driver. bench/gl_replay.cpp re-issues the stream in a context of its own.
+//
+// Stream: the header below, then records of one GlOp byte followed by the call's arguments as
+// little-endian fixed-size values (enums/ints 4 bytes, sizes and offsets 8). Payloads are a u32 byte
+// count and the bytes. Object names, uniform locations, block indices and syncs are the capturing
+// process's values; the replayer maps them to its own from the Gen/Create/Get records.
+// Queries that only read state (glGetIntegerv, info logs, query results) are not recorded.
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+
+const uint32_t kGlCaptureMagic = 0x434c474b;    // "KGLC"
+const uint32_t kGlCaptureVersion = 1;
+
+struct GlCaptureHeader {
+    uint32_t magic = kGlCaptureMagic;
+    uint32_t version = kGlCaptureVersion;
+    int32_t width = 0, height = 0;               // default framebuffer at capture start
+};
+
+enum class GlOp : uint8_t {
+    Frame = 1,          // f64 ms since capture start; the app swapped here
+    String,             // u32 id, payload: bytes; later records refer to the id
+    ActiveTexture, AttachShader, BeginQuery, BindBuffer, BindBufferBase, BindBufferRange, BindFramebuffer,
+    BindRenderbuffer, BindTexture, BindVertexArray, BlendFunc, BufferData, BufferSubData, Clear, ClearColor,
+    ClientWaitSync, CompileShader, CopyBufferSubData, CreateProgram, CreateShader, DeleteBuffers,
+    DeleteFramebuffers, DeleteProgram, DeleteQueries, DeleteRenderbuffers, DeleteShader, DeleteSync,
+    DeleteTextures, DeleteVertexArrays, DetachShader, Disable, DrawArrays, DrawArraysInstanced, DrawElements,
+    DrawElementsBaseVertex, DrawElementsInstanced, Enable, EnableVertexAttribArray, EndQuery, FenceSync,
+    Finish, FramebufferRenderbuffer, FramebufferTexture2D, GenBuffers, GenFramebuffers, GenQueries,
+    GenRenderbuffers, GenTextures, GenVertexArrays, GetUniformBlockIndex, GetUniformLocation, LinkProgram,
+    MapBufferRange, MultiDrawElementsBaseVertex, PixelStorei, QueryCounter, ReadPixels, RenderbufferStorage,
+    ShaderSource, TexBuffer, TexImage2D, TexParameteri, TexSubImage2D, Uniform1f, Uniform1i, Uniform2f,
+    Uniform3f, Uniform3fv, Uniform4fv, UniformBlockBinding, UniformMatrix4fv, UnmapBuffer, UseProgram,
+    VertexAttribDivisor, VertexAttribPointer, Viewport,
+    Count
+};
+
+// bytes glTexImage2D & co. read for a w x h image under the given unpack alignment / row length;
+// the unsized formats and plain types this renderer uses
+size_t glImageBytes(int width, int height, GLenum format, GLenum type, int alignment, int rowLength);
+
+// GL must be loaded; frames <= 0 records until stopGlCapture(). Resources created before this call
+// aren't in the stream, so start right after gladLoadGLLoader.
+bool startGlCapture(const std::string& path, int width, int height, int frames);
+// after every swap; ends the capture by itself once the frame count is reached
+void glCaptureFrame();
+bool glCaptureActive();
+// restores the driver's pointers, flushes and prints a one-line summary
+void stopGlCapture();
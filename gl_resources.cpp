@@ -0,0 +1,123 @@
+#include "gl_resources.h"
+
+namespace {
+
+int bucketOf(size_t bytes) {
+    int k = 0;
+    while (k < kBufferPoolBuckets && ((size_t)1 << (k + kBufferPoolMinShift)) < bytes) ++k;
+    return k;
+}
+size_t bucketBytes(int k) { return (size_t)1 << (k + kBufferPoolMinShift); }
+
+void deleteBuffer(GLuint name) {
+    untrackGpu(GpuObject::Buffer, name);
+    glDeleteBuffers(1, &name);
+}
+
+void giveBack(BufferPool& pool, GLuint name, size_t bytes) {
+    int k = bucketOf(bytes);
+    if (k == kBufferPoolBuckets || bucketBytes(k) != bytes || pool.stats.freeBytes + bytes > pool.maxFreeBytes) {
+        deleteBuffer(name);
+        return;
+    }
+    pool.free[k].push_back(name);
+    pool.stats.freeBytes += bytes;
+    trackGpu(GpuObject::Buffer, name, MemTag::BufferPool, bytes);
+}
+
+} // namespace
+
+void GlBufferTraits::destroy(GLuint name) { deleteBuffer(name); }
+void GlVertexArrayTraits::destroy(GLuint name) { glDeleteVertexArrays(1, &name); }
+void GlTextureTraits::destroy(GLuint name) {
+    untrackGpu(GpuObject::Texture, name);
+    glDeleteTextures(1, &name);
+}
+void GlFramebufferTraits::destroy(GLuint name) { glDeleteFramebuffers(1, &name); }
+void GlProgramTraits::destroy(GLuint name) {
+    untrackGpu(GpuObject::Program, name);
+    glDeleteProgram(name);
+}
+
+GlBuffer genBuffer() {
+    GLuint name = 0;
+    glGenBuffers(1, &name);
+    return GlBuffer(name);
+}
+
+GlVertexArray genVertexArray() {
+    GLuint name = 0;
+    glGenVertexArrays(1, &name);
+    return GlVertexArray(name);
+}
+
+GlTexture genTexture() {
+    GLuint name = 0;
+    glGenTextures(1, &name);
+    return GlTexture(name);
+}
+
+GlFramebuffer genFramebuffer() {
+    GLuint name = 0;
+    glGenFramebuffers(1, &name);
+    return GlFramebuffer(name);
+}
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& o) noexcept {
+    if (this != &o) {
+        reset();
+        pool = o.pool; name = o.name; bytes = o.bytes;
+        o.pool = nullptr; o.name = 0; o.bytes = 0;
+    }
+    return *this;
+}
+
+void PooledBuffer::reset() {
+    if (name) {
+        if (pool) giveBack(*pool, name, bytes);
+        else deleteBuffer(name);
+    }
+    pool = nullptr; name = 0; bytes = 0;
+}
+
+PooledBuffer acquireBuffer(BufferPool& pool, size_t bytes, MemTag tag, GLenum usage) {
+    PooledBuffer b;
+    int k = bucketOf(bytes);
+    size_t capacity = k < kBufferPoolBuckets ? bucketBytes(k) : bytes;
+    ++pool.stats.acquired;
+    if (k < kBufferPoolBuckets && !pool.free[k].empty()) {
+        b.name = pool.free[k].back();
+        pool.free[k].pop_back();
+        pool.stats.freeBytes -= capacity;
+        ++pool.stats.reused;
+    } else {
+        // idle storage goes before the budget is blown
+        if (!memoryFits(MemDomain::Gpu, capacity)) trimBufferPool(pool, 0);
+        glGenBuffers(1, &b.name);
+        // the copy target: binding an element buffer here would land in whatever VAO is bound
+        glBindBuffer(GL_COPY_WRITE_BUFFER, b.name);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity, nullptr, usage);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        ++pool.stats.created;
+    }
+    b.pool = k < kBufferPoolBuckets ? &pool : nullptr;
+    b.bytes = capacity;
+    trackGpu(GpuObject::Buffer, b.name, tag, capacity);
+    return b;
+}
+
+void trimBufferPool(BufferPool& pool, size_t keepBytes) {
+    // largest first: fewest deletes to get under
+    for (int k = kBufferPoolBuckets - 1; k >= 0 && pool.stats.freeBytes > keepBytes; --k) {
+        while (!pool.free[k].empty() && pool.stats.freeBytes > keepBytes) {
+            deleteBuffer(pool.free[k].back());
+            pool.free[k].pop_back();
+            pool.stats.freeBytes -= bucketBytes(k);
+            ++pool.stats.trimmed;
+        }
+    }
+}
+
+void destroyBufferPool(BufferPool& pool) {
+    trimBufferPool(pool, 0);
+}
@@ -0,0 +1,103 @@
+#pragma once
+// === owning GL handles and a pool of recycled buffers ===
+// GlBuffer, GlVertexArray, GlTexture, GlFramebuffer and GlProgram delete their object when they go out of
+// scope and can only be moved, so replacing a mesh frees the old one. BufferPool keeps released buffers by power-of-two
+// capacity. A rebuild at a size seen before (LOD or resolution changes) gets storage back without a
+// glGenBuffers + glBufferData allocation in the driver.
+// Handles must be gone before the context is: reset them (or let them leave scope) before glfwDestroyWindow.
+#include <glad/glad.h>
+
+#include "memory_registry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+template <class Traits>
+class GlHandle {
+public:
+    GlHandle() = default;
+    explicit GlHandle(GLuint n) : name(n) {}
+    GlHandle(GlHandle&& o) noexcept : name(o.release()) {}
+    GlHandle& operator=(GlHandle&& o) noexcept {
+        if (this != &o) reset(o.release());
+        return *this;
+    }
+    GlHandle(const GlHandle&) = delete;
+    GlHandle& operator=(const GlHandle&) = delete;
+    ~GlHandle() { reset(); }
+
+    operator GLuint() const { return name; }
+    GLuint get() const { return name; }
+    // gives up ownership without deleting
+    GLuint release() { GLuint n = name; name = 0; return n; }
+    void reset(GLuint n = 0) {
+        if (name) Traits::destroy(name);
+        name = n;
+    }
+
+private:
+    GLuint name = 0;
+};
+
+struct GlBufferTraits { static void destroy(GLuint name); };
+struct GlVertexArrayTraits { static void destroy(GLuint name); };
+struct GlTextureTraits { static void destroy(GLuint name); };
+struct GlFramebufferTraits { static void destroy(GLuint name); };
+struct GlProgramTraits { static void destroy(GLuint name); };
+using GlBuffer = GlHandle<GlBufferTraits>;      // untracks it from memory_registry.h too
+using GlVertexArray = GlHandle<GlVertexArrayTraits>;
+using GlTexture = GlHandle<GlTextureTraits>;    // untracks it from memory_registry.h too
+using GlFramebuffer = GlHandle<GlFramebufferTraits>;
+using GlProgram = GlHandle<GlProgramTraits>;     // untracks it from memory_registry.h too
+
+GlBuffer genBuffer();
+GlVertexArray genVertexArray();
+GlTexture genTexture();
+GlFramebuffer genFramebuffer();
+
+// === size-bucketed buffer pool ===
+const int kBufferPoolMinShift = 12;         // smallest bucket: 4 KB
+const int kBufferPoolBuckets = 28;          // up to 512 GB; larger requests aren't pooled
+
+struct BufferPoolStats {
+    uint64_t acquired = 0, reused = 0, created = 0, trimmed = 0;
+    size_t freeBytes = 0;
+};
+
+struct BufferPool {
+    std::vector<GLuint> free[kBufferPoolBuckets];
+    size_t maxFreeBytes = 64u << 20;        // beyond this, released buffers are deleted instead of kept
+    BufferPoolStats stats;
+};
+
+// a buffer from (and, on destruction, back to) a pool; move-only like the handles
+class PooledBuffer {
+public:
+    PooledBuffer() = default;
+    PooledBuffer(PooledBuffer&& o) noexcept { *this = static_cast<PooledBuffer&&>(o); }
+    PooledBuffer& operator=(PooledBuffer&& o) noexcept;
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+    ~PooledBuffer() { reset(); }
+
+    operator GLuint() const { return name; }
+    GLuint get() const { return name; }
+    size_t capacity() const { return bytes; }
+    // back to the pool now
+    void reset();
+
+private:
+    friend PooledBuffer acquireBuffer(BufferPool& pool, size_t bytes, MemTag tag, GLenum usage);
+    BufferPool* pool = nullptr;
+    GLuint name = 0;
+    size_t bytes = 0;
+};
+
+// storage for at least `bytes`, rounded up to the bucket (contents undefined; fill with glBufferSubData).
+// `usage` only matters when a new buffer has to be made. Binds nothing that a VAO remembers.
+PooledBuffer acquireBuffer(BufferPool& pool, size_t bytes, MemTag tag, GLenum usage = GL_STATIC_DRAW);
+// deletes free buffers until at most `keepBytes` are held
+void trimBufferPool(BufferPool& pool, size_t keepBytes);
+// every free buffer; outstanding PooledBuffers must be reset first
+void destroyBufferPool(BufferPool& pool);
@@ -0,0 +1,97 @@
+#include "grid_topology.h"
+
+#include "memory_registry.h"
+#include "sculpture_geometry.h"
+
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+struct TopologyRegistry {
+    // the registry's own reference; use_count() == 1 means only the cache holds it
+    std::map<std::tuple<int, int, int>, std::shared_ptr<GridTopology>> entries;
+    TopologyStats stats;
+};
+TopologyRegistry g_topologies;
+
+size_t idleBytes() {
+    size_t bytes = 0;
+    for (auto& e : g_topologies.entries)
+        if (e.second.use_count() == 1) bytes += e.second->bytes;
+    return bytes;
+}
+
+void erase(std::map<std::tuple<int, int, int>, std::shared_ptr<GridTopology>>::iterator it) {
+    g_topologies.stats.bytes -= it->second->bytes;
+    g_topologies.stats.live -= 1;
+    g_topologies.entries.erase(it);         // the GlBuffer goes with the last reference
+}
+
+} // namespace
+
+const char* indexLayoutName(IndexLayout l) {
+    return l == IndexLayout::Strip ? "strip" : l == IndexLayout::Patch ? "patch" : "triangles";
+}
+
+bool parseIndexLayout(const char* name, IndexLayout& out) {
+    if (!strcmp(name, "triangles")) out = IndexLayout::Triangles;
+    else if (!strcmp(name, "strip")) out = IndexLayout::Strip;
+    else return false;
+    return true;
+}
+
+GridTopologyRef acquireGridTopology(int rows, int cols, IndexLayout layout, ThreadPool* pool) {
+    ++g_topologies.stats.requests;
+    auto key = std::make_tuple(rows, cols, (int)layout);
+    auto it = g_topologies.entries.find(key);
+    if (it != g_topologies.entries.end()) return it->second;
+
+    std::vector<unsigned int> idx;
+    if (layout == IndexLayout::Strip) sculptureStripIndices(idx, rows, cols, pool);
+    else if (layout == IndexLayout::Patch) sculpturePatchIndices(idx, rows);
+    else sculptureIndices(idx, rows, cols, pool);
+    trackCpu(&idx, MemTag::Scratch, idx.size() * sizeof(unsigned int));
+    trimGridTopologies(memoryFits(MemDomain::Gpu, idx.size() * sizeof(unsigned int)) ? kTopologyIdleBytes : 0);
+
+    auto t = std::make_shared<GridTopology>();
+    t->rows = rows; t->cols = cols; t->layout = layout;
+    t->mode = layout == IndexLayout::Strip ? GL_TRIANGLE_STRIP : GL_TRIANGLES;
+    t->indexCount = (GLsizei)idx.size();
+    if (layout == IndexLayout::Patch) t->triangles = (GLsizei)(rows * rows * 2);
+    else t->triangles = rows > 1 ? (GLsizei)((rows - 1) * cols * 2) : 0;
+    t->bytes = idx.size() * sizeof(unsigned int);
+    t->ebo = genBuffer();
+    // the copy target: an element buffer binding would land in whatever VAO is bound
+    glBindBuffer(GL_COPY_WRITE_BUFFER, t->ebo);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)t->bytes, idx.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    trackGpu(GpuObject::Buffer, t->ebo, MemTag::Topology, t->bytes);
+    untrackCpu(&idx);
+
+    g_topologies.entries[key] = t;
+    g_topologies.stats.uploads += 1;
+    g_topologies.stats.live += 1;
+    g_topologies.stats.bytes += t->bytes;
+    return t;
+}
+
+void trimGridTopologies(size_t keepBytes) {
+    size_t idle = idleBytes();
+    for (auto it = g_topologies.entries.begin(); it != g_topologies.entries.end() && idle > keepBytes;) {
+        if (it->second.use_count() == 1) {
+            idle -= it->second->bytes;
+            erase(it++);
+        } else {
+            ++it;
+        }
+    }
+}
+
+TopologyStats topologyStats() { return g_topologies.stats; }
+
+void destroyGridTopologies() {
+    while (!g_topologies.entries.empty()) erase(g_topologies.entries.begin());
+}
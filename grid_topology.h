@@ -0,0 +1,49 @@
+#pragma once
+// === shared index buffers: one per grid topology, however many meshes use it ===
+// Every sculpture with the same rings x segments has the same indices, whatever its shape, time or LOD
+// history. The registry builds and uploads each (rows, cols, layout) once and hands out shared
+// references. A topology nobody references stays cached (up to kTopologyIdleBytes) so a LOD level that
+// comes back doesn't pay for the indices again. Index memory and upload time follow the number of
+// distinct topologies, not the number of meshes or rebuilds. Main thread only; release every reference
+// and call destroyGridTopologies() before the context goes.
+#include <glad/glad.h>
+
+#include "gl_resources.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+struct ThreadPool;
+
+// sculptureIndices / sculptureStripIndices / sculpturePatchIndices (a streamed chunk: rows = cols = n)
+enum class IndexLayout { Triangles, Strip, Patch };
+const char* indexLayoutName(IndexLayout l);
+bool parseIndexLayout(const char* name, IndexLayout& out);
+
+struct GridTopology {
+    int rows = 0, cols = 0;
+    IndexLayout layout = IndexLayout::Triangles;
+    GlBuffer ebo;
+    GLenum mode = GL_TRIANGLES;                  // what to draw the indices as
+    GLsizei indexCount = 0;
+    GLsizei triangles = 0;                       // real ones, without a strip's joins or a patch's skirt
+    size_t bytes = 0;
+};
+using GridTopologyRef = std::shared_ptr<const GridTopology>;
+
+const size_t kTopologyIdleBytes = 16u << 20;     // unreferenced topologies beyond this go on the next build
+
+struct TopologyStats {
+    uint64_t requests = 0, uploads = 0;
+    int live = 0;                                // distinct topologies held
+    size_t bytes = 0;
+};
+
+// the shared index buffer for a grid, built on first use; leaves GL_ELEMENT_ARRAY_BUFFER alone
+GridTopologyRef acquireGridTopology(int rows, int cols, IndexLayout layout, ThreadPool* pool = nullptr);
+// drops cached topologies nobody references until at most `keepBytes` of them are left
+void trimGridTopologies(size_t keepBytes);
+TopologyStats topologyStats();
+// every cached topology; outstanding references keep theirs
+void destroyGridTopologies();
@@ -0,0 +1,225 @@
+#include "hud.h"
+#include "frame_stats.h"
+#include "memory_registry.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// 5x7 glyphs, one byte per row (bit 4 = leftmost column); lower case draws as upper case
+struct Glyph {
+    char c;
+    unsigned char rows[7];
+};
+const Glyph kFont[] = {
+    { '0', { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } }, { '1', { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+    { '2', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } }, { '3', { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+    { '4', { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } }, { '5', { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+    { '6', { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } }, { '7', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+    { '8', { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } }, { '9', { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+    { 'A', { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 } }, { 'B', { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+    { 'C', { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } }, { 'D', { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C } },
+    { 'E', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } }, { 'F', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+    { 'G', { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F } }, { 'H', { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+    { 'I', { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } }, { 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C } },
+    { 'K', { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } }, { 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+    { 'M', { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 } }, { 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+    { 'O', { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } }, { 'P', { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 } },
+    { 'Q', { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D } }, { 'R', { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 } },
+    { 'S', { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E } }, { 'T', { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+    { 'U', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } }, { 'V', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+    { 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A } }, { 'X', { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 } },
+    { 'Y', { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 } }, { 'Z', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F } },
+    { '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } }, { ':', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } },
+    { '-', { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 } }, { '/', { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 } },
+    { '%', { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 } }, { '=', { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 } },
+    { '(', { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 } }, { ')', { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 } },
+};
+
+// atlas: ASCII 32..95 in 16 x 4 cells of 6x8 texels, then one solid cell for panels and bars
+const int kCellW = 6, kCellH = 8, kAtlasCols = 16;
+const int kAtlasW = kAtlasCols * kCellW, kAtlasH = 5 * kCellH;
+const float kSolidU = 2.5f, kSolidV = 4 * kCellH + 3.5f;
+const float kScale = 2.0f;                 // screen pixels per font texel
+const int kTextEvery = 15;                 // frames between text refreshes
+const int kRssEvery = 30;                  // frames between process memory samples
+
+unsigned int premultiplied(float r, float g, float b, float a) {
+    auto byte = [](float f) { return (unsigned int)(std::min(std::max(f, 0.0f), 1.0f) * 255.0f + 0.5f); };
+    return byte(r * a) | byte(g * a) << 8 | byte(b * a) << 16 | byte(a) << 24;
+}
+
+void solid(std::vector<HudQuad>& q, float x, float y, float w, float h, unsigned int rgba) {
+    q.push_back({ x, y, w, h, kSolidU, kSolidV, kSolidU, kSolidV, rgba });
+}
+
+// returns the width in pixels
+float text(std::vector<HudQuad>& q, float x, float y, const std::string& s, unsigned int rgba) {
+    float x0 = x;
+    for (char c : s) {
+        if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+        if (c > ' ' && c < 96) {
+            int cell = c - 32;
+            float u = (float)(cell % kAtlasCols * kCellW), v = (float)(cell / kAtlasCols * kCellH);
+            q.push_back({ x, y, 5 * kScale, 7 * kScale, u, v, u + 5, v + 7, rgba });
+        }
+        x += kCellW * kScale;
+    }
+    return x - x0;
+}
+
+float p99(const float* v, int n) {
+    float tmp[kHudHistory];
+    std::copy(v, v + n, tmp);
+    std::sort(tmp, tmp + n);
+    return n ? tmp[std::min(n - 1, (int)(0.99f * (n - 1) + 0.5f))] : 0.0f;
+}
+
+} // namespace
+
+Hud makeHud(GLuint prog) {
+    Hud hud;
+    hud.prog = GlProgram(prog);
+
+    std::vector<unsigned char> texels(kAtlasW * kAtlasH, 0);
+    for (const Glyph& g : kFont) {
+        int cell = g.c - 32;
+        int x0 = cell % kAtlasCols * kCellW, y0 = cell / kAtlasCols * kCellH;
+        for (int r = 0; r < 7; ++r)
+            for (int c = 0; c < 5; ++c)
+                if (g.rows[r] & (0x10 >> c)) texels[(y0 + r) * kAtlasW + x0 + c] = 255;
+    }
+    for (int r = 0; r < kCellH; ++r)
+        for (int c = 0; c < kCellW; ++c) texels[(4 * kCellH + r) * kAtlasW + c] = 255;
+
+    hud.atlas = genTexture();
+    glBindTexture(GL_TEXTURE_2D, hud.atlas);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, kAtlasW, kAtlasH, 0, GL_RED, GL_UNSIGNED_BYTE, texels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    trackGpu(GpuObject::Texture, hud.atlas, MemTag::Hud, texels.size());
+
+    hud.vao = genVertexArray();
+    hud.vbo = genBuffer();
+    glBindVertexArray(hud.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, hud.vbo);
+    GLsizei stride = sizeof(HudQuad);
+    glEnableVertexAttribArray(0); glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(HudQuad, x));
+    glEnableVertexAttribArray(1); glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(HudQuad, u0));
+    glEnableVertexAttribArray(2); glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(HudQuad, rgba));
+    for (int a = 0; a < 3; ++a) glVertexAttribDivisor(a, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(prog);
+    glUniform1i(glGetUniformLocation(prog, "uAtlas"), 0);
+    glUniform2f(glGetUniformLocation(prog, "uAtlasSize"), (float)kAtlasW, (float)kAtlasH);
+    return hud;
+}
+
+void pushHudFrame(Hud& hud, float frameMs, float cpuMs, float gpuMs) {
+    int i = hud.frames % kHudHistory;
+    hud.frameMs[i] = frameMs; hud.cpuMs[i] = cpuMs; hud.gpuMs[i] = gpuMs;
+    ++hud.frames;
+}
+
+void drawHud(Hud& hud, const HudStats& s, int width, int height) {
+    double t0 = processMs();
+    int n = std::min(hud.frames, kHudHistory);
+
+    if (hud.frames % kRssEvery == 1 || hud.rssMb == 0.0) {
+        ProcessMemory process = sampleProcessMemory();
+        hud.rssMb = process.rssBytes / (1024.0 * 1024.0);
+        hud.peakRssMb = process.peakRssBytes / (1024.0 * 1024.0);
+        MemUsage gpu = memoryUsage(MemDomain::Gpu), cpu = memoryUsage(MemDomain::Cpu);
+        DriverMemory driver = queryDriverMemory();
+        char buf[96];
+        int n = snprintf(buf, sizeof(buf), "GPU %.1f MB PEAK %.1f  CPU %.1f", gpu.current / (1024.0 * 1024.0),
+                         gpu.peak / (1024.0 * 1024.0), cpu.current / (1024.0 * 1024.0));
+        if (size_t budget = memoryBudget(MemDomain::Gpu))
+            n += snprintf(buf + n, sizeof(buf) - n, "  BUDGET %.0f", budget / (1024.0 * 1024.0));
+        if (driver.source) snprintf(buf + n, sizeof(buf) - n, "  FREE %.0f", driver.freeBytes / (1024.0 * 1024.0));
+        hud.memoryLine = buf;
+    }
+    if (hud.frames % kTextEvery == 1 || hud.lines[0].empty()) {
+        float frameMean = 0.0f, cpuMean = 0.0f, gpuMean = 0.0f;
+        for (int i = 0; i < n; ++i) { frameMean += hud.frameMs[i]; cpuMean += hud.cpuMs[i]; gpuMean += hud.gpuMs[i]; }
+        if (n) { frameMean /= n; cpuMean /= n; gpuMean /= n; }
+        char buf[96];
+        snprintf(buf, sizeof(buf), "FRAME %.2f MS  P99 %.2f  FPS %.0f", frameMean, p99(hud.frameMs, n),
+                 frameMean > 0.0f ? 1000.0f / frameMean : 0.0f);
+        hud.lines[0] = buf;
+        snprintf(buf, sizeof(buf), "CPU %.2f P99 %.2f  GPU %.2f P99 %.2f", cpuMean, p99(hud.cpuMs, n), gpuMean, p99(hud.gpuMs, n));
+        hud.lines[1] = buf;
+        snprintf(buf, sizeof(buf), "DRAWS %d  TRIS %lld  LIGHTS %d", s.drawCalls, s.triangles, s.lights);
+        hud.lines[2] = buf;
+        snprintf(buf, sizeof(buf), "RSS %.0f MB  PEAK %.0f  HUD %.3f MS", hud.rssMb, hud.peakRssMb, hud.selfMs);
+        hud.lines[3] = buf;
+        hud.lines[4] = hud.memoryLine;
+    }
+
+    // panel, text lines, then CPU and GPU graphs with a 60 Hz budget line
+    std::vector<HudQuad>& q = hud.quads;
+    q.clear();
+    const float pad = 8.0f, lineH = (kCellH + 1) * kScale, graphH = 40.0f, barW = 2.0f;
+    float x = pad + 6.0f, y = pad + 6.0f;
+    float panelW = kHudHistory * barW, textW = 0.0f;
+    for (const std::string& l : hud.lines) textW = std::max(textW, (float)l.size() * kCellW * kScale);
+    panelW = std::max(panelW, textW) + 12.0f;
+    solid(q, pad, pad, panelW, kHudLines * lineH + 2 * (graphH + 6.0f) + 12.0f, premultiplied(0.0f, 0.0f, 0.0f, 0.6f));
+    const unsigned int white = premultiplied(0.9f, 0.9f, 0.9f, 1.0f);
+    for (const std::string& l : hud.lines) { text(q, x, y, l, white); y += lineH; }
+
+    float scaleMs = 33.3f;
+    for (int i = 0; i < n; ++i) scaleMs = std::max(scaleMs, std::max(hud.cpuMs[i], hud.gpuMs[i]));
+    const float* series[2] = { hud.cpuMs, hud.gpuMs };
+    const unsigned int colors[2] = { premultiplied(0.3f, 0.9f, 0.4f, 0.9f), premultiplied(1.0f, 0.6f, 0.2f, 0.9f) };
+    for (int g = 0; g < 2; ++g) {
+        y += 6.0f;
+        float base = y + graphH;
+        // oldest sample on the left
+        for (int k = 0; k < n; ++k) {
+            int i = (hud.frames - n + k) % kHudHistory;
+            float h = std::min(series[g][i] / scaleMs, 1.0f) * graphH;
+            if (h > 0.0f) solid(q, x + k * barW, base - h, barW - 0.5f, h, colors[g]);
+        }
+        solid(q, x, base - 16.7f / scaleMs * graphH, kHudHistory * barW, 1.0f, premultiplied(1.0f, 1.0f, 1.0f, 0.5f));
+        y = base;
+    }
+
+    GLsizeiptr bytes = (GLsizeiptr)(q.size() * sizeof(HudQuad));
+    glBindBuffer(GL_ARRAY_BUFFER, hud.vbo);
+    if (bytes > hud.vboBytes) {
+        hud.vboBytes = bytes * 2;
+        trackGpu(GpuObject::Buffer, hud.vbo, MemTag::Hud, (size_t)hud.vboBytes);
+    }
+    glBufferData(GL_ARRAY_BUFFER, hud.vboBytes, nullptr, GL_STREAM_DRAW); // orphan
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, q.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(hud.prog);
+    glUniform2f(glGetUniformLocation(hud.prog, "uViewport"), (float)width, (float)height);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, hud.atlas);
+    glBindVertexArray(hud.vao);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)q.size());
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+
+    hud.selfMs = processMs() - t0;
+}
+
+void destroyHud(Hud& hud) { hud = Hud(); }
@@ -0,0 +1,8 @@
+#version 330 core
+in vec2 vUv;
+in vec4 vColor;
+uniform sampler2D uAtlas;
+out vec4 FragColor;
+void main(){
+    FragColor = vColor * texture(uAtlas, vUv).r;
+}
@@ -0,0 +1,51 @@
+#pragma once
+// === on-screen performance HUD: rolling CPU/GPU frame-time graphs and a few counters ===
+// Everything (panel, graph bars, glyphs) is one quad instance from a 5x7 bitmap font atlas baked at
+// startup; the instances go through one orphaned vertex buffer and one glDrawArraysInstanced per frame.
+// Text is re-formatted a few times a second, memory_registry.h sampled (RSS included) every 30 frames; the HUD times itself and
+// shows the result, so its own cost is visible next to the numbers it reports.
+#include <glad/glad.h>
+
+#include "gl_resources.h"
+
+#include <string>
+#include <vector>
+
+const int kHudHistory = 120;    // frames in the graphs
+const int kHudLines = 5;
+
+struct HudQuad {
+    float x, y, w, h;           // pixels, origin top left
+    float u0, v0, u1, v1;       // atlas texels
+    unsigned int rgba;          // 0xAABBGGRR, read as normalized bytes
+};
+
+struct HudStats {
+    int drawCalls = 0;
+    long long triangles = 0;
+    int lights = 0;
+};
+
+struct Hud {
+    GlProgram prog;
+    GlVertexArray vao;
+    GlBuffer vbo;
+    GlTexture atlas;
+    GLsizeiptr vboBytes = 0;
+    std::vector<HudQuad> quads;
+    float frameMs[kHudHistory] = {}, cpuMs[kHudHistory] = {}, gpuMs[kHudHistory] = {};
+    int frames = 0;                 // frames pushed so far
+    std::string lines[kHudLines];   // formatted text, refreshed every few frames
+    double rssMb = 0.0, peakRssMb = 0.0;
+    std::string memoryLine;         // memory_registry.h numbers, with the RSS
+    double selfMs = 0.0;            // CPU time of the previous drawHud()
+    bool visible = false;
+};
+
+// prog is hud.vs + hud.fs, linked by the caller; the HUD owns it from here
+Hud makeHud(GLuint prog);
+// call once per frame, shown or not, so the graphs are full when the HUD is toggled on
+void pushHudFrame(Hud& hud, float frameMs, float cpuMs, float gpuMs);
+// draws into the bound framebuffer; leaves depth test on and blending off as the renderer expects
+void drawHud(Hud& hud, const HudStats& s, int width, int height);
+void destroyHud(Hud& hud);
@@ -0,0 +1,16 @@
+#version 330 core
+// one quad per instance, corners from gl_VertexID (triangle strip of 4)
+layout(location=0) in vec4 aRect;       // x, y, w, h in pixels, origin top left
+layout(location=1) in vec4 aUv;         // u0, v0, u1, v1 in atlas texels
+layout(location=2) in vec4 aColor;
+uniform vec2 uViewport;
+uniform vec2 uAtlasSize;
+out vec2 vUv;
+out vec4 vColor;
+void main(){
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 p = aRect.xy + corner * aRect.zw;
+    gl_Position = vec4(p.x / uViewport.x * 2.0 - 1.0, 1.0 - p.y / uViewport.y * 2.0, 0.0, 1.0);
+    vUv = mix(aUv.xy, aUv.zw, corner) / uAtlasSize;
+    vColor = aColor;
+}
@@ -0,0 +1,32 @@
+#pragma once
+// === point lights as the renderer and the CPU light stages see them ===
+#include <glm/glm.hpp>
+
+struct PointLight {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 ambient = glm::vec3(0.02f), diffuse = glm::vec3(0.9f), specular = glm::vec3(1.0f);
+    float constant = 1.0f, linear = 0.14f, quadratic = 0.07f;
+};
+
+// std140 image of PointLight in sculpture.fs: every vec3 is followed by a float, 64 bytes per light
+struct GpuPointLight {
+    float position[3]; float constant;
+    float ambient[3];  float linear;
+    float diffuse[3];  float quadratic;
+    float specular[3]; float pad;
+};
+// 256 * 64 B = 16 KB, the smallest GL_MAX_UNIFORM_BLOCK_SIZE an implementation may have
+const int kMaxShaderLights = 256;
+
+inline GpuPointLight packLight(const PointLight& L) {
+    return {
+        { L.position.x, L.position.y, L.position.z }, L.constant,
+        { L.ambient.x, L.ambient.y, L.ambient.z }, L.linear,
+        { L.diffuse.x, L.diffuse.y, L.diffuse.z }, L.quadratic,
+        { L.specular.x, L.specular.y, L.specular.z }, 0.0f
+    };
+}
+
+inline float attenuation(const PointLight& L, float d) {
+    return 1.0f / (L.constant + L.linear * d + L.quadratic * d * d);
+}
@@ -0,0 +1,156 @@
+#include "lighttree.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+
+namespace {
+
+float luminance(glm::vec3 c) { return 0.2126f * c.x + 0.7152f * c.y + 0.0722f * c.z; }
+
+// spreads the low 10 bits so two zero bits sit between each of them
+uint32_t expandBits(uint32_t v) {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+LightNode leafNode(const PointLight& L, int index) {
+    LightNode n;
+    n.bmin = n.bmax = L.position;
+    n.ambient = L.ambient; n.diffuse = L.diffuse; n.specular = L.specular;
+    n.intensity = luminance(L.ambient + L.diffuse + L.specular);
+    n.constant = L.constant; n.linear = L.linear; n.quadratic = L.quadratic;
+    n.rep = index;
+    return n;
+}
+
+LightNode merge(const LightNode& a, const LightNode& b) {
+    if (a.rep < 0) return b;
+    if (b.rep < 0) return a;
+    LightNode n;
+    n.bmin = glm::min(a.bmin, b.bmin); n.bmax = glm::max(a.bmax, b.bmax);
+    n.ambient = a.ambient + b.ambient; n.diffuse = a.diffuse + b.diffuse; n.specular = a.specular + b.specular;
+    n.intensity = a.intensity + b.intensity;
+    n.constant = std::min(a.constant, b.constant);
+    n.linear = std::min(a.linear, b.linear);
+    n.quadratic = std::min(a.quadratic, b.quadratic);
+    // the brighter child speaks for the cluster; deterministic, so cuts don't flicker frame to frame
+    n.rep = a.intensity >= b.intensity ? a.rep : b.rep;
+    return n;
+}
+
+void fillLeaves(LightTree& tree, const std::vector<PointLight>& lights, ThreadPool& pool) {
+    int leaves = tree.leafBase + 1;
+    pool.parallelFor(leaves, 4096, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+            tree.nodes[tree.leafBase + i] = i < tree.lightCount ? leafNode(lights[tree.order[i]], tree.order[i]) : LightNode();
+    });
+}
+
+void refitInternal(LightTree& tree, ThreadPool& pool) {
+    // levels of the implicit tree, deepest internal level first
+    for (int first = tree.leafBase / 2; ; first /= 2) {
+        int count = first + 1;
+        pool.parallelFor(count, 2048, [&](int begin, int end) {
+            for (int i = first + begin; i < first + end; ++i)
+                tree.nodes[i] = merge(tree.nodes[2 * i + 1], tree.nodes[2 * i + 2]);
+        });
+        if (first == 0) break;
+    }
+}
+
+// squared distance between two boxes, 0 if they overlap
+float boxDistance2(glm::vec3 amin, glm::vec3 amax, glm::vec3 bmin, glm::vec3 bmax) {
+    glm::vec3 gap = glm::max(glm::max(amin - bmax, bmin - amax), glm::vec3(0.0f));
+    return glm::dot(gap, gap);
+}
+
+} // namespace
+
+void buildLightTree(LightTree& tree, const std::vector<PointLight>& lights, ThreadPool& pool) {
+    int n = (int)lights.size();
+    tree.lightCount = n;
+    int leaves = 1;
+    while (leaves < n) leaves *= 2;
+    tree.leafBase = leaves - 1;
+    tree.nodes.assign(2 * leaves - 1, LightNode());
+    if (n == 0) { tree.order.clear(); return; }
+
+    glm::vec3 lo = lights[0].position, hi = lights[0].position;
+    for (const PointLight& L : lights) { lo = glm::min(lo, L.position); hi = glm::max(hi, L.position); }
+    glm::vec3 extent = glm::max(hi - lo, glm::vec3(1e-6f));
+
+    std::vector<uint64_t> keys(n); // morton code << 32 | light index
+    pool.parallelFor(n, 4096, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            glm::vec3 q = (lights[i].position - lo) / extent * 1023.0f;
+            uint32_t code = expandBits((uint32_t)q.x) << 2 | expandBits((uint32_t)q.y) << 1 | expandBits((uint32_t)q.z);
+            keys[i] = (uint64_t)code << 32 | (uint32_t)i;
+        }
+    });
+    std::sort(keys.begin(), keys.end());
+    tree.order.resize(n);
+    for (int i = 0; i < n; ++i) tree.order[i] = (int)(keys[i] & 0xffffffffu);
+
+    fillLeaves(tree, lights, pool);
+    if (leaves > 1) refitInternal(tree, pool);
+}
+
+void refitLightTree(LightTree& tree, const std::vector<PointLight>& lights, ThreadPool& pool) {
+    if (tree.lightCount != (int)lights.size()) { buildLightTree(tree, lights, pool); return; }
+    if (tree.lightCount == 0) return;
+    fillLeaves(tree, lights, pool);
+    if (tree.leafBase > 0) refitInternal(tree, pool);
+}
+
+void selectCut(const LightTree& tree, const std::vector<PointLight>& lights, glm::vec3 omin, glm::vec3 omax,
+               const LightCutSettings& s, std::vector<PointLight>& out) {
+    if (tree.lightCount == 0 || tree.nodes.empty()) return;
+    glm::vec3 centre = (omin + omax) * 0.5f;
+
+    // upper bound on what a cluster could add anywhere on the object (material terms <= 1)
+    auto errorBound = [&](const LightNode& n) {
+        float d = sqrtf(boxDistance2(n.bmin, n.bmax, omin, omax));
+        return n.intensity / (n.constant + n.linear * d + n.quadratic * d * d);
+    };
+    // what the cluster contributes when shaded as its representative
+    auto estimate = [&](const LightNode& n) {
+        return n.intensity * attenuation(lights[n.rep], glm::distance(lights[n.rep].position, centre));
+    };
+
+    struct Entry { float error; int node; bool operator<(const Entry& o) const { return error < o.error; } };
+    std::priority_queue<Entry> open;
+    std::vector<int> exact; // leaves: a single light is its own exact representative
+    auto push = [&](int i) {
+        if (tree.nodes[i].rep < 0) return;
+        if (i >= tree.leafBase) exact.push_back(i);
+        else open.push({ errorBound(tree.nodes[i]), i });
+    };
+
+    float total = estimate(tree.nodes[0]);
+    push(0);
+    int maxCut = std::max(1, std::min(s.maxCut, kMaxShaderLights));
+    while (!open.empty() && (int)(open.size() + exact.size()) < maxCut) {
+        Entry top = open.top();
+        if (top.error <= s.maxRelativeError * total) break;
+        open.pop();
+        total -= estimate(tree.nodes[top.node]);
+        for (int c = 2 * top.node + 1; c <= 2 * top.node + 2; ++c)
+            if (tree.nodes[c].rep >= 0) total += estimate(tree.nodes[c]);
+        push(2 * top.node + 1);
+        push(2 * top.node + 2);
+    }
+
+    auto emit = [&](int i) {
+        const LightNode& n = tree.nodes[i];
+        PointLight L = lights[n.rep];
+        L.ambient = n.ambient; L.diffuse = n.diffuse; L.specular = n.specular;
+        out.push_back(L);
+    };
+    for (int i : exact) emit(i);
+    for (; !open.empty(); open.pop()) emit(open.top().node);
+}
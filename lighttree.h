@@ -0,0 +1,41 @@
+#pragma once
+// === light tree (lightcuts-style) for scenes with many point lights ===
+// A binary hierarchy over the lights, built over Morton-sorted positions so nearby lights share
+// subtrees. Every node keeps its bounds, the summed light colours and one representative light. For an
+// object (given by its world bounds) selectCut() picks a set of nodes whose estimated error is below a
+// relative bound; each node is then shaded as one light at its representative's position carrying the
+// whole cluster's colour, so the shader loop scales with the cut size, not the light count.
+#include "lights.h"
+
+#include <vector>
+
+struct ThreadPool;
+
+struct LightNode {
+    glm::vec3 bmin = glm::vec3(0.0f), bmax = glm::vec3(0.0f);
+    glm::vec3 ambient = glm::vec3(0.0f), diffuse = glm::vec3(0.0f), specular = glm::vec3(0.0f);
+    float intensity = 0.0f;     // luminance of diffuse + specular, drives representative choice and error
+    // smallest attenuation coefficients under this node: a conservative (brightest) falloff
+    float constant = 0.0f, linear = 0.0f, quadratic = 0.0f;
+    int rep = -1;               // representative light, -1 for an empty node
+};
+
+// implicit complete tree: node i has children 2i+1 and 2i+2, leaves start at leafBase
+struct LightTree {
+    std::vector<LightNode> nodes;
+    std::vector<int> order;     // leaf slot -> light index (Morton order)
+    int leafBase = 0, lightCount = 0;
+};
+
+struct LightCutSettings {
+    float maxRelativeError = 0.02f; // stop refining once every node's bound is below this share of the total
+    int maxCut = 64;                // never hand the shader more than this many lights
+};
+
+// sorts lights along a Morton curve and builds the tree; call when the light set changes or drifts a lot
+void buildLightTree(LightTree& tree, const std::vector<PointLight>& lights, ThreadPool& pool);
+// keeps the topology and recomputes bounds/aggregates bottom-up, one parallel sweep per level
+void refitLightTree(LightTree& tree, const std::vector<PointLight>& lights, ThreadPool& pool);
+// cut for an object with world bounds [omin, omax]; appends the virtual lights to `out`
+void selectCut(const LightTree& tree, const std::vector<PointLight>& lights, glm::vec3 omin, glm::vec3 omax,
+               const LightCutSettings& s, std::vector<PointLight>& out);
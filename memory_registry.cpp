@@ -0,0 +1,195 @@
+#include "memory_registry.h"
+#include "frame_stats.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+
+// not in every glad build
+const GLenum kGpuMemoryDedicatedNvx = 0x9047, kGpuMemoryAvailableNvx = 0x9049;
+const GLenum kVboFreeMemoryAti = 0x87FB;
+const GLenum kProgramBinaryLength = 0x8741;
+
+struct Entry {
+    MemDomain domain;
+    MemTag tag;
+    size_t bytes;
+};
+
+struct Registry {
+    // GPU keys carry the object kind in the top byte; CPU keys are user-space addresses, which never reach it
+    std::unordered_map<uint64_t, Entry> entries;
+    MemUsage tags[kMemTagCount][2];
+    MemUsage total[2];
+    size_t budget[2] = { 0, 0 };
+    bool warned[2] = { false, false };
+    bool nvx = false, ati = false, programBinary = false;
+    ProcessMemory process;
+};
+Registry g_memory;
+
+uint64_t gpuKey(GpuObject kind, GLuint name) { return (uint64_t)((int)kind + 1) << 56 | name; }
+
+void add(MemUsage& u, size_t bytes, int objects) {
+    u.current += bytes;
+    u.objects += objects;
+    if (u.current > u.peak) u.peak = u.current;
+}
+
+void remove(uint64_t key) {
+    auto it = g_memory.entries.find(key);
+    if (it == g_memory.entries.end()) return;
+    const Entry& e = it->second;
+    int d = (int)e.domain;
+    g_memory.tags[(int)e.tag][d].current -= e.bytes;
+    g_memory.tags[(int)e.tag][d].objects -= 1;
+    g_memory.total[d].current -= e.bytes;
+    g_memory.total[d].objects -= 1;
+    g_memory.entries.erase(it);
+}
+
+void set(uint64_t key, MemDomain domain, MemTag tag, size_t bytes) {
+    remove(key);
+    int d = (int)domain;
+    g_memory.entries[key] = { domain, tag, bytes };
+    add(g_memory.tags[(int)tag][d], bytes, 1);
+    add(g_memory.total[d], bytes, 1);
+    size_t budget = g_memory.budget[d];
+    if (budget && g_memory.total[d].current > budget && !g_memory.warned[d]) {
+        std::cerr << (domain == MemDomain::Gpu ? "GPU" : "CPU") << " memory over budget: "
+                  << g_memory.total[d].current / (1024.0 * 1024.0) << " MB of " << budget / (1024.0 * 1024.0)
+                  << " MB (" << memTagName(tag) << ")\n";
+        g_memory.warned[d] = true;
+    }
+}
+
+bool hasExtension(const char* name) {
+    GLint n = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &n);
+    for (GLint i = 0; i < n; ++i) {
+        const char* e = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (e && !strcmp(e, name)) return true;
+    }
+    return false;
+}
+
+double mb(size_t bytes) { return bytes / (1024.0 * 1024.0); }
+
+} // namespace
+
+const char* memTagName(MemTag t) {
+    static const char* names[kMemTagCount] = { "sculpture", "light-cubes", "morph", "lights", "wave-field", "vertex-stream",
+                                               "softbody", "hud", "target", "programs", "scratch", "buffer-pool",
+                                               "topology" };
+    return (int)t < kMemTagCount ? names[(int)t] : "?";
+}
+
+void initMemoryRegistry() {
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    g_memory.programBinary = major > 4 || (major == 4 && minor >= 1) || hasExtension("GL_ARB_get_program_binary");
+    g_memory.nvx = hasExtension("GL_NVX_gpu_memory_info");
+    g_memory.ati = !g_memory.nvx && hasExtension("GL_ATI_meminfo");
+}
+
+void trackGpu(GpuObject kind, GLuint name, MemTag tag, size_t bytes) {
+    if (name) set(gpuKey(kind, name), MemDomain::Gpu, tag, bytes);
+}
+void untrackGpu(GpuObject kind, GLuint name) { remove(gpuKey(kind, name)); }
+
+void trackProgram(GLuint program) {
+    GLint bytes = 0;
+    if (g_memory.programBinary) glGetProgramiv(program, kProgramBinaryLength, &bytes);
+    trackGpu(GpuObject::Program, program, MemTag::Programs, bytes > 0 ? (size_t)bytes : 0);
+}
+
+void trackCpu(const void* owner, MemTag tag, size_t bytes) {
+    if (owner) set((uint64_t)(uintptr_t)owner, MemDomain::Cpu, tag, bytes);
+}
+void untrackCpu(const void* owner) { remove((uint64_t)(uintptr_t)owner); }
+
+void setMemoryBudget(MemDomain d, size_t bytes) {
+    g_memory.budget[(int)d] = bytes;
+    g_memory.warned[(int)d] = false;
+}
+size_t memoryBudget(MemDomain d) { return g_memory.budget[(int)d]; }
+
+bool memoryFits(MemDomain d, size_t bytes) {
+    size_t budget = g_memory.budget[(int)d];
+    return !budget || g_memory.total[(int)d].current + bytes <= budget;
+}
+
+MemUsage memoryUsage(MemDomain d) { return g_memory.total[(int)d]; }
+MemUsage memoryUsage(MemDomain d, MemTag t) { return g_memory.tags[(int)t][(int)d]; }
+
+DriverMemory queryDriverMemory() {
+    DriverMemory m;
+    if (g_memory.nvx) {
+        GLint total = 0, avail = 0;
+        glGetIntegerv(kGpuMemoryDedicatedNvx, &total);
+        glGetIntegerv(kGpuMemoryAvailableNvx, &avail);
+        m.source = "nvx";
+        m.totalBytes = (size_t)total * 1024;
+        m.freeBytes = (size_t)avail * 1024;
+    } else if (g_memory.ati) {
+        // total free, largest free block, auxiliary total, auxiliary largest; kilobytes
+        GLint info[4] = {};
+        glGetIntegerv(kVboFreeMemoryAti, info);
+        m.source = "ati";
+        m.freeBytes = (size_t)info[0] * 1024;
+    }
+    return m;
+}
+
+std::string memoryStats() {
+    char buf[160];
+    snprintf(buf, sizeof(buf), "gpu_tracked_mb=%.3f gpu_peak_mb=%.3f cpu_tracked_mb=%.3f cpu_peak_mb=%.3f",
+             mb(g_memory.total[1].current), mb(g_memory.total[1].peak), mb(g_memory.total[0].current),
+             mb(g_memory.total[0].peak));
+    return buf;
+}
+
+ProcessMemory sampleProcessMemory() {
+    ProcessMemory& p = g_memory.process;
+    p.rssBytes = currentRssBytes();
+    p.peakRssBytes = std::max(peakRssBytes(), p.rssBytes);   // getrusage lags behind statm
+    size_t tracked = g_memory.total[(int)MemDomain::Cpu].current;
+    p.untrackedBytes = p.rssBytes > tracked ? p.rssBytes - tracked : 0;
+    return p;
+}
+
+std::string memoryJson() {
+    std::ostringstream o;
+    o << "{";
+    for (int d = 0; d < 2; ++d) {
+        const MemUsage& t = g_memory.total[d];
+        o << (d ? ",\n  " : "\n  ") << (d ? "\"gpu\"" : "\"cpu\"") << ": {\"current_bytes\": " << t.current
+          << ", \"peak_bytes\": " << t.peak << ", \"objects\": " << t.objects << ", \"budget_bytes\": " << g_memory.budget[d]
+          << ", \"tags\": {";
+        bool first = true;
+        for (int i = 0; i < kMemTagCount; ++i) {
+            const MemUsage& u = g_memory.tags[i][d];
+            if (!u.peak && !u.objects) continue;
+            o << (first ? "" : ", ") << "\"" << memTagName((MemTag)i) << "\": {\"current_bytes\": " << u.current
+              << ", \"peak_bytes\": " << u.peak << ", \"objects\": " << u.objects << "}";
+            first = false;
+        }
+        o << "}}";
+    }
+    DriverMemory dm = queryDriverMemory();
+    if (dm.source)
+        o << ",\n  \"driver\": {\"source\": \"" << dm.source << "\", \"total_bytes\": " << dm.totalBytes
+          << ", \"free_bytes\": " << dm.freeBytes << "}";
+    const ProcessMemory& p = g_memory.process;
+    if (p.rssBytes)
+        o << ",\n  \"process\": {\"rss_bytes\": " << p.rssBytes << ", \"peak_rss_bytes\": " << p.peakRssBytes
+          << ", \"untracked_bytes\": " << p.untrackedBytes << "}";
+    o << "\n}\n";
+    return o.str();
+}
@@ -0,0 +1,70 @@
+#pragma once
+// === memory accounting: GL objects and large CPU arrays by tag, with peaks and an optional budget ===
+// Allocation sites report what they own (trackGpu / trackCpu) and withdraw it when they free it.
+// The registry keeps current and peak bytes per tag and per domain, and answers budget queries for
+// subsystems about to allocate. It also formats the numbers for the HUD, telemetry, --stats and JSON.
+// GL doesn't say what an object really costs: sizes are what was asked for (buffer bytes, texels x texel
+// size, GL_PROGRAM_BINARY_LENGTH), so driver padding and alignment aren't in them. The driver's own
+// view comes from GL_NVX_gpu_memory_info or GL_ATI_meminfo where present. Main thread only.
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class MemTag : uint8_t {
+    Sculpture, LightCubes, Morph, Lights, WaveField, VertexStream, SoftBody, Hud, Target, Programs, Scratch,
+    BufferPool, Topology,
+    Count
+};
+const int kMemTagCount = (int)MemTag::Count;
+enum class MemDomain : uint8_t { Cpu, Gpu };
+enum class GpuObject : uint8_t { Buffer, Texture, Renderbuffer, Program };
+
+const char* memTagName(MemTag t);
+
+struct MemUsage {
+    size_t current = 0, peak = 0;
+    int objects = 0;
+};
+
+struct DriverMemory {
+    const char* source = nullptr;   // "nvx", "ati" or null when the driver reports nothing
+    size_t totalBytes = 0;          // dedicated video memory (NVX only)
+    size_t freeBytes = 0;           // currently available
+};
+
+// after GL is loaded: looks for the driver memory extensions and program binary lengths
+void initMemoryRegistry();
+
+// (re)sets the size of a GL object, e.g. again after glBufferData re-specifies it; name 0 is ignored
+void trackGpu(GpuObject kind, GLuint name, MemTag tag, size_t bytes);
+void untrackGpu(GpuObject kind, GLuint name);
+// linked program: its binary length where the driver can tell, else counted with 0 bytes
+void trackProgram(GLuint program);
+// CPU memory by a stable owner address (the struct or vector, not its data); call again when it resizes
+void trackCpu(const void* owner, MemTag tag, size_t bytes);
+void untrackCpu(const void* owner);
+
+// 0 = unlimited. Tracking never refuses; going over is counted and reported once on stderr.
+void setMemoryBudget(MemDomain d, size_t bytes);
+size_t memoryBudget(MemDomain d);
+// whether `bytes` more stay within the domain's budget; ask before a large allocation
+bool memoryFits(MemDomain d, size_t bytes);
+
+MemUsage memoryUsage(MemDomain d);
+MemUsage memoryUsage(MemDomain d, MemTag t);
+DriverMemory queryDriverMemory();
+
+// the process as the OS sees it, next to what was tracked; reads /proc, so sample every so many frames
+struct ProcessMemory {
+    size_t rssBytes = 0, peakRssBytes = 0;
+    size_t untrackedBytes = 0;      // resident beyond the tracked CPU bytes
+};
+// reads it now and keeps it for memoryJson()
+ProcessMemory sampleProcessMemory();
+
+// "gpu_tracked_mb=... gpu_peak_mb=... cpu_tracked_mb=... cpu_peak_mb=..." for the stats line
+std::string memoryStats();
+// every tag per domain, budgets, the driver's numbers and the last process sample as one JSON object
+std::string memoryJson();
@@ -0,0 +1,511 @@
+#include "mesh_export.h"
+
+#include "sculpture_geometry.h"
+#include "thread_pool.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+static_assert(sizeof(SequenceHeader) == 48 && sizeof(SequenceFrameHeader) == 40, "sequence records must stay packed");
+
+namespace {
+
+const size_t kPage = 4096;
+const int kQuantComponents = 5;             // x, y, z, normal low half, normal high half
+const float kKeyPadding = 0.02f;            // of the extent, so a little overshoot doesn't force the next key
+
+double seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void writerLoop(AsyncFileWriter* w) {
+    std::unique_lock<std::mutex> lock(w->mtx);
+    for (;;) {
+        w->wake.wait(lock, [&] { return w->quit || !w->full.empty(); });
+        if (w->full.empty()) return;
+        std::pair<char*, size_t> block = w->full.front();
+        w->full.erase(w->full.begin());
+        bool failed = w->failed;
+        lock.unlock();
+
+        // O_DIRECT wants whole pages: the short last block goes out zero-padded and close truncates it
+        size_t bytes = block.second;
+        if (w->direct && bytes % kPage) {
+            bytes = (bytes + kPage - 1) / kPage * kPage;
+            memset(block.first + block.second, 0, bytes - block.second);
+        }
+        double t0 = seconds();
+        size_t done = 0;
+        while (!failed && done < bytes) {
+            ssize_t n = ::write(w->fd, block.first + done, bytes - done);
+            if (n < 0 && errno == EINTR) continue;
+#ifdef O_DIRECT
+            if (n < 0 && errno == EINVAL && w->direct) {
+                // opened fine, but this filesystem won't do unbuffered writes after all
+                fcntl(w->fd, F_SETFL, fcntl(w->fd, F_GETFL) & ~O_DIRECT);
+                w->direct = false;
+                bytes = block.second;
+                continue;
+            }
+#endif
+            if (n <= 0) failed = true;
+            else done += (size_t)n;
+        }
+        double t1 = seconds();
+
+        lock.lock();
+        w->writeS += t1 - t0;
+        w->bytes += std::min(done, block.second);
+        w->failed = failed;         // after a failure the rest is only drained, so the encoder never blocks
+        w->free.push_back(block.first);
+        w->wake.notify_all();
+    }
+}
+
+// hands the current block to the writer and takes a free one, waiting if the disk is behind
+void submitBlock(AsyncFileWriter& w) {
+    std::unique_lock<std::mutex> lock(w.mtx);
+    w.full.push_back({ w.current, w.used });
+    w.wake.notify_all();
+    double t0 = seconds();
+    w.wake.wait(lock, [&] { return !w.free.empty(); });
+    w.stallS += seconds() - t0;
+    w.current = w.free.back();
+    w.free.pop_back();
+    w.used = 0;
+}
+
+uint16_t quantize(float v, float lo, float scale) {
+    float q = (v - lo) * scale + 0.5f;
+    return (uint16_t)(q <= 0.0f ? 0.0f : q >= 65535.0f ? 65535.0f : q);
+}
+
+// signed 16-bit step, wrapping, as a zigzag varint: 1 byte up to +-63, at most 3
+void putDelta(std::vector<uint8_t>& out, uint16_t cur, uint16_t prev) {
+    // in unsigned arithmetic: the sign bit spread to all ones, no shift of a negative value
+    uint16_t d = (uint16_t)(cur - prev);
+    uint32_t z = (uint16_t)(((uint32_t)d << 1) ^ (0u - (d >> 15)));
+    while (z >= 0x80) {
+        out.push_back((uint8_t)(z | 0x80));
+        z >>= 7;
+    }
+    out.push_back((uint8_t)z);
+}
+
+void unpackOctNormal(uint32_t packed, float* n) {
+    float x = (float)(int16_t)(packed & 0xffff) / 32767.0f, y = (float)(int16_t)(packed >> 16) / 32767.0f;
+    float z = 1.0f - fabs(x) - fabs(y);
+    if (z < 0.0f) {
+        float px = x;
+        x = (1.0f - fabs(y)) * (px >= 0.0f ? 1.0f : -1.0f);
+        y = (1.0f - fabs(px)) * (y >= 0.0f ? 1.0f : -1.0f);
+    }
+    float len = sqrtf(x * x + y * y + z * z);
+    n[0] = x / len; n[1] = y / len; n[2] = z / len;
+}
+
+// work split for the pool: enough chunks to balance, few enough that each is worth a task
+int chunkCount(int vertices, ThreadPool& pool) {
+    return std::max(1, std::min(pool.size() * 4, vertices / 4096));
+}
+
+void chunkRange(int vertices, int chunks, int c, int& begin, int& end) {
+    begin = (int)((long long)vertices * c / chunks);
+    end = (int)((long long)vertices * (c + 1) / chunks);
+}
+
+void positionBounds(const std::vector<float>& v, int vertices, ThreadPool& pool, float* lo, float* hi) {
+    int chunks = chunkCount(vertices, pool);
+    std::vector<float> part((size_t)chunks * 6);
+    pool.parallelFor(chunks, 1, [&](int c0, int c1) {
+        for (int c = c0; c < c1; ++c) {
+            float* b = &part[(size_t)c * 6];
+            b[0] = b[1] = b[2] = INFINITY;
+            b[3] = b[4] = b[5] = -INFINITY;
+            int begin, end;
+            chunkRange(vertices, chunks, c, begin, end);
+            for (int i = begin; i < end; ++i)
+                for (int k = 0; k < 3; ++k) {
+                    float p = v[(size_t)i * kVertexFloats + k];
+                    b[k] = std::min(b[k], p); b[3 + k] = std::max(b[3 + k], p);
+                }
+        }
+    });
+    for (int k = 0; k < 3; ++k) { lo[k] = INFINITY; hi[k] = -INFINITY; }
+    for (int c = 0; c < chunks; ++c)
+        for (int k = 0; k < 3; ++k) {
+            lo[k] = std::min(lo[k], part[(size_t)c * 6 + k]);
+            hi[k] = std::max(hi[k], part[(size_t)c * 6 + 3 + k]);
+        }
+}
+
+struct FrameEncoder {
+    int vertices = 0;
+    std::vector<float> verts;                   // interleaved, from sculptureVertices
+    std::vector<uint16_t> q, prev;              // kQuantComponents arrays of `vertices`
+    std::vector<char> raw;                      // float and key payloads
+    std::vector<std::vector<uint8_t>> pieces;   // delta payload, component-major then chunk
+    float bmin[3] = { 0, 0, 0 }, bmax[3] = { 0, 0, 0 };
+    int lastKey = -1;
+};
+
+// quantizes every vertex against enc.bmin/bmax; false if a position fell outside them
+bool quantizeFrame(FrameEncoder& enc, ThreadPool& pool) {
+    int n = enc.vertices, chunks = chunkCount(n, pool);
+    float scale[3];
+    for (int k = 0; k < 3; ++k) scale[k] = enc.bmax[k] > enc.bmin[k] ? 65535.0f / (enc.bmax[k] - enc.bmin[k]) : 0.0f;
+    std::vector<char> outside(chunks, 0);
+    pool.parallelFor(chunks, 1, [&](int c0, int c1) {
+        for (int c = c0; c < c1; ++c) {
+            int begin, end;
+            chunkRange(n, chunks, c, begin, end);
+            for (int i = begin; i < end; ++i) {
+                const float* p = &enc.verts[(size_t)i * kVertexFloats];
+                for (int k = 0; k < 3; ++k) {
+                    if (p[k] < enc.bmin[k] || p[k] > enc.bmax[k]) outside[c] = 1;
+                    enc.q[(size_t)k * n + i] = quantize(p[k], enc.bmin[k], scale[k]);
+                }
+                uint32_t normal = packOctNormal(p[3], p[4], p[5]);
+                enc.q[(size_t)3 * n + i] = (uint16_t)(normal & 0xffff);
+                enc.q[(size_t)4 * n + i] = (uint16_t)(normal >> 16);
+            }
+        }
+    });
+    return std::find(outside.begin(), outside.end(), 1) == outside.end();
+}
+
+// fills the payload for one frame; returns whether it is a key
+bool encodeFrame(FrameEncoder& enc, const SequenceSettings& s, int frame, ThreadPool& pool) {
+    int n = enc.vertices;
+    if (!s.quantize) {
+        enc.raw.resize((size_t)n * 6 * sizeof(float));
+        float* out = (float*)enc.raw.data();
+        int chunks = chunkCount(n, pool);
+        pool.parallelFor(chunks, 1, [&](int c0, int c1) {
+            for (int c = c0; c < c1; ++c) {
+                int begin, end;
+                chunkRange(n, chunks, c, begin, end);
+                for (int i = begin; i < end; ++i)
+                    for (int k = 0; k < 6; ++k) out[(size_t)k * n + i] = enc.verts[(size_t)i * kVertexFloats + k];
+            }
+        });
+        positionBounds(enc.verts, n, pool, enc.bmin, enc.bmax);
+        return true;
+    }
+
+    bool key = !s.delta || enc.lastKey < 0 || frame - enc.lastKey >= s.keyInterval;
+    if (!key) key = !quantizeFrame(enc, pool);       // left the key's bounds: this frame starts a new key
+    if (key) {
+        positionBounds(enc.verts, n, pool, enc.bmin, enc.bmax);
+        if (s.delta) {
+            for (int k = 0; k < 3; ++k) {
+                float pad = (enc.bmax[k] - enc.bmin[k]) * kKeyPadding;
+                enc.bmin[k] -= pad; enc.bmax[k] += pad;
+            }
+        }
+        quantizeFrame(enc, pool);
+        enc.raw.resize((size_t)n * (3 * sizeof(uint16_t) + sizeof(uint32_t)));
+        memcpy(enc.raw.data(), enc.q.data(), (size_t)n * 3 * sizeof(uint16_t));
+        uint32_t* normals = (uint32_t*)(enc.raw.data() + (size_t)n * 3 * sizeof(uint16_t));
+        for (int i = 0; i < n; ++i) normals[i] = enc.q[(size_t)3 * n + i] | (uint32_t)enc.q[(size_t)4 * n + i] << 16;
+        enc.lastKey = frame;
+    } else {
+        int chunks = chunkCount(n, pool);
+        enc.pieces.resize((size_t)kQuantComponents * chunks);
+        pool.parallelFor(kQuantComponents * chunks, 1, [&](int t0, int t1) {
+            for (int t = t0; t < t1; ++t) {
+                int comp = t / chunks, begin, end;
+                chunkRange(n, chunks, t % chunks, begin, end);
+                std::vector<uint8_t>& out = enc.pieces[t];
+                out.clear();
+                const uint16_t* cur = &enc.q[(size_t)comp * n];
+                const uint16_t* prev = &enc.prev[(size_t)comp * n];
+                for (int i = begin; i < end; ++i) putDelta(out, cur[i], prev[i]);
+            }
+        });
+    }
+    enc.prev.swap(enc.q);
+    return key;
+}
+
+bool endsWith(const std::string& s, const char* suffix) {
+    size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+} // namespace
+
+bool openAsyncWriter(AsyncFileWriter& w, const std::string& path, size_t blockBytes, int blocks) {
+    w.fd = -1;
+    w.direct = false;
+#ifdef O_DIRECT
+    // tmpfs and some network filesystems refuse it: those get the page cache
+    w.fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    w.direct = w.fd >= 0;
+#endif
+    if (w.fd < 0) w.fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (w.fd < 0) return false;
+    w.blockBytes = (std::max(blockBytes, kPage) + kPage - 1) / kPage * kPage;
+    for (int i = 0; i < std::max(blocks, 2); ++i) {
+        char* b = (char*)aligned_alloc(kPage, w.blockBytes);
+        if (!b) break;
+        w.blocks.push_back(b);
+        w.free.push_back(b);
+    }
+    if (w.blocks.size() < 2) {
+        closeAsyncWriter(w);
+        return false;
+    }
+    w.current = w.free.back();
+    w.free.pop_back();
+    w.thread = std::thread(writerLoop, &w);
+    return true;
+}
+
+void writeAsync(AsyncFileWriter& w, const void* data, size_t bytes) {
+    const char* src = (const char*)data;
+    while (bytes > 0) {
+        size_t n = std::min(bytes, w.blockBytes - w.used);
+        memcpy(w.current + w.used, src, n);
+        w.used += n; src += n; bytes -= n;
+        if (w.used == w.blockBytes) submitBlock(w);
+    }
+}
+
+bool closeAsyncWriter(AsyncFileWriter& w) {
+    if (w.thread.joinable()) {
+        if (w.used > 0) submitBlock(w);
+        {
+            std::lock_guard<std::mutex> lock(w.mtx);
+            w.quit = true;
+        }
+        w.wake.notify_all();
+        w.thread.join();
+    }
+    bool ok = !w.failed;
+    if (w.fd >= 0 && w.direct && ftruncate(w.fd, (off_t)w.bytes) != 0) ok = false;   // drop the tail padding
+    if (w.fd >= 0 && ::close(w.fd) != 0) ok = false;
+    w.fd = -1;
+    for (char* b : w.blocks) free(b);
+    w.blocks.clear(); w.free.clear(); w.full.clear();
+    w.current = nullptr;
+    return ok;
+}
+
+bool exportSequence(const SequenceSettings& in, ThreadPool& pool, ExportStats* stats) {
+    SequenceSettings s = in;
+    s.rows = std::max(s.rows, 2);
+    s.cols = std::max(s.cols, 3);
+    s.frames = std::max(s.frames, 1);
+    s.keyInterval = std::max(s.keyInterval, 1);
+    if (s.fps <= 0.0f) s.fps = 60.0f;
+    if (s.delta) s.quantize = true;
+
+    AsyncFileWriter w;
+    if (!openAsyncWriter(w, s.path)) {
+        fprintf(stderr, "can't create %s\n", s.path.c_str());
+        return false;
+    }
+    ExportStats st;
+    double start = seconds();
+
+    FrameEncoder enc;
+    enc.vertices = s.rows * s.cols;
+    if (s.quantize) {
+        enc.q.resize((size_t)kQuantComponents * enc.vertices);
+        enc.prev.resize(enc.q.size());
+    }
+    double t0 = seconds();
+    sculptureVertices(enc.verts, s.rows, s.cols, s.startTime, nullptr, s.shape, GeometryKernel::Simd, &pool);
+    std::vector<unsigned int> idx;
+    sculptureIndices(idx, s.rows, s.cols, &pool);
+    st.generateS += seconds() - t0;
+
+    SequenceHeader h;
+    h.rows = s.rows; h.cols = s.cols;
+    h.vertexCount = (uint32_t)enc.vertices;
+    h.indexCount = (uint32_t)idx.size();
+    h.frameCount = (uint32_t)s.frames;
+    h.flags = (s.quantize ? kSequenceQuantized : 0) | (s.delta ? kSequenceDelta : 0);
+    h.startTime = s.startTime;
+    h.frameTime = 1.0f / s.fps;
+    h.keyInterval = s.delta ? (uint32_t)s.keyInterval : 1;
+    writeAsync(w, &h, sizeof(h));
+    writeAsync(w, idx.data(), idx.size() * sizeof(unsigned int));
+    std::vector<float> uv((size_t)enc.vertices * 2);
+    for (int i = 0; i < enc.vertices; ++i) {
+        uv[(size_t)i * 2] = enc.verts[(size_t)i * kVertexFloats + 6];
+        uv[(size_t)i * 2 + 1] = enc.verts[(size_t)i * kVertexFloats + 7];
+    }
+    writeAsync(w, uv.data(), uv.size() * sizeof(float));
+
+    for (int f = 0; f < s.frames; ++f) {
+        if (f > 0) {
+            t0 = seconds();
+            sculptureVertices(enc.verts, s.rows, s.cols, s.startTime + f * h.frameTime, nullptr, s.shape,
+                              GeometryKernel::Simd, &pool);
+            st.generateS += seconds() - t0;
+        }
+        t0 = seconds();
+        bool key = encodeFrame(enc, s, f, pool);
+        st.encodeS += seconds() - t0;
+
+        SequenceFrameHeader fh;
+        fh.index = (uint32_t)f;
+        fh.key = key ? 1 : 0;
+        if (key) {
+            fh.payloadBytes = enc.raw.size();
+        } else {
+            for (const std::vector<uint8_t>& p : enc.pieces) fh.payloadBytes += p.size();
+        }
+        for (int k = 0; k < 3; ++k) { fh.bmin[k] = enc.bmin[k]; fh.bmax[k] = enc.bmax[k]; }
+        writeAsync(w, &fh, sizeof(fh));
+        if (key) writeAsync(w, enc.raw.data(), enc.raw.size());
+        else for (const std::vector<uint8_t>& p : enc.pieces) writeAsync(w, p.data(), p.size());
+        st.keys += key;
+        st.frames += 1;
+    }
+
+    bool ok = closeAsyncWriter(w);
+    if (!ok) fprintf(stderr, "writing %s failed\n", s.path.c_str());
+    st.bytes = w.bytes;
+    st.writeS = w.writeS;
+    st.stallS = w.stallS;
+    st.wallS = seconds() - start;
+    if (stats) *stats = st;
+    return ok;
+}
+
+bool decodeSequenceFrame(const SequenceHeader& h, const SequenceFrameHeader& f, const uint8_t* payload,
+                         std::vector<uint16_t>& quantized, std::vector<float>& posNormal) {
+    size_t n = h.vertexCount;
+    posNormal.resize(n * 6);
+    if (!(h.flags & kSequenceQuantized)) {
+        if (f.payloadBytes != n * 6 * sizeof(float)) return false;
+        const float* in = (const float*)payload;
+        for (size_t i = 0; i < n; ++i)
+            for (int k = 0; k < 6; ++k) posNormal[i * 6 + k] = in[k * n + i];
+        return true;
+    }
+
+    if (f.key) {
+        if (f.payloadBytes != n * (3 * sizeof(uint16_t) + sizeof(uint32_t))) return false;
+        quantized.resize(n * kQuantComponents);
+        memcpy(quantized.data(), payload, n * 3 * sizeof(uint16_t));
+        const uint32_t* normals = (const uint32_t*)(payload + n * 3 * sizeof(uint16_t));
+        for (size_t i = 0; i < n; ++i) {
+            quantized[3 * n + i] = (uint16_t)(normals[i] & 0xffff);
+            quantized[4 * n + i] = (uint16_t)(normals[i] >> 16);
+        }
+    } else {
+        if (quantized.size() != n * kQuantComponents) return false;        // no key before it
+        const uint8_t* p = payload, *endp = payload + f.payloadBytes;
+        for (size_t j = 0; j < n * kQuantComponents; ++j) {
+            uint32_t z = 0;
+            for (int shift = 0;; shift += 7) {
+                if (p == endp || shift > 14) return false;
+                uint8_t b = *p++;
+                z |= (uint32_t)(b & 0x7f) << shift;
+                if (!(b & 0x80)) break;
+            }
+            int16_t d = (int16_t)((z >> 1) ^ (0u - (z & 1)));
+            quantized[j] = (uint16_t)(quantized[j] + d);
+        }
+        if (p != endp) return false;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        for (int k = 0; k < 3; ++k)
+            posNormal[i * 6 + k] = f.bmin[k] + quantized[k * n + i] * ((f.bmax[k] - f.bmin[k]) / 65535.0f);
+        unpackOctNormal(quantized[3 * n + i] | (uint32_t)quantized[4 * n + i] << 16, &posNormal[i * 6 + 3]);
+    }
+    return true;
+}
+
+bool exportGltf(const std::string& path, int rows, int cols, float t, const SculptureShape& shape, ThreadPool& pool) {
+    rows = std::max(rows, 2);
+    cols = std::max(cols, 3);
+    std::vector<float> v;
+    std::vector<unsigned int> idx;
+    sculptureVertices(v, rows, cols, t, nullptr, shape, GeometryKernel::Simd, &pool);
+    sculptureIndices(idx, rows, cols, &pool);
+    size_t n = (size_t)rows * cols;
+
+    // non-interleaved views: positions, normals, texcoords, indices; all 4-byte aligned
+    std::vector<char> bin(n * 8 * sizeof(float) + idx.size() * sizeof(unsigned int));
+    float* pos = (float*)bin.data();
+    float* nrm = pos + n * 3;
+    float* tex = nrm + n * 3;
+    float lo[3] = { INFINITY, INFINITY, INFINITY }, hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+    for (size_t i = 0; i < n; ++i) {
+        const float* src = &v[i * kVertexFloats];
+        for (int k = 0; k < 3; ++k) {
+            pos[i * 3 + k] = src[k];
+            nrm[i * 3 + k] = src[3 + k];
+            lo[k] = std::min(lo[k], src[k]); hi[k] = std::max(hi[k], src[k]);
+        }
+        tex[i * 2] = src[6]; tex[i * 2 + 1] = src[7];
+    }
+    memcpy(tex + n * 2, idx.data(), idx.size() * sizeof(unsigned int));
+
+    bool glb = endsWith(path, ".glb");
+    // beside the file: only a dot in the last path component starts the extension
+    size_t slash = path.rfind('/'), dot = path.rfind('.');
+    bool hasExt = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+    std::string binPath = (hasExt ? path.substr(0, dot) : path) + ".bin";
+    std::string binUri = binPath.substr(slash == std::string::npos ? 0 : slash + 1);
+    size_t vec3Bytes = n * 3 * sizeof(float), vec2Bytes = n * 2 * sizeof(float);
+    std::ostringstream js;
+    js.precision(9);            // the accessor bounds must hold the floats exactly
+    js << "{\"asset\":{\"version\":\"2.0\",\"generator\":\"kinetic sculpture mesh_export\"},"
+       << "\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0,\"name\":\"sculpture\"}],"
+       << "\"meshes\":[{\"name\":\"sculpture\",\"extras\":{\"time\":" << t << ",\"rows\":" << rows << ",\"cols\":" << cols << "},"
+       << "\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3,\"mode\":4}]}],"
+       << "\"buffers\":[{\"byteLength\":" << bin.size() << (glb ? "" : ",\"uri\":\"" + binUri + "\"") << "}],"
+       << "\"bufferViews\":["
+       << "{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" << vec3Bytes << ",\"target\":34962},"
+       << "{\"buffer\":0,\"byteOffset\":" << vec3Bytes << ",\"byteLength\":" << vec3Bytes << ",\"target\":34962},"
+       << "{\"buffer\":0,\"byteOffset\":" << 2 * vec3Bytes << ",\"byteLength\":" << vec2Bytes << ",\"target\":34962},"
+       << "{\"buffer\":0,\"byteOffset\":" << 2 * vec3Bytes + vec2Bytes << ",\"byteLength\":" << idx.size() * sizeof(unsigned int)
+       << ",\"target\":34963}],"
+       << "\"accessors\":["
+       << "{\"bufferView\":0,\"componentType\":5126,\"count\":" << n << ",\"type\":\"VEC3\",\"min\":[" << lo[0] << "," << lo[1]
+       << "," << lo[2] << "],\"max\":[" << hi[0] << "," << hi[1] << "," << hi[2] << "]},"
+       << "{\"bufferView\":1,\"componentType\":5126,\"count\":" << n << ",\"type\":\"VEC3\"},"
+       << "{\"bufferView\":2,\"componentType\":5126,\"count\":" << n << ",\"type\":\"VEC2\"},"
+       << "{\"bufferView\":3,\"componentType\":5125,\"count\":" << idx.size() << ",\"type\":\"SCALAR\"}]}";
+    std::string json = js.str();
+
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        fprintf(stderr, "can't create %s\n", path.c_str());
+        return false;
+    }
+    bool ok = true;
+    if (glb) {
+        // 12-byte header, then the JSON chunk padded with spaces and the BIN chunk, both to 4 bytes
+        while (json.size() % 4) json += ' ';
+        uint32_t jsonLen = (uint32_t)json.size(), binLen = (uint32_t)bin.size();
+        uint32_t header[3] = { 0x46546c67, 2, 12 + 8 + jsonLen + 8 + binLen };
+        uint32_t jsonChunk[2] = { jsonLen, 0x4e4f534a }, binChunk[2] = { binLen, 0x004e4942 };
+        ok = fwrite(header, sizeof(header), 1, f) == 1 && fwrite(jsonChunk, sizeof(jsonChunk), 1, f) == 1
+          && fwrite(json.data(), 1, json.size(), f) == json.size() && fwrite(binChunk, sizeof(binChunk), 1, f) == 1
+          && fwrite(bin.data(), 1, bin.size(), f) == bin.size();
+    } else {
+        ok = fwrite(json.data(), 1, json.size(), f) == json.size();
+        FILE* b = fopen(binPath.c_str(), "wb");
+        ok = ok && b && fwrite(bin.data(), 1, bin.size(), b) == bin.size();
+        if (b && fclose(b) != 0) ok = false;
+    }
+    if (fclose(f) != 0) ok = false;
+    if (!ok) fprintf(stderr, "writing %s failed\n", path.c_str());
+    return ok;
+}
@@ -0,0 +1,102 @@
+#pragma once
+// === mesh export: the sculpture over time as a streaming binary sequence, one frame as glTF ===
+// No GL: the frames come from sculptureVertices(), exactly what makeSculpture() uploads.
+//
+// Sequence (.kseq): the header below, then the topology once (u32 triangle indices, then f32 u, v per
+// vertex), then one record per frame: a SequenceFrameHeader and its payload. Little-endian throughout.
+// Payloads are structure-of-arrays over the vertices:
+//   float        f32 x, y, z for every vertex, then f32 nx, ny, nz                          24 B/vertex
+//   quantized    u16 x, y, z within the frame's bounds, then u32 octahedral normals (2x snorm16)  10 B/vertex
+//   delta        key frames as quantized; between them the same quantized values as differences
+//                from the previous frame, zigzag LEB128 varints, positions then normal halves. The key's
+//                bounds hold until the next key, and a frame that leaves them becomes a key itself.
+// A reader can start at any key frame. Records are back to back, so a file can be read as it's written.
+//
+// Writing goes through AsyncFileWriter: page-aligned blocks filled by the encoder and written in order
+// by a background thread, so generation, encoding and I/O overlap.
+#include "sculpture_geometry.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ThreadPool;
+
+const uint32_t kSequenceMagic = 0x5145534b;     // "KSEQ"
+const uint32_t kSequenceVersion = 1;
+const uint32_t kSequenceQuantized = 1, kSequenceDelta = 2;
+
+struct SequenceHeader {
+    uint32_t magic = kSequenceMagic, version = kSequenceVersion;
+    int32_t rows = 0, cols = 0;
+    uint32_t vertexCount = 0, indexCount = 0, frameCount = 0;
+    uint32_t flags = 0;                          // kSequenceQuantized | kSequenceDelta
+    float startTime = 0.0f, frameTime = 0.0f;    // frame i is the sculpture at startTime + i * frameTime
+    uint32_t keyInterval = 0;                    // delta: at most this many frames between keys
+    uint32_t reserved = 0;
+};
+
+struct SequenceFrameHeader {
+    uint32_t index = 0;
+    uint32_t key = 0;                            // 1: decodable on its own
+    uint64_t payloadBytes = 0;
+    float bmin[3] = { 0, 0, 0 }, bmax[3] = { 0, 0, 0 };  // quantization bounds (positions' bounds otherwise)
+};
+
+struct SequenceSettings {
+    std::string path;
+    int rows = 140, cols = 180;
+    SculptureShape shape;
+    float startTime = 0.0f, fps = 60.0f;
+    int frames = 60;
+    bool quantize = false, delta = false;        // delta implies quantize
+    int keyInterval = 60;
+};
+
+struct ExportStats {
+    uint64_t bytes = 0;
+    int frames = 0, keys = 0;
+    double wallS = 0.0;
+    double generateS = 0.0, encodeS = 0.0;       // on the calling thread (and the pool under it)
+    double writeS = 0.0;                         // inside write() on the writer thread
+    double stallS = 0.0;                         // encoder waiting for a free block: the disk is the limit
+};
+
+struct AsyncFileWriter {
+    int fd = -1;
+    size_t blockBytes = 0;
+    std::vector<char*> blocks;                   // page-aligned
+    char* current = nullptr;
+    size_t used = 0;
+    bool failed = false;
+    bool direct = false;                         // O_DIRECT: the page cache is bypassed
+    uint64_t bytes = 0;
+    double writeS = 0.0, stallS = 0.0;
+
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::vector<std::pair<char*, size_t>> full; // in file order
+    std::vector<char*> free;
+    bool quit = false;
+    std::thread thread;
+};
+
+// blocks of blockBytes (rounded up to pages), written with O_DIRECT where the filesystem takes it and
+// through the page cache otherwise; false if the file can't be created
+bool openAsyncWriter(AsyncFileWriter& w, const std::string& path, size_t blockBytes = 8u << 20, int blocks = 4);
+void writeAsync(AsyncFileWriter& w, const void* data, size_t bytes);
+// writes what's left, joins the thread and closes; false if any write failed
+bool closeAsyncWriter(AsyncFileWriter& w);
+
+bool exportSequence(const SequenceSettings& s, ThreadPool& pool, ExportStats* stats = nullptr);
+// one frame: .glb for a single binary file, anything else as .gltf JSON plus a .bin beside it
+bool exportGltf(const std::string& path, int rows, int cols, float t, const SculptureShape& shape, ThreadPool& pool);
+
+// for readers: the frame's vertices (pos, normal) as floats, given the previous frame's decoded
+// quantized state for delta frames; quantized holds 3 u16 + 2 u16 per vertex between calls
+bool decodeSequenceFrame(const SequenceHeader& h, const SequenceFrameHeader& f, const uint8_t* payload,
+                         std::vector<uint16_t>& quantized, std::vector<float>& posNormal);
@@ -4,12 +4,38 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "frame_stats.h"
+#include "gallery_stream.h"
+#include "gl_capture.h"
+#include "gl_resources.h"
+#include "grid_topology.h"
+#include "hud.h"
+#include "lights.h"
+#include "lighttree.h"
+#include "memory_registry.h"
+#include "mesh_export.h"
+#include "perf_counters.h"
+#include "probes.h"
+#include "scene_config.h"
+#include "sculpture_geometry.h"
+#include "sculpture_stream.h"
+#include "shlighting.h"
+#include "soak.h"
+#include "softbody.h"
+#include "telemetry.h"
+#include "thread_pool.h"
+#include "vertex_stream.h"
+#include "wavefield.h"
 
 // === utility: load/compile/link shaders (single-file, no external Shader class) ===
 static std::string readTextFile(const std::string& path) {
@@ -18,6 +44,7 @@ static std::string readTextFile(const std::string& path) {
     return ss.str();
 }
 static GLuint compile(GLenum type, const std::string& src) {
+    double t0 = PROBE_ENABLED(shader_compile) ? processMs() : 0.0;
     GLuint s = glCreateShader(type);
     const char* c = src.c_str();
     glShaderSource(s, 1, &c, nullptr);
@@ -28,9 +55,12 @@ static GLuint compile(GLenum type, const std::string& src) {
         std::string log(len, '\0'); glGetShaderInfoLog(s, len, nullptr, log.data());
         std::cerr << "Shader compile error:\n" << log << std::endl;
     }
+    if (PROBE_ENABLED(shader_compile))
+        PROBE4(shader_compile, (int)type, (long long)src.size(), (long long)((processMs() - t0) * 1e3), (int)ok);
     return s;
 }
 static GLuint link(GLuint vs, GLuint fs) {
+    double t0 = PROBE_ENABLED(shader_compile) ? processMs() : 0.0;
     GLuint p = glCreateProgram();
     glAttachShader(p, vs); glAttachShader(p, fs);
     glLinkProgram(p);
@@ -42,133 +72,1247 @@ static GLuint link(GLuint vs, GLuint fs) {
     }
     glDetachShader(p, vs); glDetachShader(p, fs);
     glDeleteShader(vs); glDeleteShader(fs);
+    if (PROBE_ENABLED(shader_compile)) PROBE4(shader_compile, 0, 0LL, (long long)((processMs() - t0) * 1e3), (int)ok);
+    trackProgram(p);
     return p;
 }
+static void deleteProgram(GLuint p) {
+    untrackGpu(GpuObject::Program, p);
+    glDeleteProgram(p);
+}
+
+// #defines have to follow the #version line; `defines` is "#define X 1\n..."
+static std::string withDefines(const std::string& src, const std::string& defines) {
+    size_t eol = src.find('\n');
+    if (defines.empty() || eol == std::string::npos) return src;
+    return src.substr(0, eol + 1) + defines + src.substr(eol + 1);
+}
 
 // === camera minimal (orbit) ===
-static float g_time = 0.f;
-glm::mat4 makeView() {
-    float radius = 6.5f;
-    float camX = sin(g_time * 0.3f) * radius;
-    float camZ = cos(g_time * 0.3f) * radius;
-    glm::vec3 pos(camX, 3.0f, camZ);
+// the timeline in seconds. It never goes to float itself: each animation reduces its own phase (phaseAt)
+// first, so a run of months moves as smoothly as the first minute.
+static double g_time = 0.0;
+static SceneConfig g_scene;      // --scene / --set; the original scene by default
+static float g_camRadius = 6.5f; // the scene's, pulled back when several sculptures are drawn
+static PerfCounters g_perf;      // --perf-counters; phases are no-ops while it isn't open
+static GeometryKernel g_kernel = GeometryKernel::Simd;  // --kernel; all three build the same mesh
+// --gallery: walk a slow Lissajous path through the world at eye height instead of orbiting
+static bool g_walk = false;
+static glm::vec2 g_walkCenter(0.0f), g_walkHalf(0.0f);
+// t * speed + offset reduced to [0, 2pi) in double, then the angle as a float
+static float phaseAt(double t, double speed, double offset = 0.0) {
+    return (float)fmod(t * speed + offset, glm::two_pi<double>());
+}
+// the camera at any time, so the streamer can look ahead along it
+glm::mat4 makeViewAt(double t) {
+    if (g_walk) {
+        const float fx = 0.011f, fz = 0.017f;
+        float ax = phaseAt(t, fx), az = phaseAt(t, fz, 0.7f);
+        glm::vec3 pos(g_walkCenter.x + g_walkHalf.x * sin(ax), 1.7f, g_walkCenter.y + g_walkHalf.y * sin(az));
+        glm::vec3 dir(g_walkHalf.x * fx * cos(ax), 0.0f, g_walkHalf.y * fz * cos(az));
+        dir = glm::length(dir) > 1e-4f ? glm::normalize(dir) : glm::vec3(1, 0, 0);
+        return glm::lookAt(pos, pos + dir + glm::vec3(0, -0.1f, 0), glm::vec3(0, 1, 0));
+    }
+    float radius = g_camRadius;
+    float camX = sin(phaseAt(t, g_scene.camSpeed)) * radius;
+    float camZ = cos(phaseAt(t, g_scene.camSpeed)) * radius;
+    glm::vec3 pos(camX, g_scene.camHeight, camZ);
     return glm::lookAt(pos, glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
 }
+glm::mat4 makeView() { return makeViewAt(g_time); }
+// far enough back that a grid of `instances` sculptures stays in view
+float cameraRadius(int instances) {
+    float r = g_scene.camRadius * (float)ceil(sqrt((double)instances)) * 0.5f;
+    return r < g_scene.camRadius ? g_scene.camRadius : r;
+}
 
 // === mesh: parametric "revolve + wave" kinetic sculpture ===
 // base curve (superellipse-ish) in XZ, then revolve along Y; animate radius over time
+// owns its GL objects: assigning a new mesh returns the old buffers to the pool they came from.
+// The indices are shared with every other mesh of the same grid (grid_topology.h).
 struct Mesh {
-    GLuint vao = 0, vbo = 0, ebo = 0;
-    GLsizei indexCount = 0;
+    GlVertexArray vao;
+    PooledBuffer vbo;
+    GridTopologyRef topology;
+    GLenum mode = GL_TRIANGLES;
+    GLsizei indexCount = 0, triangles = 0;
+    int rows = 0, cols = 0;
+    glm::vec3 bmin = glm::vec3(0.0f), bmax = glm::vec3(0.0f); // stays valid under the model's Y spin
 };
-Mesh makeSculpture(int rowRings = 140, int colSegments = 180) {
-    std::vector<float> v; v.reserve(rowRings * colSegments * 8);
-    std::vector<unsigned int> idx; idx.reserve((rowRings - 1) * colSegments * 6);
+// grows [bmin, bmax] to hold the vertices at any rotation about Y
+static void spinBounds(const std::vector<float>& v, glm::vec3& bmin, glm::vec3& bmax) {
+    for (size_t i = 0; i + 8 <= v.size(); i += 8) {
+        float r = sqrtf(v[i] * v[i] + v[i + 2] * v[i + 2]);
+        bmin = glm::min(bmin, glm::vec3(-r, v[i + 1], -r));
+        bmax = glm::max(bmax, glm::vec3(r, v[i + 1], r));
+    }
+}
 
-    auto toIndex = [colSegments](int r, int c) {
-        int C = (c + colSegments) % colSegments;
-        return r * colSegments + C;
-        };
+// pos/normal/tex pointers into vbo for the bound VAO
+static void sculptureAttribs(GLuint vbo) {
+    GLsizei stride = 8 * sizeof(float);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableVertexAttribArray(0); glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glEnableVertexAttribArray(1); glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(2); glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+}
 
-    // generate vertices (pos, normal, tex)
-    for (int r = 0; r < rowRings; ++r) {
-        float vParam = (float)r / (rowRings - 1);        // 0..1 along Y
-        float y = (vParam - 0.5f) * 3.0f;              // height
-        for (int c = 0; c < colSegments; ++c) {
-            float uParam = (float)c / colSegments;     // 0..1 around
-            float theta = uParam * glm::two_pi<float>();
+Mesh makeSculpture(BufferPool& buffers, IndexLayout layout, int rowRings = 140, int colSegments = 180,
+                   const float* wave = nullptr, ThreadPool* pool = nullptr) {
+    int phaseVerts = perfPhase(g_perf, "sculpture-vertices"), phaseIdx = perfPhase(g_perf, "sculpture-indices");
+    int phaseUpload = perfPhase(g_perf, "sculpture-upload");
+    double t0 = PROBE_ENABLED(mesh_regen) ? processMs() : 0.0;
+    std::vector<float> v;
+    beginPerfPhase(g_perf, phaseVerts);
+    sculptureVertices(v, rowRings, colSegments, g_time, wave, g_scene.shape, g_kernel, pool);
+    endPerfPhase(g_perf, phaseVerts);
+    Mesh m;
+    // built and uploaded only the first time this grid is asked for
+    uint64_t uploads = topologyStats().uploads;
+    beginPerfPhase(g_perf, phaseIdx);
+    m.topology = acquireGridTopology(rowRings, colSegments, layout, pool);
+    endPerfPhase(g_perf, phaseIdx);
 
-            // time-varying radius: base superellipse + travelling wave
-            float a = 1.0f, b = 0.5f;                    // superellipse radii
-            float n = 2.5f;                             // superellipse exponent
-            // superellipse in 2D (r0 around y-axis)
-            float cx = powf(fabs(cos(theta)), 2 / n) * a * (cos(theta) >= 0 ? 1 : -1);
-            float cz = powf(fabs(sin(theta)), 2 / n) * b * (sin(theta) >= 0 ? 1 : -1);
-            float r0 = sqrtf(cx * cx + cz * cz);
+    // the array only lives until the upload, but it sets the CPU peak
+    trackCpu(&v, MemTag::Scratch, v.size() * sizeof(float));
 
-            float wave = 0.25f * sin(6.0f * uParam * glm::two_pi<float>() - 4.0f * vParam * glm::two_pi<float>() + g_time * 1.5f);
-            float radius = r0 * (1.0f + wave);
+    beginPerfPhase(g_perf, phaseUpload);
+    m.vao = genVertexArray();
+    // a resolution seen before gets its storage back from the pool; only the contents are uploaded
+    m.vbo = acquireBuffer(buffers, v.size() * sizeof(float), MemTag::Sculpture, GL_DYNAMIC_DRAW);
+    glBindVertexArray(m.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, v.size() * sizeof(float), v.data());
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m.topology->ebo);
+    sculptureAttribs(m.vbo);
+    glBindVertexArray(0);
+    endPerfPhase(g_perf, phaseUpload);
+    untrackCpu(&v);
+    if (PROBE_ENABLED(mesh_regen))
+        PROBE4(mesh_regen, rowRings, colSegments,
+               (long long)(v.size() * sizeof(float) + (topologyStats().uploads != uploads ? m.topology->bytes : 0)),
+               (long long)((processMs() - t0) * 1e3));
 
-            float x = radius * cos(theta);
-            float z = radius * sin(theta);
+    m.mode = m.topology->mode;
+    m.indexCount = m.topology->indexCount;
+    m.triangles = m.topology->triangles;
+    m.rows = rowRings; m.cols = colSegments;
+    spinBounds(v, m.bmin, m.bmax);
+    return m;
+}
 
-            // approximate normal via partial derivatives in parametric form
-            // For visual quality we can normalize (x,z) in the horizontal plane:
-            glm::vec3 tTheta(-radius * sin(theta), 0.0f, radius * cos(theta));
-            glm::vec3 tY(0.0f, 1.0f, 0.0f);
-            glm::vec3 nrm = glm::normalize(glm::cross(tTheta, tY)); // outward approx
+// === morph targets: several sculpture shapes packed in one texture buffer, blended in sculpture.vs ===
+// per vertex per target one RGBA32UI texel: position bits + octahedral normal (2x snorm16) -> 16 bytes.
+// Targets are stored without their travelling wave, which sculpture.vs adds back from the block below, so the
+// wave keeps moving and a wave field displaces the blend only once.
+// The CPU only refreshes the small weight block each frame, independent of the vertex count.
+const int kMaxMorphTargets = 16; // must match sculpture.vs
 
-            v.insert(v.end(), { x, y, z,  nrm.x, nrm.y, nrm.z,  uParam, vParam });
-        }
+// std140 as sculpture.vs declares it: ivec4 info (x = target count, y = vertices per target),
+// vec4 weights[kMaxMorphTargets / 4], vec4 wave[kMaxMorphTargets] (amplitude, u and v frequency, phase)
+struct MorphBlock {
+    GLint info[4];
+    float w[kMaxMorphTargets];
+    float wave[kMaxMorphTargets][4];
+};
+
+struct MorphTargets {
+    GlBuffer buffer, ubo;
+    GlTexture texture;
+    int count = 0, vertexCount = 0;
+    glm::vec3 bmin = glm::vec3(0.0f), bmax = glm::vec3(0.0f); // union over all targets
+    float wave[kMaxMorphTargets][4] = {};   // per target: amplitude, u and v frequency, speed (rad/s)
+};
+
+// eight looks the installation can blend between; index 0 is the original sculpture
+static std::vector<SculptureShape> defaultMorphShapes() {
+    std::vector<SculptureShape> s(8);
+    s[1].a = 0.8f; s[1].b = 0.8f; s[1].n = 2.0f; s[1].profile = Profile::Vase;
+    s[2].n = 4.0f; s[2].twist = glm::pi<float>(); s[2].waveAmp = 0.12f;
+    s[3].a = 0.9f; s[3].b = 0.7f; s[3].profile = Profile::Hourglass; s[3].waveU = 3.0f;
+    s[4].n = 1.2f; s[4].b = 0.9f; s[4].waveAmp = 0.3f; s[4].waveV = 2.0f;
+    s[5].profile = Profile::Bulb; s[5].a = 1.1f; s[5].b = 1.0f; s[5].waveU = 9.0f; s[5].waveAmp = 0.08f;
+    s[6].n = 6.0f; s[6].a = 0.7f; s[6].b = 0.7f; s[6].twist = glm::half_pi<float>(); s[6].profile = Profile::Vase;
+    s[7].a = 1.2f; s[7].b = 0.35f; s[7].waveU = 4.0f; s[7].waveV = 6.0f; s[7].waveAmp = 0.18f;
+    return s;
+}
+
+// cycles through the targets: hold one, then cross-fade to the next
+static void morphWeights(double t, int count, float* w) {
+    const double hold = 5.0, fade = 3.0;
+    for (int i = 0; i < kMaxMorphTargets; ++i) w[i] = 0.0f;
+    if (count <= 0) return;
+    double period = hold + fade;
+    int cur = (int)fmod(floor(t / period), (double)count);
+    float k = glm::clamp((float)((fmod(t, period) - hold) / fade), 0.0f, 1.0f);
+    k = k * k * (3.0f - 2.0f * k);
+    w[cur] += 1.0f - k;
+    w[(cur + 1) % count] += k;
+}
+
+// writes the weight block with each target's wave phase; returns how many targets the vertex shader will
+// actually fetch
+int updateMorphWeights(const MorphTargets& mt, double t) {
+    MorphBlock block = { { mt.count, mt.vertexCount, 0, 0 }, {}, {} };
+    morphWeights(t, mt.count, block.w);
+    for (int i = 0; i < mt.count; ++i) {
+        for (int k = 0; k < 3; ++k) block.wave[i][k] = mt.wave[i][k];
+        block.wave[i][3] = phaseAt(t, mt.wave[i][3]);
     }
-    for (int r = 0; r < rowRings - 1; ++r) {
-        for (int c = 0; c < colSegments; ++c) {
-            unsigned int i0 = toIndex(r, c);
-            unsigned int i1 = toIndex(r, c + 1);
-            unsigned int i2 = toIndex(r + 1, c);
-            unsigned int i3 = toIndex(r + 1, c + 1);
-            idx.insert(idx.end(), { i0,i2,i1,  i1,i2,i3 });
+    glBindBuffer(GL_UNIFORM_BUFFER, mt.ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    int active = 0;
+    for (int i = 0; i < mt.count; ++i) active += block.w[i] != 0.0f;
+    return active;
+}
+
+MorphTargets makeMorphTargets(const std::vector<SculptureShape>& shapes, int rowRings, int colSegments) {
+    MorphTargets mt;
+    mt.count = (int)shapes.size() < kMaxMorphTargets ? (int)shapes.size() : kMaxMorphTargets;
+    mt.vertexCount = rowRings * colSegments;
+
+    std::vector<unsigned int> packed((size_t)mt.count * mt.vertexCount * 4);
+    std::vector<float> v;
+    trackCpu(&packed, MemTag::Scratch, packed.size() * sizeof(unsigned int));
+    for (int t = 0; t < mt.count; ++t) {
+        const SculptureShape& s = shapes[t];
+        SculptureShape still = s;
+        still.waveAmp = 0.0f;
+        sculptureVertices(v, rowRings, colSegments, 0.0f, nullptr, still, g_kernel);
+        mt.wave[t][0] = s.waveAmp; mt.wave[t][1] = s.waveU; mt.wave[t][2] = s.waveV; mt.wave[t][3] = s.waveSpeed;
+        // the wave scales the radius by at most 1 + |amplitude|
+        glm::vec3 lo(0.0f), hi(0.0f), k(1.0f + fabsf(s.waveAmp), 1.0f, 1.0f + fabsf(s.waveAmp));
+        spinBounds(v, lo, hi);
+        mt.bmin = glm::min(mt.bmin, lo * k);
+        mt.bmax = glm::max(mt.bmax, hi * k);
+        unsigned int* out = &packed[(size_t)t * mt.vertexCount * 4];
+        for (int i = 0; i < mt.vertexCount; ++i) {
+            const float* src = &v[(size_t)i * 8];
+            memcpy(out + i * 4, src, 3 * sizeof(float));
+            out[i * 4 + 3] = packOctNormal(src[3], src[4], src[5]);
         }
     }
 
-    Mesh m;
-    glGenVertexArrays(1, &m.vao);
-    glGenBuffers(1, &m.vbo);
-    glGenBuffers(1, &m.ebo);
-    glBindVertexArray(m.vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size() * sizeof(float), v.data(), GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size() * sizeof(unsigned int), idx.data(), GL_STATIC_DRAW);
+    if (mt.count > 0) {
+        GLint maxTexels = 0; glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+        if ((size_t)mt.count * mt.vertexCount > (size_t)maxTexels)
+            std::cerr << "morph targets need " << (size_t)mt.count * mt.vertexCount << " texels, driver allows " << maxTexels << "\n";
 
-    GLsizei stride = 8 * sizeof(float);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(2); glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+        mt.buffer = genBuffer();
+        glBindBuffer(GL_TEXTURE_BUFFER, mt.buffer);
+        glBufferData(GL_TEXTURE_BUFFER, packed.size() * sizeof(unsigned int), packed.data(), GL_STATIC_DRAW);
+        mt.texture = genTexture();
+        glBindTexture(GL_TEXTURE_BUFFER, mt.texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32UI, mt.buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        trackGpu(GpuObject::Buffer, mt.buffer, MemTag::Morph, packed.size() * sizeof(unsigned int));
+    }
+    untrackCpu(&packed);
+
+    mt.ubo = genBuffer();
+    glBindBuffer(GL_UNIFORM_BUFFER, mt.ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(MorphBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    trackGpu(GpuObject::Buffer, mt.ubo, MemTag::Morph, sizeof(MorphBlock));
+    updateMorphWeights(mt, 0.0f);
+    return mt;
+}
+
+
+// === wave field on the GPU: ping-pong between three R32F targets (prev, cur, next) ===
+// one texel per sculpture vertex; sculpture.vs displaces the radius from whichever texture is current
+static GlTexture makeFieldTexture(int rows, int cols) {
+    GlTexture t = genTexture();
+    glBindTexture(GL_TEXTURE_2D, t);
+    std::vector<float> zero((size_t)rows * cols, 0.0f);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, cols, rows, 0, GL_RED, GL_FLOAT, zero.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    trackGpu(GpuObject::Texture, t, MemTag::WaveField, zero.size() * sizeof(float));
+    return t;
+}
+
+struct WaveFieldGpu {
+    GlProgram prog;
+    GlVertexArray vao;
+    GlFramebuffer fbo;
+    GlTexture tex[3];
+    int rows = 0, cols = 0;
+    int cur = 0;                 // tex[cur] holds the latest field
+};
+WaveFieldGpu makeWaveFieldGpu(int rows, int cols) {
+    WaveFieldGpu g;
+    g.rows = rows; g.cols = cols;
+    g.prog = GlProgram(link(
+        compile(GL_VERTEX_SHADER, readTextFile("wave_step.vs")),
+        compile(GL_FRAGMENT_SHADER, readTextFile("wave_step.fs"))
+    ));
+    g.vao = genVertexArray(); // core profile wants one bound even without attributes
+    g.fbo = genFramebuffer();
+    for (GlTexture& t : g.tex) t = makeFieldTexture(rows, cols);
+    return g;
+}
+void stepWaveFieldGpu(WaveFieldGpu& g, const WaveFieldSettings& s, float dt, double time) {
+    if (dt <= 0.0f) return;
+    int steps = waveSubsteps(g.rows, g.cols, s.speed, dt);
+    float dtSub = dt / steps;
+    float cu2, cv2, gamma;
+    waveCoefficients(g.rows, g.cols, s.speed, s.damping, dtSub, cu2, cv2, gamma);
+    int emitters = (int)s.emitters.size() < 8 ? (int)s.emitters.size() : 8;
+
+    glUseProgram(g.prog);
+    glUniform1i(glGetUniformLocation(g.prog, "uCur"), 0);
+    glUniform1i(glGetUniformLocation(g.prog, "uPrev"), 1);
+    glUniform2f(glGetUniformLocation(g.prog, "uCourant2"), cu2, cv2);
+    glUniform1f(glGetUniformLocation(g.prog, "uGamma"), gamma);
+    glUniform1i(glGetUniformLocation(g.prog, "uEmitterCount"), emitters);
+    GLint emitterLoc = glGetUniformLocation(g.prog, "uEmitters");
+    glBindFramebuffer(GL_FRAMEBUFFER, g.fbo);
+    glViewport(0, 0, g.cols, g.rows);
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(g.vao);
+    for (int k = 0; k < steps; ++k) {
+        double t = time - dt + (k + 1) * (double)dtSub;
+        float e[8 * 4];
+        for (int i = 0; i < emitters; ++i) {
+            const WaveEmitter& em = s.emitters[i];
+            e[i * 4 + 0] = em.u; e[i * 4 + 1] = em.v;
+            e[i * 4 + 2] = dtSub * dtSub * em.amplitude * sinf(glm::two_pi<float>() * (float)fmod(em.frequency * t, 1.0));
+            e[i * 4 + 3] = em.sigma;
+        }
+        if (emitters > 0) glUniform4fv(emitterLoc, emitters, e);
+        int next = (g.cur + 1) % 3, prev = (g.cur + 2) % 3;
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, g.tex[next], 0);
+        glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, g.tex[g.cur]);
+        glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_2D, g.tex[prev]);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        g.cur = next;
+    }
+    glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, 0);
     glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glEnable(GL_DEPTH_TEST);
+}
 
-    m.indexCount = (GLsizei)idx.size();
-    return m;
+// --bench-wave: raw solver throughput (one substep, no emitters) for 128^2 .. 4096^2 on CPU and GPU
+static void benchWaveField(ThreadPool& pool) {
+    std::cout << "wave field throughput (" << pool.size() << " CPU threads)\n"
+              << "    grid     CPU Mcell/s   GPU Mcell/s\n";
+    for (int n = 128; n <= 4096; n *= 2) {
+        float cu2, cv2, gamma;
+        waveCoefficients(n, n, 0.35f, 0.6f, 0.5f / (0.35f * n), cu2, cv2, gamma);
+        int reps = n >= 2048 ? 10 : 100;
+
+        WaveField f = makeWaveField(n, n);
+        waveKernel(f, cu2, cv2, gamma, pool); // warm up, fault the pages in
+        double t0 = glfwGetTime();
+        for (int i = 0; i < reps; ++i) {
+            waveKernel(f, cu2, cv2, gamma, pool);
+            std::swap(f.prev, f.cur); std::swap(f.cur, f.next);
+        }
+        double cpu = (double)n * n * reps / (glfwGetTime() - t0) / 1e6;
+
+        // GPU: time the same number of substeps with a timer query; emitters off
+        WaveFieldGpu g = makeWaveFieldGpu(n, n);
+        WaveFieldSettings quiet; quiet.speed = 0.35f; quiet.damping = 0.6f;
+        float dt = reps * 0.5f / (0.35f * n); // roughly `reps` substeps
+        stepWaveFieldGpu(g, quiet, dt, dt);
+        GLuint q; glGenQueries(1, &q);
+        glBeginQuery(GL_TIME_ELAPSED, q);
+        stepWaveFieldGpu(g, quiet, dt, 2.0f * dt);
+        glEndQuery(GL_TIME_ELAPSED);
+        GLuint64 ns = 0; glGetQueryObjectui64v(q, GL_QUERY_RESULT, &ns);
+        double gpu = ns ? (double)n * n * waveSubsteps(n, n, 0.35f, dt) / (ns * 1e-9) / 1e6 : 0.0;
+        glDeleteQueries(1, &q);
+
+        char line[96];
+        snprintf(line, sizeof(line), "  %5d^2  %12.0f  %12.0f\n", n, cpu, gpu);
+        std::cout << line;
+    }
 }
 
 struct LightCube {
-    GLuint vao = 0, vbo = 0;
+    GlVertexArray vao;
+    GlBuffer vbo, ebo;
     GLsizei count = 0;
 };
 LightCube makeLightCube() {
-    float s = 0.08f;
-    float verts[] = {
-        -s,-s,-s,  s,-s,-s,  s, s,-s,  -s, s,-s,
-        -s,-s, s,  s,-s, s,  s, s, s,  -s, s, s
-    };
-    unsigned int idx[] = {
-        0,1,2, 2,3,0, 1,5,6, 6,2,1, 5,4,7, 7,6,5,
-        4,0,3, 3,7,4, 3,2,6, 6,7,3, 4,5,1, 1,0,4
-    };
-    GLuint ebo;
-    LightCube c; c.count = sizeof(idx) / sizeof(unsigned int);
-    glGenVertexArrays(1, &c.vao);
-    glGenBuffers(1, &c.vbo);
-    glGenBuffers(1, &ebo);
+    CubeGeometry g = lightCubeGeometry();
+    LightCube c; c.count = sizeof(g.idx) / sizeof(unsigned int);
+    c.vao = genVertexArray();
+    c.vbo = genBuffer();
+    c.ebo = genBuffer();
     glBindVertexArray(c.vao);
     glBindBuffer(GL_ARRAY_BUFFER, c.vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(idx), idx, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(g.verts), g.verts, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, c.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(g.idx), g.idx, GL_STATIC_DRAW);
     glEnableVertexAttribArray(0); glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glBindVertexArray(0);
+    trackGpu(GpuObject::Buffer, c.vbo, MemTag::LightCubes, sizeof(g.verts));
+    trackGpu(GpuObject::Buffer, c.ebo, MemTag::LightCubes, sizeof(g.idx));
     return c;
 }
 
-// positions of 4 point lights
-static glm::vec3 pointLights[4] = {
-    { 1.5f,  1.2f,  1.5f},
-    {-1.8f,  1.0f,  1.2f},
-    { 1.6f,  1.5f, -1.6f},
-    {-1.4f,  1.4f, -1.3f}
+// === headless output: colour + depth renderbuffers standing in for the window's framebuffer ===
+struct OffscreenTarget {
+    GLuint fbo = 0, color = 0, depth = 0;
+    int width = 0, height = 0;
+};
+OffscreenTarget makeOffscreenTarget(int width, int height) {
+    OffscreenTarget t;
+    t.width = width; t.height = height;
+    glGenRenderbuffers(1, &t.color);
+    glBindRenderbuffer(GL_RENDERBUFFER, t.color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &t.depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, t.depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glGenFramebuffers(1, &t.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, t.fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, t.color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, t.depth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "offscreen target " << width << "x" << height << " incomplete\n";
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    trackGpu(GpuObject::Renderbuffer, t.color, MemTag::Target, (size_t)width * height * 4);
+    trackGpu(GpuObject::Renderbuffer, t.depth, MemTag::Target, (size_t)width * height * 4); // 24-bit depth pads to 32
+    return t;
+}
+void destroyOffscreenTarget(OffscreenTarget& t) {
+    untrackGpu(GpuObject::Renderbuffer, t.color);
+    untrackGpu(GpuObject::Renderbuffer, t.depth);
+    glDeleteFramebuffers(1, &t.fbo);
+    glDeleteRenderbuffers(1, &t.color);
+    glDeleteRenderbuffers(1, &t.depth);
+    t = OffscreenTarget();
+}
+// the bound framebuffer's colour as a binary PPM, top row first
+bool writeFramePpm(const std::string& path, int width, int height) {
+    std::vector<unsigned char> rgb((size_t)width * height * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, rgb.data());
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fprintf(f, "P6\n%d %d\n255\n", width, height) > 0;
+    for (int y = height - 1; y >= 0 && ok; --y)
+        ok = fwrite(&rgb[(size_t)y * width * 3], 1, (size_t)width * 3, f) == (size_t)width * 3;
+    return fclose(f) == 0 && ok;
+}
+
+// === GPU frame time: GL_TIMESTAMP pairs, a few frames in flight so reading them back never stalls ===
+// timestamps rather than GL_TIME_ELAPSED: they don't collide with elapsed queries used inside the frame,
+// and llvmpipe reports garbage for the first elapsed query of a context
+const int kGpuTimerFrames = 4;
+struct GpuTimer {
+    GLuint q[2 * kGpuTimerFrames] = {};
+    int issued = 0, read = 0;
+};
+GpuTimer makeGpuTimer() {
+    GpuTimer t;
+    glGenQueries(2 * kGpuTimerFrames, t.q);
+    return t;
+}
+void destroyGpuTimer(GpuTimer& t) {
+    glDeleteQueries(2 * kGpuTimerFrames, t.q);
+    t = GpuTimer();
+}
+static void readGpuTimer(GpuTimer& t, std::vector<double>& ms) {
+    GLuint64 t0 = 0, t1 = 0;
+    int slot = t.read % kGpuTimerFrames;
+    glGetQueryObjectui64v(t.q[2 * slot], GL_QUERY_RESULT, &t0);
+    glGetQueryObjectui64v(t.q[2 * slot + 1], GL_QUERY_RESULT, &t1);
+    ms.push_back(t1 > t0 ? (t1 - t0) * 1e-6 : 0.0);
+    ++t.read;
+}
+// appends finished results to ms; wait = block until every issued frame is in
+void collectGpuTimer(GpuTimer& t, std::vector<double>& ms, bool wait) {
+    while (t.read < t.issued) {
+        GLint ready = 1;
+        if (!wait) glGetQueryObjectiv(t.q[2 * (t.read % kGpuTimerFrames) + 1], GL_QUERY_RESULT_AVAILABLE, &ready);
+        if (!ready) break;
+        readGpuTimer(t, ms);
+    }
+}
+void beginGpuTimer(GpuTimer& t, std::vector<double>& ms) {
+    if (t.issued - t.read == kGpuTimerFrames) readGpuTimer(t, ms); // every slot pending: wait for the oldest only
+    glQueryCounter(t.q[2 * (t.issued % kGpuTimerFrames)], GL_TIMESTAMP);
+}
+void endGpuTimer(GpuTimer& t) {
+    glQueryCounter(t.q[2 * (t.issued % kGpuTimerFrames) + 1], GL_TIMESTAMP);
+    ++t.issued;
+}
+
+// sculpture i of n on a square grid in the XZ plane, the first one at the origin when n == 1
+glm::vec3 instanceOffset(int i, int n) {
+    int side = (int)ceil(sqrt((double)n));
+    const float spacing = 3.5f;
+    return glm::vec3((i % side - (side - 1) * 0.5f) * spacing, 0.0f, (i / side - (side - 1) * 0.5f) * spacing);
+}
+
+// === point lights: the scene's 4 orbiting lights, optional coloured extras for many-light scenes, then
+// its fixed lights ===
+std::vector<PointLight> makeLights(int count, const SceneConfig& scene) {
+    std::vector<PointLight> lights(count, scene.orbitLight);
+    for (int i = 4; i < count; ++i) {
+        // fixed hue per light; total energy of the extras stays about that of the 4 originals
+        float hue = fmod(i * 0.618034f, 1.0f) * glm::two_pi<float>();
+        glm::vec3 tint(0.6f + 0.4f * cos(hue), 0.6f + 0.4f * cos(hue - 2.094f), 0.6f + 0.4f * cos(hue + 2.094f));
+        float share = 4.0f / (float)(count - 4 > 4 ? count - 4 : 4);
+        lights[i].ambient = glm::vec3(0.0f);
+        lights[i].diffuse = tint * 0.9f * share;
+        lights[i].specular = tint * share;
+    }
+    lights.insert(lights.end(), scene.fixedLights.begin(), scene.fixedLights.end());
+    return lights;
+}
+
+// === animate lights gently ===
+// the fixed lights at the end stay where they are
+void animateLights(std::vector<PointLight>& lights, double t, const SceneConfig& scene) {
+    int count = (int)lights.size() - (int)scene.fixedLights.size();
+    for (int i = 0; i < count && i < 4; ++i) {
+        float orbit = phaseAt(t, scene.orbitSpeed, i * glm::half_pi<float>());
+        lights[i].position.x = scene.orbitRadius * sin(orbit);
+        lights[i].position.z = scene.orbitRadius * cos(orbit);
+        lights[i].position.y = scene.orbitHeight + scene.bobHeight * sin(phaseAt(t, scene.bobSpeed, i));
+    }
+    // extras drift on a golden-angle spiral through a shell around the sculpture
+    for (int i = 4; i < count; ++i) {
+        float k = (float)(i - 4) / (float)(count - 4);
+        float speed = (0.15f + 0.3f * fmod(i * 0.7548776f, 1.0f)) * scene.driftSpeed;
+        float ang = phaseAt(t, speed, i * 2.399963f);
+        float rad = 2.2f + 3.8f * sqrtf(k);
+        lights[i].position = glm::vec3(rad * cos(ang), -1.5f + 4.0f * fmod(i * 0.5698403f, 1.0f) + 0.3f * sin(phaseAt(t, 1.1f, i)), rad * sin(ang));
+    }
+}
+
+// === --bench-shaders: fragment cost of sculpture.fs variants on a fixed full-screen workload ===
+// every variant x light count is drawn into an offscreen target until 0.25 s or 200 draws; cost per pixel
+// from GL_TIME_ELAPSED and from wall time around glFinish (the honest number on software rasterizers).
+// The image is read back and compared against the reference variant at the same light count.
+struct ShaderVariant {
+    const char* name;
+    const char* defines;
+};
+static void benchShaders(int width, int height, const std::string& jsonPath) {
+    const ShaderVariant variants[] = {
+        { "phong",                "" },
+        { "phong-cutoff",         "#define ATT_CUTOFF 1\n" },
+        { "phong-fastpow",        "#define SPEC_FASTPOW 1\n" },
+        { "blinn",                "#define SPEC_BLINN 1\n" },
+        { "blinn-fastpow",        "#define SPEC_BLINN 1\n#define SPEC_FASTPOW 1\n" },
+        { "blinn-fastpow-cutoff", "#define SPEC_BLINN 1\n#define SPEC_FASTPOW 1\n#define ATT_CUTOFF 1\n" },
+    };
+    const int lightCounts[] = { 1, 4, 16, 64, 256 };
+    const int variantCount = sizeof(variants) / sizeof(variants[0]);
+
+    std::string vsSrc = readTextFile("shader_bench.vs"), fsSrc = readTextFile("sculpture.fs");
+    GLuint progs[variantCount];
+    for (int v = 0; v < variantCount; ++v) {
+        progs[v] = link(compile(GL_VERTEX_SHADER, vsSrc), compile(GL_FRAGMENT_SHADER, withDefines(fsSrc, variants[v].defines)));
+        GLuint p = progs[v];
+        glUseProgram(p);
+        glUniformBlockBinding(p, glGetUniformBlockIndex(p, "PointLights"), 1);
+        glUniform3f(glGetUniformLocation(p, "material.ambient"), 0.15f, 0.15f, 0.15f);
+        glUniform3f(glGetUniformLocation(p, "material.diffuse"), 0.7f, 0.75f, 0.8f);
+        glUniform3f(glGetUniformLocation(p, "material.specular"), 0.9f, 0.9f, 0.9f);
+        glUniform1f(glGetUniformLocation(p, "material.shininess"), 48.0f);
+        glUniform3f(glGetUniformLocation(p, "uViewPos"), 0.0f, 0.0f, 5.0f);
+        glUniform3f(glGetUniformLocation(p, "dirLight.direction"), -0.2f, -1.0f, -0.3f);
+        glUniform3f(glGetUniformLocation(p, "dirLight.ambient"), 0.04f, 0.04f, 0.05f);
+        glUniform3f(glGetUniformLocation(p, "dirLight.diffuse"), 0.25f, 0.25f, 0.3f);
+        glUniform3f(glGetUniformLocation(p, "dirLight.specular"), 0.3f, 0.3f, 0.35f);
+        glUniform1i(glGetUniformLocation(p, "uShEnabled"), 0);
+    }
+
+    OffscreenTarget target = makeOffscreenTarget(width, height);
+    GLuint vao, ubo, query;
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, kMaxShaderLights * sizeof(GpuPointLight), nullptr, GL_STATIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 1, ubo);
+    glGenQueries(1, &query);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(vao);
+
+    std::ofstream json;
+    if (!jsonPath.empty()) json.open(jsonPath);
+    json << "[\n";
+    double pixels = (double)width * height;
+    std::vector<unsigned char> reference(width * height * 4), image(width * height * 4);
+    std::cout << "shader variants, " << width << "x" << height << " full-screen\n"
+              << "  lights  variant                  gpu ns/px  wall ns/px   Mpx/s  mean err  max err\n";
+    for (int count : lightCounts) {
+        // the original scene, whatever --scene says: the workload stays comparable
+        std::vector<PointLight> lights = makeLights(count, SceneConfig());
+        animateLights(lights, 1.0f, SceneConfig());
+        std::vector<GpuPointLight> block;
+        for (const PointLight& L : lights) block.push_back(packLight(L));
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, block.size() * sizeof(GpuPointLight), block.data());
+
+        for (int v = 0; v < variantCount; ++v) {
+            glUseProgram(progs[v]);
+            glUniform1i(glGetUniformLocation(progs[v], "uPointLightCount"), count);
+            // warm-up: some drivers finish compiling on first draw, llvmpipe's first elapsed query is bogus
+            glBeginQuery(GL_TIME_ELAPSED, query);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glEndQuery(GL_TIME_ELAPSED);
+            glFinish();
+
+            std::vector<double> gpuNs, wallNs;
+            double spent = 0.0;
+            while (wallNs.size() < 5 || (spent < 250.0 && wallNs.size() < 200)) {
+                double t0 = processMs();
+                glBeginQuery(GL_TIME_ELAPSED, query);
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+                glEndQuery(GL_TIME_ELAPSED);
+                glFinish();
+                double ms = processMs() - t0;
+                GLuint64 ns = 0; glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+                gpuNs.push_back(ns / pixels);
+                wallNs.push_back(ms * 1e6 / pixels);
+                spent += ms;
+            }
+            double gpu = summarize(gpuNs).p50, wall = summarize(wallNs).p50;
+
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, v == 0 ? reference.data() : image.data());
+            double errSum = 0.0; int errMax = 0;
+            if (v > 0) {
+                for (size_t i = 0; i < image.size(); i += 4)
+                    for (int c = 0; c < 3; ++c) {
+                        int e = abs((int)image[i + c] - (int)reference[i + c]);
+                        errSum += e; errMax = e > errMax ? e : errMax;
+                    }
+            }
+            double errMean = errSum / (pixels * 3.0);
+
+            char line[160];
+            snprintf(line, sizeof(line), "  %6d  %-22s %10.3f %11.3f %7.1f %9.3f %8d\n",
+                     count, variants[v].name, gpu, wall, wall > 0.0 ? 1e3 / wall : 0.0, errMean, errMax);
+            std::cout << line;
+            snprintf(line, sizeof(line),
+                     "  {\"lights\": %d, \"variant\": \"%s\", \"gpu_ns_per_px\": %.4f, \"wall_ns_per_px\": %.4f, "
+                     "\"mean_err\": %.4f, \"max_err\": %d}",
+                     count, variants[v].name, gpu, wall, errMean, errMax);
+            json << (count == lightCounts[0] && v == 0 ? "" : ",\n") << line;
+        }
+    }
+    json << "\n]\n";
+
+    glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glEnable(GL_DEPTH_TEST);
+    glDeleteQueries(1, &query);
+    glDeleteBuffers(1, &ubo);
+    glDeleteVertexArrays(1, &vao);
+    for (GLuint p : progs) deleteProgram(p);
+    destroyOffscreenTarget(target);
+}
+
+// --bench-upload: every streaming path for per-frame vertex streams of 1 to 256 MB
+static void benchUploads(const std::string& jsonPath) {
+    std::ofstream json;
+    if (!jsonPath.empty()) json.open(jsonPath);
+    json << "[\n";
+    bool first = true;
+    std::cout << "vertex stream uploads (per frame, then a GPU read of the buffer)\n"
+              << "     MB  path              MB/s   call p50 ms  call p99 ms\n";
+    for (int mb = 1; mb <= 256; mb *= 4) {
+        int frames = mb >= 64 ? 6 : 24;
+        for (const UploadTiming& t : measureUploadPaths((size_t)mb << 20, frames)) {
+            char line[160];
+            snprintf(line, sizeof(line), "  %5d  %-15s %7.0f %12.3f %12.3f\n", mb, uploadPathName(t.path), t.mbPerS, t.p50Ms, t.p99Ms);
+            std::cout << line;
+            snprintf(line, sizeof(line), "  {\"mb\": %d, \"path\": \"%s\", \"mb_per_s\": %.1f, \"call_p50_ms\": %.4f, \"call_p99_ms\": %.4f}",
+                     mb, uploadPathName(t.path), t.mbPerS, t.p50Ms, t.p99Ms);
+            json << (first ? "" : ",\n") << line;
+            first = false;
+        }
+    }
+    json << "\n]\n";
+}
+
+// === --bench-draws: CPU cost of submitting N small objects, per submission strategy ===
+// every frame all N model matrices change (a slow spin), so each strategy also pays for getting them over:
+//   uniform     glUniformMatrix4fv + glDrawElements per object, what main() does for the light cubes
+//   ubo-range   all matrices in one uniform buffer, glBindBufferRange + glDrawElements per object
+//   instanced   matrices as a per-instance attribute, one glDrawElementsInstanced
+//   multidraw   one glMultiDrawElementsBaseVertex over N copies of the mesh tagged with an object id,
+//               matrices from a texture buffer (3.3 has no gl_DrawID to index with)
+//   indirect    one glMultiDrawElementsIndirect, baseInstance picks the matrix; GL 4.3 or the ARB extensions
+// submit = wall time of the frame's GL calls including the matrix upload, finish = submit plus glFinish.
+// Each image is compared against the uniform strategy's so a broken path shows up as a diff.
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+typedef void (APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+struct DrawElementsIndirectCommand {
+    GLuint count, instanceCount, firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
 };
 
-int main() {
+static bool glSupports(int major, int minor, const char* extension) {
+    GLint ma = 0, mi = 0, count = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &ma);
+    glGetIntegerv(GL_MINOR_VERSION, &mi);
+    if (ma > major || (ma == major && mi >= minor)) return true;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int i = 0; i < count; ++i)
+        if (!strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), extension)) return true;
+    return false;
+}
+
+// mat4 attribute at locations 1-4 from the bound GL_ARRAY_BUFFER, one per instance
+static void instanceMatrixAttribs() {
+    for (int c = 0; c < 4; ++c) {
+        glEnableVertexAttribArray(1 + c);
+        glVertexAttribPointer(1 + c, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(c * sizeof(glm::vec4)));
+        glVertexAttribDivisor(1 + c, 1);
+    }
+}
+
+static void benchDraws(const std::string& jsonPath) {
+    const char* strategies[] = { "uniform", "ubo-range", "instanced", "multidraw", "indirect" };
+    const int strategyCount = 5;
+    const int programFor[strategyCount] = { 0, 1, 2, 3, 2 }; // MODEL_FROM of each strategy
+    const int counts[] = { 1, 16, 256, 1024, 4096, 16384 };
+    const int size = 256;
+
+    MultiDrawElementsIndirectProc multiDrawIndirect = nullptr;
+    if (glSupports(4, 3, "GL_ARB_multi_draw_indirect") && glSupports(4, 2, "GL_ARB_base_instance"))
+        multiDrawIndirect = (MultiDrawElementsIndirectProc)glfwGetProcAddress("glMultiDrawElementsIndirect");
+
+    std::string vsSrc = readTextFile("draw_bench.vs"), fsSrc = readTextFile("light_cube.fs");
+    GLuint progs[4];
+    for (int k = 0; k < 4; ++k)
+        progs[k] = link(compile(GL_VERTEX_SHADER, withDefines(vsSrc, "#define MODEL_FROM " + std::to_string(k) + "\n")),
+                        compile(GL_FRAGMENT_SHADER, fsSrc));
+    glUniformBlockBinding(progs[1], glGetUniformBlockIndex(progs[1], "DrawModel"), 2);
+    glUseProgram(progs[3]);
+    glUniform1i(glGetUniformLocation(progs[3], "uModels"), 0);
+    GLint modelLoc = glGetUniformLocation(progs[0], "uModel");
+    GLint uboAlign = 256; glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlign);
+    GLsizeiptr uboStride = ((GLsizeiptr)sizeof(glm::mat4) + uboAlign - 1) / uboAlign * uboAlign;
+
+    // the light cube and a coarse sculpture, positions only
+    struct BenchMesh {
+        const char* name;
+        std::vector<float> pos;
+        std::vector<unsigned int> idx;
+        int maxCount;           // multidraw keeps a full copy per object
+    };
+    BenchMesh meshes[2];
+    CubeGeometry cubeGeom = lightCubeGeometry(1.0f);
+    meshes[0] = { "cube", std::vector<float>(cubeGeom.verts, cubeGeom.verts + 24),
+                  std::vector<unsigned int>(cubeGeom.idx, cubeGeom.idx + 36), 16384 };
+    std::vector<float> sv;
+    sculptureVertices(sv, 16, 24, 0.0f);
+    meshes[1].name = "sculpture"; meshes[1].maxCount = 4096;
+    for (size_t i = 0; i < sv.size(); i += kVertexFloats)
+        for (int c = 0; c < 3; ++c) meshes[1].pos.push_back(sv[i + c] * 0.6f); // about the cube's extent
+    sculptureIndices(meshes[1].idx, 16, 24);
+
+    OffscreenTarget target = makeOffscreenTarget(size, size);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    glViewport(0, 0, size, size);
+    glEnable(GL_DEPTH_TEST);
+
+    std::ofstream json;
+    if (!jsonPath.empty()) json.open(jsonPath);
+    json << "[\n";
+    bool first = true;
+    std::cout << "draw submission, " << size << "x" << size << (multiDrawIndirect ? "" : ", no indirect draws on this context") << "\n"
+              << "  mesh        objects  strategy     submit ms  finish ms    Mdraws/s  diff px\n";
+    std::vector<unsigned char> reference(size * size * 4), image(size * size * 4);
+
+    for (const BenchMesh& mesh : meshes) {
+        GLsizei indexCount = (GLsizei)mesh.idx.size();
+        int vertsPerMesh = (int)mesh.pos.size() / 3;
+        int maxCount = mesh.maxCount;
+
+        GLuint vbo, ebo, instVbo, copyVbo, ubo, tbo, tboTex, indirect, vaos[3];
+        glGenBuffers(1, &vbo); glGenBuffers(1, &ebo); glGenBuffers(1, &instVbo); glGenBuffers(1, &copyVbo);
+        glGenBuffers(1, &ubo); glGenBuffers(1, &tbo); glGenBuffers(1, &indirect);
+        glGenTextures(1, &tboTex);
+        glGenVertexArrays(3, vaos);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, mesh.pos.size() * sizeof(float), mesh.pos.data(), GL_STATIC_DRAW);
+
+        // [0] plain mesh, [1] mesh + per-instance matrix, [2] N copies with an object id per vertex
+        for (int k = 0; k < 3; ++k) {
+            glBindVertexArray(vaos[k]);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+            if (k == 0) glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.idx.size() * sizeof(unsigned int), mesh.idx.data(), GL_STATIC_DRAW);
+            if (k < 2) {
+                glBindBuffer(GL_ARRAY_BUFFER, vbo);
+                glEnableVertexAttribArray(0); glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+            }
+            if (k == 1) {
+                glBindBuffer(GL_ARRAY_BUFFER, instVbo);
+                instanceMatrixAttribs();
+            }
+            if (k == 2) {
+                std::vector<float> copies((size_t)maxCount * vertsPerMesh * 4);
+                for (int o = 0; o < maxCount; ++o)
+                    for (int v = 0; v < vertsPerMesh; ++v) {
+                        float* dst = &copies[((size_t)o * vertsPerMesh + v) * 4];
+                        memcpy(dst, &mesh.pos[v * 3], 3 * sizeof(float));
+                        dst[3] = (float)o;
+                    }
+                glBindBuffer(GL_ARRAY_BUFFER, copyVbo);
+                glBufferData(GL_ARRAY_BUFFER, copies.size() * sizeof(float), copies.data(), GL_STATIC_DRAW);
+                glEnableVertexAttribArray(0); glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+                glEnableVertexAttribArray(5); glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(3 * sizeof(float)));
+            }
+        }
+        glBindVertexArray(0);
+
+        // per-draw arrays that don't change from frame to frame
+        std::vector<GLsizei> drawCounts(maxCount, indexCount);
+        std::vector<const void*> drawOffsets(maxCount, nullptr);
+        std::vector<GLint> baseVertices(maxCount);
+        std::vector<DrawElementsIndirectCommand> commands(maxCount);
+        for (int o = 0; o < maxCount; ++o) {
+            baseVertices[o] = o * vertsPerMesh;
+            commands[o] = { (GLuint)indexCount, 1, 0, 0, (GLuint)o };
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+        std::vector<glm::mat4> models;
+        std::vector<unsigned char> uboData;
+        for (int n : counts) {
+            if (n > maxCount) break;
+            // grid over the target, each object spinning at its own phase
+            int side = (int)ceil(sqrt((double)n));
+            float cell = 2.0f / side;
+            auto fillModels = [&](float t) {
+                models.resize(n);
+                for (int o = 0; o < n; ++o) {
+                    glm::vec3 at(-1.0f + cell * (o % side + 0.5f), -1.0f + cell * (o / side + 0.5f), 0.0f);
+                    glm::mat4 m = glm::translate(glm::mat4(1.0f), at);
+                    m = glm::scale(m, glm::vec3(cell * 0.35f));
+                    models[o] = glm::rotate(m, t + o * 0.37f, glm::vec3(0.3f, 1.0f, 0.2f));
+                }
+            };
+
+            for (int s = 0; s < strategyCount; ++s) {
+                if (s == 4 && !multiDrawIndirect) continue;
+                GLuint p = progs[programFor[s]];
+                auto submit = [&]() {
+                    glUseProgram(p);
+                    if (s == 0) {
+                        glBindVertexArray(vaos[0]);
+                        for (int o = 0; o < n; ++o) {
+                            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(models[o]));
+                            glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+                        }
+                    } else if (s == 1) {
+                        uboData.resize((size_t)n * uboStride);
+                        for (int o = 0; o < n; ++o) memcpy(&uboData[o * uboStride], &models[o], sizeof(glm::mat4));
+                        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+                        glBufferData(GL_UNIFORM_BUFFER, uboData.size(), uboData.data(), GL_STREAM_DRAW);
+                        glBindVertexArray(vaos[0]);
+                        for (int o = 0; o < n; ++o) {
+                            glBindBufferRange(GL_UNIFORM_BUFFER, 2, ubo, o * uboStride, sizeof(glm::mat4));
+                            glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+                        }
+                    } else if (s == 3) {
+                        glBindBuffer(GL_TEXTURE_BUFFER, tbo);
+                        glBufferData(GL_TEXTURE_BUFFER, n * sizeof(glm::mat4), models.data(), GL_STREAM_DRAW);
+                        glActiveTexture(GL_TEXTURE0);
+                        glBindTexture(GL_TEXTURE_BUFFER, tboTex);
+                        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, tbo);
+                        glBindVertexArray(vaos[2]);
+                        glMultiDrawElementsBaseVertex(GL_TRIANGLES, drawCounts.data(), GL_UNSIGNED_INT, drawOffsets.data(), n, baseVertices.data());
+                    } else {
+                        glBindBuffer(GL_ARRAY_BUFFER, instVbo);
+                        glBufferData(GL_ARRAY_BUFFER, n * sizeof(glm::mat4), models.data(), GL_STREAM_DRAW);
+                        glBindVertexArray(vaos[1]);
+                        if (s == 2) {
+                            glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, n);
+                        } else {
+                            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect);
+                            multiDrawIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0, n, 0);
+                            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+                        }
+                    }
+                    glBindVertexArray(0);
+                };
+
+                // warm-up frames: first-use validation and buffer allocation
+                for (int w = 0; w < 3; ++w) {
+                    fillModels(0.0f);
+                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                    submit();
+                    glFinish();
+                }
+                std::vector<double> submitMs, finishMs;
+                double spent = 0.0;
+                for (int f = 1; submitMs.size() < 5 || (spent < 300.0 && submitMs.size() < 100); ++f) {
+                    fillModels(f * 0.01f);
+                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                    glFinish();
+                    double t0 = processMs();
+                    submit();
+                    double t1 = processMs();
+                    glFinish();
+                    double t2 = processMs();
+                    submitMs.push_back(t1 - t0);
+                    finishMs.push_back(t2 - t0);
+                    spent += t2 - t0;
+                }
+
+                // same matrices for every strategy's check image
+                fillModels(0.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                submit();
+                glReadPixels(0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, s == 0 ? reference.data() : image.data());
+                int diff = 0;
+                if (s > 0)
+                    for (size_t i = 0; i < image.size(); i += 4) diff += memcmp(&image[i], &reference[i], 3) != 0;
+
+                double sub = summarize(submitMs).p50, fin = summarize(finishMs).p50;
+                double mdraws = sub > 0.0 ? n / sub * 1e-3 : 0.0;
+                char line[200];
+                snprintf(line, sizeof(line), "  %-10s %8d  %-10s %10.3f %10.3f %11.2f %8d\n",
+                         mesh.name, n, strategies[s], sub, fin, mdraws, diff);
+                std::cout << line;
+                snprintf(line, sizeof(line),
+                         "  {\"mesh\": \"%s\", \"objects\": %d, \"strategy\": \"%s\", \"submit_ms\": %.4f, \"finish_ms\": %.4f, "
+                         "\"draws_per_s\": %.0f, \"diff_px\": %d}",
+                         mesh.name, n, strategies[s], sub, fin, mdraws * 1e6, diff);
+                json << (first ? "" : ",\n") << line;
+                first = false;
+            }
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glDeleteVertexArrays(3, vaos);
+        glDeleteTextures(1, &tboTex);
+        GLuint buffers[] = { vbo, ebo, instVbo, copyVbo, ubo, tbo, indirect };
+        glDeleteBuffers(7, buffers);
+    }
+    json << "\n]\n";
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    for (GLuint p : progs) deleteProgram(p);
+    destroyOffscreenTarget(target);
+}
+
+static const char kUsage[] =
+    "usage: multiple_lights [options] (README.md, Options)\n"
+    "  --scene FILE  --set KEY=VALUE  --print-scene  --size WxH  --res RINGSxSEGMENTS|N  --lights N  --instances N\n"
+    "  --softbody  --wavefield  --wavefield-gpu  --morph  --lighttree  --shlights  --kernel scalar|table|simd\n"
+    "  --headless  --frames N  --screenshot FILE  --stats  --samples FILE  --hud  --perf-counters  --define NAME[=VALUE]\n"
+    "  --bench-wave  --bench-shaders  --bench-json FILE  --bench-upload  --bench-draws  --upload PATH|auto\n"
+    "  --telemetry-shm NAME  --metrics-file PATH  --metrics-interval S  --capture FILE  --capture-frames N\n"
+    "  --gpu-budget MB  --cpu-budget MB  --memory-report FILE  --lod-cycle N  --lod N  --index-layout triangles|strip\n"
+    "  --stream RINGSxSEGMENTS|N  --stream-budget MB  --gallery DIR  --gallery-size N  --gallery-budget MB\n"
+    "  --export FILE  --export-frames N  --export-start T  --export-fps F  --export-quantize  --export-delta\n"
+    "  --export-keys K  --export-gltf FILE  --export-time T\n"
+    "  --soak SECONDS  --soak-speed X  --soak-interval S  --soak-report FILE\n";
+
+// "WxH" -> "W H" for the window and res scene keys
+static std::string sizeSetting(const char* key, std::string v) {
+    for (char& ch : v) if (ch == 'x') ch = ' ';
+    return std::string(key) + " " + v;
+}
+
+int main(int argc, char** argv) {
+    // --softbody: simulate the skin as a PBD lattice driven by the wave instead of using the wave directly
+    // --wavefield / --wavefield-gpu: replace the analytic wave with a simulated wave field
+    // --morph: blend between several sculpture shapes on the GPU
+    // --lights N: point light count; --lighttree: shade a per-object cut of a light tree instead of every light
+    // --shlights: near lights exact, distant/dim ones as spherical harmonics
+    // --headless: hidden window, render into an offscreen target; --frames N: fixed 60 Hz timeline, stop after N
+    // --screenshot FILE: with --frames, save the last frame as a PPM (bench/golden_check.cpp)
+    // --kernel scalar|table|simd: which sculptureVertices() kernel builds the sculpture (default simd)
+    // --size WxH, --res RINGSxSEGMENTS, --instances N: output size, sculpture resolution, sculptures drawn
+    // --stats: print a "stats ..." summary line (frame/GPU time percentiles, memory) on exit
+    // --samples FILE: write every frame's timings plus startup and peak RSS as JSON on exit
+    // --define NAME[=VALUE]: compile sculpture.fs with an extra #define (shader variants)
+    // --bench-shaders: time sculpture.fs variants per pixel and exit; --bench-json FILE: also write JSON
+    // --upload PATH|auto: how the per-frame vertex stream (--softbody) is uploaded; --bench-upload: compare them
+    // --bench-draws: CPU submit cost of N cubes/sculptures per draw submission strategy
+    // --perf-counters: hardware counters (cycles, instructions, misses, faults) per CPU phase, printed on exit
+    // --telemetry-shm NAME: per-frame records into a shared-memory ring; --metrics-file PATH [--metrics-interval S]:
+    //   Prometheus textfile snapshots
+    // --hud: start with the performance overlay shown (H toggles it)
+    // --capture FILE [--capture-frames N]: record every GL call from startup through N frames (bench/gl_replay.cpp)
+    // --gpu-budget MB, --cpu-budget MB: memory budgets subsystems check before large allocations;
+    //   --memory-report FILE: tracked GPU/CPU memory per tag as JSON on exit
+    // --lod-cycle N: rebuild the sculpture at the next coarser level every N frames ([ and ] step by hand);
+    //   --lod N: start at level N
+    // --index-layout triangles|strip: how the (shared) sculpture indices are laid out and drawn
+    // --stream RINGSxSEGMENTS [--stream-budget MB]: a sculpture too big to build, streamed in chunks for the view
+    //   through a fixed GPU pool (frozen pose)
+    // --gallery DIR [--gallery-size N] [--gallery-budget MB]: walk through a world of sectors streamed from DIR
+    //   (an N x N one is generated there if DIR has none)
+    // --export FILE [--export-frames N] [--export-start T] [--export-fps F] [--export-quantize] [--export-delta]
+    //   [--export-keys K]: write the sculpture (--res) over time as a mesh sequence and exit;
+    //   --export-gltf FILE [--export-time T]: one frame as glTF (.glb or .gltf + .bin) and exit
+    // --soak SECONDS [--soak-speed X] [--soak-interval S] [--soak-report FILE]: headless accelerated run that
+    //   reconfigures every interval and fails (exit 1) when memory, GPU objects, frame time or clock error keep growing
+    // --scene FILE: scene description (scene_config.h), reloaded live when it changes; --set KEY=VALUE: override
+    //   one setting (repeatable); --print-scene: print the effective scene and exit
+    processMs();
+    // the scene first: the flags below override it
+    std::string scenePath;
+    std::vector<std::string> sceneOverrides;
+    bool printScene = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--scene") && i + 1 < argc) scenePath = argv[++i];
+        else if (!strcmp(argv[i], "--set") && i + 1 < argc) sceneOverrides.push_back(argv[++i]);
+        else if (!strcmp(argv[i], "--print-scene")) printScene = true;
+    }
+    std::vector<std::string> sceneProblems;
+    if (!loadScene(scenePath, sceneOverrides, g_scene, sceneProblems)) {
+        for (const std::string& p : sceneProblems) std::cerr << "scene: " << p << "\n";
+        return 1;
+    }
+    SceneConfig sceneLoaded = g_scene;  // file + overrides as last loaded; reloads are diffed against it
+    bool softBodyMode = false, waveCpu = false, waveGpu = false, benchWave = false, morph = false, lightTree = false;
+    bool shLights = false, headless = false, printStats = false, benchShader = false, sizeGiven = false;
+    bool benchUpload = false, uploadAuto = true, benchDraw = false, perfCounters = false, showHud = false;
+    UploadPath uploadPath = UploadPath::SubData;
+    IndexLayout indexLayout = IndexLayout::Triangles;
+    std::string fsDefines, benchJson, samplesPath, capturePath, memoryReportPath, screenshotPath;
+    double gpuBudgetMb = 0.0, cpuBudgetMb = 0.0;
+    TelemetrySettings telemetrySettings;
+    SoakSettings soak;
+    int frameLimit = 0, instances = 1, captureFrames = 0, lodCycle = 0, lodStart = 0;
+    // --size, --res and --lights are scene settings: applied over the scene and validated with it
+    std::vector<std::pair<std::string, std::string>> sceneFlags;  // flag as given, setting
+    int streamRows = 0, streamCols = 0;
+    double streamBudgetMb = 64.0;
+    std::string galleryDir;
+    int gallerySize = 16;
+    double galleryBudgetMb = 256.0;
+    SequenceSettings exportSettings;
+    std::string gltfPath;
+    float gltfTime = 0.0f;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--softbody")) softBodyMode = true;
+        else if (!strcmp(argv[i], "--wavefield")) waveCpu = true;
+        else if (!strcmp(argv[i], "--wavefield-gpu")) waveGpu = true;
+        else if (!strcmp(argv[i], "--bench-wave")) benchWave = true;
+        else if (!strcmp(argv[i], "--morph")) morph = true;
+        else if (!strcmp(argv[i], "--lighttree")) lightTree = true;
+        else if (!strcmp(argv[i], "--shlights")) shLights = true;
+        else if (!strcmp(argv[i], "--lights") && i + 1 < argc) {
+            sceneFlags.push_back({ std::string("--lights ") + argv[i + 1], std::string("lights ") + argv[i + 1] });
+            ++i;
+        }
+        else if (!strcmp(argv[i], "--headless")) headless = true;
+        else if (!strcmp(argv[i], "--stats")) printStats = true;
+        else if (!strcmp(argv[i], "--frames") && i + 1 < argc) frameLimit = atoi(argv[++i]);
+        else if ((!strcmp(argv[i], "--scene") || !strcmp(argv[i], "--set")) && i + 1 < argc) ++i;  // read above
+        else if (!strcmp(argv[i], "--print-scene")) {}
+        else if (!strcmp(argv[i], "--screenshot") && i + 1 < argc) screenshotPath = argv[++i];
+        else if (!strcmp(argv[i], "--kernel") && i + 1 < argc) {
+            ++i;
+            if (!strcmp(argv[i], "scalar")) g_kernel = GeometryKernel::Scalar;
+            else if (!strcmp(argv[i], "table")) g_kernel = GeometryKernel::Table;
+            else if (!strcmp(argv[i], "simd")) g_kernel = GeometryKernel::Simd;
+            else std::cerr << "unknown kernel " << argv[i] << ", using simd\n";
+        }
+        else if (!strcmp(argv[i], "--instances") && i + 1 < argc) instances = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--size") && i + 1 < argc) {
+            sceneFlags.push_back({ std::string("--size ") + argv[i + 1], sizeSetting("window", argv[i + 1]) });
+            ++i;
+            sizeGiven = true;
+        }
+        else if (!strcmp(argv[i], "--bench-shaders")) benchShader = true;
+        else if (!strcmp(argv[i], "--samples") && i + 1 < argc) samplesPath = argv[++i];
+        else if (!strcmp(argv[i], "--bench-upload")) benchUpload = true;
+        else if (!strcmp(argv[i], "--bench-draws")) benchDraw = true;
+        else if (!strcmp(argv[i], "--perf-counters")) perfCounters = true;
+        else if (!strcmp(argv[i], "--hud")) showHud = true;
+        else if (!strcmp(argv[i], "--capture") && i + 1 < argc) capturePath = argv[++i];
+        else if (!strcmp(argv[i], "--capture-frames") && i + 1 < argc) captureFrames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--gpu-budget") && i + 1 < argc) gpuBudgetMb = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--cpu-budget") && i + 1 < argc) cpuBudgetMb = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--memory-report") && i + 1 < argc) memoryReportPath = argv[++i];
+        else if (!strcmp(argv[i], "--lod-cycle") && i + 1 < argc) lodCycle = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--lod") && i + 1 < argc) lodStart = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--index-layout") && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (!parseIndexLayout(name, indexLayout)) std::cerr << "unknown index layout " << name << ", using triangles\n";
+        }
+        else if (!strcmp(argv[i], "--stream") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &streamRows, &streamCols) == 1) streamCols = streamRows;
+        }
+        else if (!strcmp(argv[i], "--stream-budget") && i + 1 < argc) streamBudgetMb = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--export") && i + 1 < argc) exportSettings.path = argv[++i];
+        else if (!strcmp(argv[i], "--export-frames") && i + 1 < argc) exportSettings.frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--export-start") && i + 1 < argc) exportSettings.startTime = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--export-fps") && i + 1 < argc) exportSettings.fps = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--export-quantize")) exportSettings.quantize = true;
+        else if (!strcmp(argv[i], "--export-delta")) exportSettings.delta = true;
+        else if (!strcmp(argv[i], "--export-keys") && i + 1 < argc) exportSettings.keyInterval = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--export-gltf") && i + 1 < argc) gltfPath = argv[++i];
+        else if (!strcmp(argv[i], "--export-time") && i + 1 < argc) gltfTime = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--gallery") && i + 1 < argc) galleryDir = argv[++i];
+        else if (!strcmp(argv[i], "--gallery-size") && i + 1 < argc) gallerySize = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--gallery-budget") && i + 1 < argc) galleryBudgetMb = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--soak") && i + 1 < argc) soak.durationS = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--soak-speed") && i + 1 < argc) soak.speed = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--soak-interval") && i + 1 < argc) soak.intervalS = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--soak-report") && i + 1 < argc) soak.reportPath = argv[++i];
+        else if (!strcmp(argv[i], "--telemetry-shm") && i + 1 < argc) telemetrySettings.shmName = argv[++i];
+        else if (!strcmp(argv[i], "--metrics-file") && i + 1 < argc) telemetrySettings.metricsPath = argv[++i];
+        else if (!strcmp(argv[i], "--metrics-interval") && i + 1 < argc) telemetrySettings.metricsIntervalS = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--upload") && i + 1 < argc) {
+            const char* name = argv[++i];
+            uploadAuto = !strcmp(name, "auto");
+            if (!uploadAuto && !parseUploadPath(name, uploadPath)) {
+                std::cerr << "unknown upload path " << name << ", probing instead\n";
+                uploadAuto = true;
+            }
+        }
+        else if (!strcmp(argv[i], "--bench-json") && i + 1 < argc) benchJson = argv[++i];
+        else if (!strcmp(argv[i], "--define") && i + 1 < argc) {
+            std::string d = argv[++i];
+            size_t eq = d.find('=');
+            fsDefines += "#define " + (eq == std::string::npos ? d + " 1" : d.substr(0, eq) + " " + d.substr(eq + 1)) + "\n";
+        }
+        else if (!strcmp(argv[i], "--res") && i + 1 < argc) {
+            // "N" for a square grid or "RINGSxSEGMENTS"
+            std::string res = argv[++i];
+            if (res.find('x') == std::string::npos) res += "x" + res;
+            sceneFlags.push_back({ std::string("--res ") + argv[i], sizeSetting("res", res) });
+        }
+        else {
+            std::cerr << "unknown option or missing value: " << argv[i] << "\n" << kUsage;
+            return 1;
+        }
+    }
+    for (const auto& f : sceneFlags) {
+        std::string error;
+        if (!applySceneSetting(g_scene, f.second, error)) sceneProblems.push_back(f.first + ": " + error);
+    }
+    if (!sceneProblems.empty() || !validateScene(g_scene, sceneProblems)) {
+        for (const std::string& p : sceneProblems) std::cerr << "scene: " << p << "\n";
+        return 1;
+    }
+    if (instances < 1) instances = 1;
+    int lightCount = g_scene.lightCount;
+    int width = g_scene.width, height = g_scene.height;
+    int rowRings = g_scene.rows, colSegments = g_scene.cols;
+    if (printScene) {
+        std::cout << sceneText(g_scene);
+        return 0;
+    }
+    g_camRadius = g_scene.camRadius;
+    int fixedLights = (int)g_scene.fixedLights.size();
+    if (shLights && lightTree) {
+        // the SH split already bounds the exact set; overflow spills into SH instead of a cut
+        std::cerr << "--shlights replaces --lighttree\n";
+        lightTree = false;
+    }
+    if (lightCount + fixedLights > kMaxShaderLights && !lightTree && !shLights) {
+        std::cerr << lightCount + fixedLights << " lights don't fit the shader's light block, using --lighttree\n";
+        lightTree = true;
+    }
+    if (morph && softBodyMode) {
+        // the lattice rewrites aPos every frame, which the morph path ignores
+        std::cerr << "--morph is ignored with --softbody\n";
+        morph = false;
+    }
+    if (waveGpu && softBodyMode) {
+        // the lattice needs the field on the CPU every frame; don't read it back from the GPU
+        std::cerr << "--softbody uses the CPU wave field\n";
+        waveGpu = false; waveCpu = true;
+    }
+    if (lodCycle < 0) lodCycle = 0;
+    bool galleryMode = !galleryDir.empty();
+    if (galleryMode) {
+        // every sculpture in the gallery is a still design; lights come from the sectors, thousands of them
+        if (streamRows > 0 || softBodyMode || morph || waveCpu || waveGpu || instances > 1)
+            std::cerr << "--gallery ignores --stream, --softbody, --morph, the wave fields and --instances\n";
+        streamRows = 0;
+        softBodyMode = morph = waveCpu = waveGpu = false;
+        instances = 1;
+        if (!shLights) lightTree = true;
+    }
+    bool streaming = streamRows > 0;
+    if (streaming && (softBodyMode || morph || waveCpu || waveGpu || instances > 1)) {
+        // chunks are generated once at a frozen pose; nothing re-animates them
+        std::cerr << "--stream draws one still sculpture: --softbody, --morph, the wave fields and --instances are ignored\n";
+        softBodyMode = morph = waveCpu = waveGpu = false;
+        instances = 1;
+    }
+    bool soaking = soak.durationS > 0.0 && !(benchWave || benchShader || benchUpload || benchDraw);
+    if (soaking) {
+        // the soak owns the timeline and the configuration
+        headless = true;
+        frameLimit = 0;
+        if (soak.speed <= 0.0) soak.speed = 60.0;
+        if (soak.intervalS <= 0.0) soak.intervalS = 15.0;
+        if (soak.durationS < minSoakSeconds(soak.intervalS)) {
+            std::cerr << "--soak " << soak.durationS << " is too short to judge: at --soak-interval " << soak.intervalS
+                      << " it needs at least " << minSoakSeconds(soak.intervalS) << " s\n";
+            return 1;
+        }
+    }
+    if (!screenshotPath.empty() && frameLimit <= 0) {
+        // only a fixed timeline makes the last frame the same picture every run
+        std::cerr << "--screenshot needs --frames\n";
+        screenshotPath.clear();
+    }
+    if (!capturePath.empty() && (benchWave || benchShader || benchUpload || benchDraw)) {
+        std::cerr << "--capture is ignored in benchmark modes\n";
+        capturePath.clear();
+    }
+    if (!capturePath.empty() && (uploadAuto || uploadPath == UploadPath::Persistent)) {
+        // writes through a persistent mapping never pass through a GL call, so the stream couldn't hold them;
+        // the probe would only bloat the capture
+        uploadAuto = false;
+        uploadPath = UploadPath::SubData;
+    }
+
+    // exports need no window: the frames are what makeSculpture() would upload
+    if (!exportSettings.path.empty() || !gltfPath.empty()) {
+        ThreadPool pool;
+        bool ok = true;
+        if (!gltfPath.empty()) {
+            ok = exportGltf(gltfPath, rowRings, colSegments, gltfTime, g_scene.shape, pool);
+            if (ok) std::cout << "export: " << gltfPath << " (" << rowRings << "x" << colSegments << " at t=" << gltfTime << ")\n";
+        }
+        if (!exportSettings.path.empty()) {
+            exportSettings.rows = rowRings; exportSettings.cols = colSegments;
+            exportSettings.shape = g_scene.shape;
+            ExportStats es;
+            ok = exportSequence(exportSettings, pool, &es) && ok;
+            double mb = es.bytes / (1024.0 * 1024.0);
+            // stalled on the disk most of the run -> I/O-bound; otherwise generation/encoding is the limit
+            printf("export: %s frames=%d keys=%d mb=%.1f bytes_per_vertex_frame=%.2f wall_s=%.2f mb_per_s=%.1f "
+                   "generate_s=%.2f encode_s=%.2f write_s=%.2f stall_s=%.2f bound=%s\n",
+                   exportSettings.path.c_str(), es.frames, es.keys, mb,
+                   es.frames ? (double)es.bytes / es.frames / ((double)rowRings * colSegments) : 0.0, es.wallS,
+                   es.wallS > 0.0 ? mb / es.wallS : 0.0, es.generateS, es.encodeS, es.writeS, es.stallS,
+                   es.stallS > 0.5 * es.wallS ? "io" : "cpu");
+        }
+        return ok ? 0 : 1;
+    }
+
     if (!glfwInit()) { std::cerr << "GLFW init failed\n"; return -1; }
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -176,111 +1320,644 @@ int main() {
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
-    GLFWwindow* win = glfwCreateWindow(1280, 720, "Kinetic Sculpture - Multiple Lights", nullptr, nullptr);
+    if (headless) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* win = glfwCreateWindow(headless ? 64 : width, headless ? 64 : height, "Kinetic Sculpture - Multiple Lights", nullptr, nullptr);
     if (!win) { glfwTerminate(); return -1; }
     glfwMakeContextCurrent(win);
-    glfwSwapInterval(1);
+    glfwSwapInterval(headless ? 0 : 1);
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) { std::cerr << "GLAD load failed\n"; return -1; }
+    initVertexStreams((GLADloadproc)glfwGetProcAddress);
+    initMemoryRegistry();
+    if (gpuBudgetMb > 0.0) setMemoryBudget(MemDomain::Gpu, (size_t)(gpuBudgetMb * 1024 * 1024));
+    if (cpuBudgetMb > 0.0) setMemoryBudget(MemDomain::Cpu, (size_t)(cpuBudgetMb * 1024 * 1024));
+    if (!capturePath.empty()) {
+        int fbw, fbh;
+        glfwGetFramebufferSize(win, &fbw, &fbh);
+        startGlCapture(capturePath, fbw, fbh, captureFrames);
+    }
 
     glEnable(GL_DEPTH_TEST);
 
     // load shaders
-    GLuint prog = link(
-        compile(GL_VERTEX_SHADER, readTextFile("sculpture.vs")),
-        compile(GL_FRAGMENT_SHADER, readTextFile("sculpture.fs"))
-    );
-    GLuint progLight = link(
+    // GL objects owned by handles have to be gone before the window (and its context) is
+    // the sculpture program is rebuilt from the files on a soak reload; blocks: morph weights 0, lights 1
+    auto sculptureProgram = [&]() {
+        GlProgram p(link(
+            compile(GL_VERTEX_SHADER, readTextFile("sculpture.vs")),
+            compile(GL_FRAGMENT_SHADER, withDefines(readTextFile("sculpture.fs"), fsDefines))
+        ));
+        glUniformBlockBinding(p, glGetUniformBlockIndex(p, "MorphWeights"), 0);
+        glUniformBlockBinding(p, glGetUniformBlockIndex(p, "PointLights"), 1);
+        return p;
+    };
+    GlProgram prog = sculptureProgram();
+    GlProgram progLight(link(
         compile(GL_VERTEX_SHADER, readTextFile("light_cube.vs")),
         compile(GL_FRAGMENT_SHADER, readTextFile("light_cube.fs"))
-    );
+    ));
+    Hud hud = makeHud(link(compile(GL_VERTEX_SHADER, readTextFile("hud.vs")), compile(GL_FRAGMENT_SHADER, readTextFile("hud.fs"))));
+    hud.visible = showHud;
+    bool hudKeyDown = false;
 
-    Mesh sculpture = makeSculpture();
+    // before the pool so its workers inherit the counters, after the context so driver threads don't
+    if (perfCounters && !openPerfCounters(g_perf))
+        std::cerr << "no hardware counters (perf_event_open failed; see /proc/sys/kernel/perf_event_paranoid)\n";
+    ThreadPool pool;
+    if (benchWave || benchShader || benchUpload || benchDraw) {
+        if (benchWave) benchWaveField(pool);
+        if (benchUpload) benchUploads(benchJson);
+        if (benchDraw) benchDraws(benchJson);
+        // fixed coverage unless asked otherwise: 1280x720 x 256 lights is minutes per variant on llvmpipe
+        if (benchShader) benchShaders(sizeGiven ? width : 512, sizeGiven ? height : 512, benchJson);
+        destroyHud(hud);
+        prog.reset(); progLight.reset();
+        glfwDestroyWindow(win); glfwTerminate();
+        return 0;
+    }
+
+    // a coarser sculpture rather than a blown budget: the mesh lands on the GPU and, while it's built, on the CPU
+    auto meshBytes = [](int rings, int segments) {
+        return (size_t)rings * segments * 8 * sizeof(float) + (size_t)(rings - 1) * segments * 6 * sizeof(unsigned int);
+    };
+    int askedRings = rowRings, askedSegments = colSegments;
+    while ((!memoryFits(MemDomain::Gpu, meshBytes(rowRings, colSegments)) || !memoryFits(MemDomain::Cpu, meshBytes(rowRings, colSegments)))
+           && (rowRings > 2 || colSegments > 3)) {
+        rowRings = rowRings / 2 > 2 ? rowRings / 2 : 2;
+        colSegments = colSegments / 2 > 3 ? colSegments / 2 : 3;
+    }
+    if (rowRings != askedRings)
+        std::cerr << "a " << askedRings << "x" << askedSegments << " sculpture doesn't fit the memory budget, using "
+                  << rowRings << "x" << colSegments << "\n";
+    if (morph && !memoryFits(MemDomain::Gpu, (size_t)defaultMorphShapes().size() * rowRings * colSegments * 16)) {
+        std::cerr << "morph targets don't fit the GPU budget, --morph is off\n";
+        morph = false;
+    }
+
+    // with a simulated field the VBO holds the undisplaced surface and the field drives the radius
+    WaveField field;
+    WaveFieldGpu fieldGpu;
+    GlTexture fieldCpuTex;
+    GLuint fieldTex = 0;                // fieldCpuTex, or whichever of fieldGpu's is current
+    if (waveCpu) {
+        field = makeWaveField(rowRings, colSegments);
+        trackCpu(&field, MemTag::WaveField, (field.prev.size() + field.cur.size() + field.next.size()) * sizeof(float));
+        fieldCpuTex = makeFieldTexture(rowRings, colSegments);
+        fieldTex = fieldCpuTex;
+    }
+    if (waveGpu) fieldGpu = makeWaveFieldGpu(rowRings, colSegments);
+    std::vector<float> flat;
+    if (waveCpu || waveGpu) flat.assign((size_t)rowRings * colSegments, 0.0f);
+    BufferPool meshBuffers;
+    Mesh sculpture = makeSculpture(meshBuffers, indexLayout, rowRings, colSegments, flat.empty() ? nullptr : flat.data(), &pool);
     LightCube cube = makeLightCube();
 
+    // morph targets; with --morph off the weight block is still bound but says "0 targets"
+    MorphTargets morphs = makeMorphTargets(morph ? defaultMorphShapes() : std::vector<SculptureShape>(), rowRings, colSegments);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, morphs.ubo);
+    if (morph) {
+        // vertex fetch per vertex: the static VBO stream plus 16 bytes per target with a non-zero weight
+        double packedMB = (double)morphs.count * morphs.vertexCount * 16 / (1024.0 * 1024.0);
+        std::cout << "morph: " << morphs.count << " targets, " << packedMB << " MB packed; vertex fetch "
+                  << 32 + 16 << " B/vertex holding, " << 32 + 2 * 16 << " B/vertex cross-fading (static mesh: 32 B), "
+                  << (32 + 2 * 16) * (double)morphs.vertexCount / (1024.0 * 1024.0) << " MB/frame worst case\n";
+    }
+
+    // lights go to the shader through one uniform block, binding point 1
+    std::vector<PointLight> lights = makeLights(lightCount, g_scene);
+    std::vector<PointLight> shaded;
+    std::vector<GpuPointLight> lightBlock;
+    LightTree tree;
+    LightCutSettings cutSettings;
+    std::vector<PointLight> farLights;
+    ShSplitSettings shSettings;
+    ShProbe shProbe;
+    GlBuffer lightUbo = genBuffer();
+    glBindBuffer(GL_UNIFORM_BUFFER, lightUbo);
+    glBufferData(GL_UNIFORM_BUFFER, kMaxShaderLights * sizeof(GpuPointLight), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    trackGpu(GpuObject::Buffer, lightUbo, MemTag::Lights, kMaxShaderLights * sizeof(GpuPointLight));
+    glBindBufferBase(GL_UNIFORM_BUFFER, 1, lightUbo);
+    // cut selection bounds: the sculpture plus headroom for the wave field, or every morph target
+    glm::vec3 objMin = sculpture.bmin * 1.3f, objMax = sculpture.bmax * 1.3f;
+    if (morph) { objMin = glm::min(objMin, morphs.bmin); objMax = glm::max(objMax, morphs.bmax); }
+    if (instances > 1) {
+        // one cut / probe for the whole grid of sculptures
+        glm::vec3 corner = instanceOffset(0, instances);
+        objMin += corner; objMax -= corner;
+        g_camRadius = cameraRadius(instances);
+    }
+    int frameIndex = 0;
+
+    OffscreenTarget offscreen;
+    if (headless) offscreen = makeOffscreenTarget(width, height);
+    GpuTimer gpuTimer = makeGpuTimer();
+    FrameStats stats;
+    Telemetry telemetry;
+    bool telemetryOn = !telemetrySettings.shmName.empty() || !telemetrySettings.metricsPath.empty();
+    if (telemetryOn) startTelemetry(telemetry, telemetrySettings);
+    size_t uploadBytes = 0;             // this frame's buffer and texture uploads, for telemetry
+    uint64_t frameAllocations = 0;
+    double frameStart = processMs();
+
+    // soft-body state; the wave surface is recomputed each frame as the driving target
+    std::vector<float> waveVerts, simVerts;
+    SoftBody body;
+    if (softBodyMode) {
+        sculptureVertices(waveVerts, sculpture.rows, sculpture.cols, g_time, waveCpu ? waveDisplacement(field) : nullptr,
+                          g_scene.shape, g_kernel, &pool);
+        simVerts = waveVerts;
+        body = makeSoftBody(waveVerts.data(), 8, sculpture.rows, sculpture.cols);
+        trackCpu(&waveVerts, MemTag::SoftBody, waveVerts.size() * sizeof(float));
+        trackCpu(&simVerts, MemTag::SoftBody, simVerts.size() * sizeof(float));
+        trackCpu(&body, MemTag::SoftBody, (body.px.size() * 9 + body.rest.size() + body.stiff.size()) * sizeof(float)
+                                          + (body.ca.size() + body.cb.size() + body.batchStart.size()) * sizeof(int));
+    }
+
+    // the lattice re-uploads every vertex each frame: stream it through whichever path this driver is best at
+    VertexStream stream;
+    GLint baseVertex = 0;
+    if (softBodyMode) {
+        size_t bytes = simVerts.size() * sizeof(float);
+        if (uploadAuto) {
+            std::vector<UploadTiming> probe;
+            uploadPath = probeUploadPath(bytes, &probe);
+            std::cout << "upload probe (" << bytes / 1024 << " KB/frame):";
+            for (const UploadTiming& t : probe) std::cout << " " << uploadPathName(t.path) << " " << (int)t.mbPerS << " MB/s";
+            std::cout << " -> " << uploadPathName(uploadPath) << "\n";
+        }
+        bool ring = uploadPath == UploadPath::MapRing || uploadPath == UploadPath::Persistent;
+        if (ring && !memoryFits(MemDomain::Gpu, bytes * kRingRegions)) {
+            std::cerr << "a " << kRingRegions << "-region ring doesn't fit the GPU budget, streaming with subdata\n";
+            uploadPath = UploadPath::SubData;
+        }
+        stream = makeVertexStream(uploadPath, bytes);
+        uploadPath = stream.path;
+        glBindVertexArray(sculpture.vao);
+        sculptureAttribs(stream.vbo);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        sculpture.vbo = PooledBuffer();
+    }
+    // level L halves the grid L times; the field, lattice and morph targets are sized to the full grid
+    const int kLodLevels = 4;
+    int lodLevel = 0;
+    bool lodFixed = softBodyMode || morph || waveCpu || waveGpu || streaming || galleryMode, lodKeyDown = false;
+    int lodWanted = -1;
+    if (lodFixed && lodCycle > 0) {
+        std::cerr << "--lod-cycle is ignored with --softbody, --morph, the wave fields, --stream and --gallery\n";
+        lodCycle = 0;
+    }
+    if (lodFixed && lodStart > 0) std::cerr << "--lod is ignored with --softbody, --morph, the wave fields, --stream and --gallery\n";
+    else if (lodStart > 0) lodWanted = std::min(lodStart, kLodLevels - 1);     // rebuilt on frame 0, same pose
+    // out-of-core sculpture: replaces the mesh in the draw; the mesh still stands in for the bounds
+    SculptureStream streamed;
+    if (streaming) {
+        StreamSettings ss;
+        ss.rows = streamRows; ss.cols = streamCols;
+        ss.gpuBytes = (size_t)(streamBudgetMb * 1024.0 * 1024.0);
+        ss.time = g_time;
+        ss.shape = g_scene.shape;
+        if (ss.shape.twist != 0.0f) {
+            // chunks are cut from an untwisted cross-section
+            std::cerr << "--stream ignores shape.twist\n";
+            ss.shape.twist = 0.0f;
+        }
+        if (!startSculptureStream(streamed, ss)) streaming = false;
+    }
+    // soak: one sample per interval; the clock is checked against an exact timeline
+    std::vector<SoakSample> soakSamples;
+    SoakStep soakStep = SoakStep::Baseline;
+    double soakWindowStart = processMs(), soakStartMs = soakWindowStart, soakClockError = 0.0;
+    long long soakWindowFrames = 0;
+    bool lightsChanged = false;
+    double lastTime = g_time;
+    // the gallery replaces the sculpture and its lights; the world is generated on first use
+    GalleryStream gallery;
+    if (galleryMode) {
+        GalleryWorld world;
+        if (!readGalleryWorld(galleryDir, world)) {
+            std::cout << "gallery: generating " << gallerySize << "x" << gallerySize << " sectors in " << galleryDir << "\n";
+            galleryMode = makeGalleryWorld(galleryDir, gallerySize) && readGalleryWorld(galleryDir, world);
+        }
+        if (galleryMode) {
+            GallerySettings gs;
+            gs.gpuBytes = (size_t)(galleryBudgetMb * 1024.0 * 1024.0);
+            startGallery(gallery, world, gs, meshBuffers);
+            glm::vec2 extent(world.sectorsX * world.sectorSize, world.sectorsZ * world.sectorSize);
+            g_walk = true;
+            g_walkCenter = extent * 0.5f;
+            g_walkHalf = extent * 0.4f;
+            lights.clear();
+            lightsChanged = true;
+        }
+    }
+    int phaseWave = perfPhase(g_perf, "wave-field"), phaseSoftBody = perfPhase(g_perf, "softbody");
+    int phaseLights = perfPhase(g_perf, "lights"), phaseDraw = perfPhase(g_perf, "draw");
+
     // material constants
-    glm::vec3 matAmbient(0.15f);
-    glm::vec3 matDiffuse(0.7f, 0.75f, 0.8f);
-    glm::vec3 matSpecular(0.9f);
-    float shininess = 48.0f;
+    SceneWatch sceneWatch;
+    if (!scenePath.empty()) watchScene(sceneWatch, scenePath);
+    bool meshStale = false;
 
-    while (!glfwWindowShouldClose(win)) {
-        g_time = (float)glfwGetTime();
+    while (!glfwWindowShouldClose(win) && (frameLimit <= 0 || frameIndex < frameLimit)) {
+        double now = processMs();
+        if (frameIndex > 0) stats.frameMs.push_back(now - frameStart);
+        frameStart = now;
+        PROBE1(frame_begin, frameIndex);
+        uploadBytes = 0;
+        frameAllocations = heapAllocations();
+        collectGpuTimer(gpuTimer, stats.gpuMs, false);
+        beginGpuTimer(gpuTimer, stats.gpuMs);
+        // a fixed frame count means a benchmark run: same timeline every time, independent of speed
+        g_time = frameLimit > 0 ? frameIndex / 60.0 : glfwGetTime();
+        if (soaking) {
+            g_time = frameIndex * soak.speed / 60.0;
+            // what the renderer is handed is a float phase: how far the spin's is from the exact one, as time
+            double spin = fabs(g_scene.spinSpeed) > 1e-6f ? g_scene.spinSpeed : 1.0;
+            double exact = fmod(g_time * spin, glm::two_pi<double>());
+            soakClockError = std::max(soakClockError, fabs(phaseAt(g_time, spin) - exact) / fabs(spin));
+        }
         glfwPollEvents();
+        float dt = (float)(g_time - lastTime); lastTime = g_time;
 
-        int w, h; glfwGetFramebufferSize(win, &w, &h);
+        // live scene edits: uniforms and speeds are read every frame, lights and the mesh are rebuilt
+        if (sceneChanged(sceneWatch, processMs())) {
+            SceneConfig next;
+            std::vector<std::string> problems;
+            if (!loadScene(scenePath, sceneOverrides, next, problems)) {
+                for (const std::string& p : problems) std::cerr << "scene: " << p << "\n";
+                std::cerr << "scene: keeping the running configuration\n";
+            } else {
+                SceneConfig previous = g_scene;
+                SceneReload r = reloadScene(g_scene, sceneLoaded, next);
+                sceneLoaded = next;
+                if (r.shape && lodFixed) {
+                    // the lattice, morph targets, wave fields and streamed chunks were built for the old shape
+                    g_scene.shape = previous.shape;
+                    r.restart.push_back("shape (in this mode)");
+                } else if (r.shape) {
+                    meshStale = true;
+                }
+                int total = (int)lights.size() - fixedLights + (int)g_scene.fixedLights.size();
+                if (r.lights && !lightTree && !shLights && total > kMaxShaderLights) {
+                    g_scene.fixedLights = previous.fixedLights;
+                    r.restart.push_back("light (more than the shader's light block holds)");
+                } else if (r.lights && !galleryMode) {
+                    lights = makeLights((int)lights.size() - fixedLights, g_scene);
+                    fixedLights = (int)g_scene.fixedLights.size();
+                    lightsChanged = true;
+                }
+                g_camRadius = cameraRadius(instances);
+                std::cout << "scene: reloaded " << scenePath << "\n";
+                for (const std::string& k : r.restart) std::cout << "scene: " << k << " takes effect on restart\n";
+            }
+        }
+
+        int lod = lodLevel;
+        if (lodCycle > 0 && frameIndex > 0 && frameIndex % lodCycle == 0) lod = (lodLevel + 1) % kLodLevels;
+        if (lodWanted >= 0) { lod = lodWanted; lodWanted = -1; }
+        bool coarser = glfwGetKey(win, GLFW_KEY_LEFT_BRACKET) == GLFW_PRESS;
+        bool finer = glfwGetKey(win, GLFW_KEY_RIGHT_BRACKET) == GLFW_PRESS;
+        if (!lodKeyDown && coarser && lod < kLodLevels - 1) ++lod;
+        if (!lodKeyDown && finer && lod > 0) --lod;
+        lodKeyDown = coarser || finer;
+        if ((lod != lodLevel || meshStale) && !lodFixed) {
+            meshStale = false;
+            lodLevel = lod;
+            // release first: the old buffers go back to the pool before the new mesh asks for storage
+            sculpture = Mesh();
+            sculpture = makeSculpture(meshBuffers, indexLayout, rowRings >> lod > 2 ? rowRings >> lod : 2,
+                                      colSegments >> lod > 3 ? colSegments >> lod : 3, nullptr, &pool);
+        }
+
+        beginPerfPhase(g_perf, phaseWave);
+        if (waveCpu) {
+            stepWaveField(field, dt < 1.0f / 30.0f ? dt : 1.0f / 30.0f, g_time, pool);
+            if (!softBodyMode) {
+                glBindTexture(GL_TEXTURE_2D, fieldTex);
+                double t0 = PROBE_ENABLED(buffer_upload) ? processMs() : 0.0;
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, colSegments, rowRings, GL_RED, GL_FLOAT, waveDisplacement(field));
+                glBindTexture(GL_TEXTURE_2D, 0);
+                uploadBytes += (size_t)rowRings * colSegments * sizeof(float);
+                if (PROBE_ENABLED(buffer_upload))
+                    PROBE3(buffer_upload, "wave-field", (long long)rowRings * colSegments * (long long)sizeof(float),
+                           (long long)((processMs() - t0) * 1e3));
+            }
+        }
+        if (waveGpu) {
+            stepWaveFieldGpu(fieldGpu, defaultWaveSettings(), dt < 1.0f / 30.0f ? dt : 1.0f / 30.0f, g_time);
+            fieldTex = fieldGpu.tex[fieldGpu.cur];
+        }
+        endPerfPhase(g_perf, phaseWave);
+
+        if (softBodyMode) {
+            beginPerfPhase(g_perf, phaseSoftBody);
+            double t0 = PROBE_ENABLED(mesh_regen) ? processMs() : 0.0;
+            sculptureVertices(waveVerts, sculpture.rows, sculpture.cols, g_time, waveCpu ? waveDisplacement(field) : nullptr,
+                              g_scene.shape, g_kernel, &pool);
+            if (PROBE_ENABLED(mesh_regen))
+                PROBE4(mesh_regen, sculpture.rows, sculpture.cols, (long long)(waveVerts.size() * sizeof(float)),
+                       (long long)((processMs() - t0) * 1e3));
+            // clamp so a hitch doesn't blow the explicit drive step up
+            stepSoftBody(body, waveVerts.data(), 8, dt < 1.0f / 30.0f ? dt : 1.0f / 30.0f, pool);
+            writeSoftBodyVertices(body, simVerts.data(), 8, pool);
+            baseVertex = (GLint)(uploadVertexStream(stream, simVerts.data()) / (8 * sizeof(float)));
+            uploadBytes += stream.bytes;
+            endPerfPhase(g_perf, phaseSoftBody);
+        }
+
+        int w = offscreen.width, h = offscreen.height;
+        if (headless) glBindFramebuffer(GL_FRAMEBUFFER, offscreen.fbo);
+        else glfwGetFramebufferSize(win, &w, &h);
         glViewport(0, 0, w, h);
         glClearColor(0.02f, 0.02f, 0.035f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glm::mat4 proj = glm::perspective(glm::radians(45.0f), w > 0 ? (float)w / h : 1.0f, 0.1f, 100.0f);
+        float farPlane = g_camRadius * 4.0f > 100.0f ? g_camRadius * 4.0f : 100.0f;
+        if (galleryMode) farPlane = gallery.settings.loadRadius * 1.5f;
+        glm::mat4 proj = glm::perspective(glm::radians(g_scene.fov), w > 0 ? (float)w / h : 1.0f, g_scene.nearPlane, farPlane);
         glm::mat4 view = makeView();
 
-        // === animate lights gently ===
-        for (int i = 0; i < 4; ++i) {
-            float phase = i * glm::half_pi<float>();
-            pointLights[i].x = 1.8f * sin(g_time * 0.7f + phase);
-            pointLights[i].z = 1.8f * cos(g_time * 0.7f + phase);
-            pointLights[i].y = 1.0f + 0.4f * sin(g_time * 1.3f + i);
+        if (galleryMode) {
+            updateGallery(gallery, proj, view);
+            if (gallery.lightsChanged) {
+                lights = gallery.lights;
+                lightsChanged = true;
+                gallery.lightsChanged = false;
+            }
+            // one cut for the room around the walker
+            glm::vec3 eye = glm::vec3(glm::inverse(view)[3]);
+            float half = gallery.world.sectorSize * 0.5f;
+            objMin = glm::vec3(eye.x - half, 0.0f, eye.z - half);
+            objMax = glm::vec3(eye.x + half, 6.0f, eye.z + half);
+        }
+
+        beginPerfPhase(g_perf, phaseLights);
+        if (!galleryMode) animateLights(lights, g_time, g_scene);
+
+        // lights the sculpture is shaded with: all of them, or a cut of the light tree
+        shaded.clear();
+        if (lightTree) {
+            // refit is cheap; re-sort now and then so moving lights don't bloat the upper nodes
+            if (frameIndex % 30 == 0 || lightsChanged) buildLightTree(tree, lights, pool);
+            else refitLightTree(tree, lights, pool);
+            selectCut(tree, lights, objMin, objMax, cutSettings, shaded);
+        } else if (shLights) {
+            // one probe at the middle of the sculpture; fine for lights well outside it
+            splitLights(lights, objMin, objMax, shSettings, shaded, farLights);
+            projectLightsSH(farLights, (objMin + objMax) * 0.5f, shProbe, pool);
+        } else {
+            shaded = lights;
         }
+        lightsChanged = false;
+        lightBlock.clear();
+        for (const PointLight& L : shaded) lightBlock.push_back(packLight(L));
+        double uploadStart = PROBE_ENABLED(buffer_upload) ? processMs() : 0.0;
+        glBindBuffer(GL_UNIFORM_BUFFER, lightUbo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, lightBlock.size() * sizeof(GpuPointLight), lightBlock.data());
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        uploadBytes += lightBlock.size() * sizeof(GpuPointLight);
+        if (PROBE_ENABLED(buffer_upload))
+            PROBE3(buffer_upload, "lights", (long long)(lightBlock.size() * sizeof(GpuPointLight)),
+                   (long long)((processMs() - uploadStart) * 1e3));
+        endPerfPhase(g_perf, phaseLights);
+        ++frameIndex;
 
         // === draw sculpture ===
+        beginPerfPhase(g_perf, phaseDraw);
         glUseProgram(prog);
         glUniformMatrix4fv(glGetUniformLocation(prog, "uProj"), 1, GL_FALSE, glm::value_ptr(proj));
         glUniformMatrix4fv(glGetUniformLocation(prog, "uView"), 1, GL_FALSE, glm::value_ptr(view));
 
-        // world transform (slow spin)
-        glm::mat4 model(1.0f);
-        model = glm::rotate(model, g_time * 0.25f, glm::vec3(0, 1, 0));
-        glUniformMatrix4fv(glGetUniformLocation(prog, "uModel"), 1, GL_FALSE, glm::value_ptr(model));
-
         // material
-        glUniform3fv(glGetUniformLocation(prog, "material.ambient"), 1, glm::value_ptr(matAmbient));
-        glUniform3fv(glGetUniformLocation(prog, "material.diffuse"), 1, glm::value_ptr(matDiffuse));
-        glUniform3fv(glGetUniformLocation(prog, "material.specular"), 1, glm::value_ptr(matSpecular));
-        glUniform1f(glGetUniformLocation(prog, "material.shininess"), shininess);
+        glUniform3fv(glGetUniformLocation(prog, "material.ambient"), 1, glm::value_ptr(g_scene.matAmbient));
+        glUniform3fv(glGetUniformLocation(prog, "material.diffuse"), 1, glm::value_ptr(g_scene.matDiffuse));
+        glUniform3fv(glGetUniformLocation(prog, "material.specular"), 1, glm::value_ptr(g_scene.matSpecular));
+        glUniform1f(glGetUniformLocation(prog, "material.shininess"), g_scene.shininess);
 
         // camera position for specular
         glm::vec3 camPos = glm::vec3(glm::inverse(view)[3]);
         glUniform3fv(glGetUniformLocation(prog, "uViewPos"), 1, glm::value_ptr(camPos));
 
         // directional light
-        glUniform3f(glGetUniformLocation(prog, "dirLight.direction"), -0.2f, -1.0f, -0.3f);
-        glUniform3f(glGetUniformLocation(prog, "dirLight.ambient"), 0.04f, 0.04f, 0.05f);
-        glUniform3f(glGetUniformLocation(prog, "dirLight.diffuse"), 0.25f, 0.25f, 0.3f);
-        glUniform3f(glGetUniformLocation(prog, "dirLight.specular"), 0.3f, 0.3f, 0.35f);
-
-        // 4 point lights
-        for (int i = 0; i < 4; ++i) {
-            std::string base = "pointLights[" + std::to_string(i) + "]";
-            glUniform3fv(glGetUniformLocation(prog, (base + ".position").c_str()), 1, glm::value_ptr(pointLights[i]));
-            glUniform3f(glGetUniformLocation(prog, (base + ".ambient").c_str()), 0.02f, 0.02f, 0.02f);
-            glUniform3f(glGetUniformLocation(prog, (base + ".diffuse").c_str()), 0.9f, 0.9f, 0.9f);
-            glUniform3f(glGetUniformLocation(prog, (base + ".specular").c_str()), 1.0f, 1.0f, 1.0f);
-            glUniform1f(glGetUniformLocation(prog, (base + ".constant").c_str()), 1.0f);
-            glUniform1f(glGetUniformLocation(prog, (base + ".linear").c_str()), 0.14f);
-            glUniform1f(glGetUniformLocation(prog, (base + ".quadratic").c_str()), 0.07f);
+        glUniform3fv(glGetUniformLocation(prog, "dirLight.direction"), 1, glm::value_ptr(g_scene.sunDirection));
+        glUniform3fv(glGetUniformLocation(prog, "dirLight.ambient"), 1, glm::value_ptr(g_scene.sunAmbient));
+        glUniform3fv(glGetUniformLocation(prog, "dirLight.diffuse"), 1, glm::value_ptr(g_scene.sunDiffuse));
+        glUniform3fv(glGetUniformLocation(prog, "dirLight.specular"), 1, glm::value_ptr(g_scene.sunSpecular));
+
+        // point lights (the block itself was filled above)
+        glUniform1i(glGetUniformLocation(prog, "uPointLightCount"), (GLint)lightBlock.size());
+        glUniform1i(glGetUniformLocation(prog, "uShEnabled"), shLights);
+        if (shLights) {
+            glUniform3fv(glGetUniformLocation(prog, "uShIrradiance"), 9, glm::value_ptr(shProbe.irradiance[0]));
+            glUniform3fv(glGetUniformLocation(prog, "uShAmbient"), 1, glm::value_ptr(shProbe.ambient));
         }
 
+        // simulated wave field, unless the soft body already baked it into the vertices
+        bool waveTex = (waveCpu || waveGpu) && !softBodyMode;
+        glUniform1i(glGetUniformLocation(prog, "uWaveTex"), waveTex);
+        glUniform1i(glGetUniformLocation(prog, "uWaveField"), 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, waveTex ? fieldTex : 0);
+
+        if (morph) updateMorphWeights(morphs, g_time);
+        glUniform1i(glGetUniformLocation(prog, "uMorphTargets"), 1);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_BUFFER, morphs.texture);
+        glActiveTexture(GL_TEXTURE0);
+
+        // world transform (slow spin), one draw per sculpture
+        GLint modelLoc = glGetUniformLocation(prog, "uModel");
+        if (streaming) {
+            // this frame's view for the draw, the next 1.5 s of the orbit for prefetch
+            glm::mat4 spin = glm::rotate(glm::mat4(1.0f), phaseAt(g_time, g_scene.spinSpeed), glm::vec3(0, 1, 0));
+            StreamView cur{ proj, view, spin, (float)h };
+            std::vector<StreamView> ahead;
+            for (int k = 1; k <= 3; ++k) {
+                double t = g_time + 0.5 * k;
+                ahead.push_back({ proj, makeViewAt(t), glm::rotate(glm::mat4(1.0f), phaseAt(t, g_scene.spinSpeed), glm::vec3(0, 1, 0)), (float)h });
+            }
+            updateSculptureStream(streamed, cur, ahead);
+            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(spin));
+            drawSculptureStream(streamed);
+        }
+        if (galleryMode) drawGallery(gallery, modelLoc);
         glBindVertexArray(sculpture.vao);
-        glDrawElements(GL_TRIANGLES, sculpture.indexCount, GL_UNSIGNED_INT, 0);
+        for (int i = 0; i < instances && !streaming && !galleryMode; ++i) {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), instanceOffset(i, instances));
+            model = glm::rotate(model, phaseAt(g_time, g_scene.spinSpeed), glm::vec3(0, 1, 0));
+            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+            glDrawElementsBaseVertex(sculpture.mode, sculpture.indexCount, GL_UNSIGNED_INT, 0, baseVertex);
+        }
         glBindVertexArray(0);
+        if (softBodyMode) fenceVertexStream(stream);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_BUFFER, 0); glActiveTexture(GL_TEXTURE0);
 
         // === draw light cubes ===
         glUseProgram(progLight);
         glUniformMatrix4fv(glGetUniformLocation(progLight, "uProj"), 1, GL_FALSE, glm::value_ptr(proj));
         glUniformMatrix4fv(glGetUniformLocation(progLight, "uView"), 1, GL_FALSE, glm::value_ptr(view));
         glBindVertexArray(cube.vao);
-        for (int i = 0; i < 4; ++i) {
-            glm::mat4 m(1.0f); m = glm::translate(m, pointLights[i]);
-            glUniformMatrix4fv(glGetUniformLocation(progLight, "uModel"), 1, GL_FALSE, glm::value_ptr(m));
+        GLint cubeModel = glGetUniformLocation(progLight, "uModel");
+        for (const PointLight& L : lights) {
+            glm::mat4 m(1.0f); m = glm::translate(m, L.position);
+            glUniformMatrix4fv(cubeModel, 1, GL_FALSE, glm::value_ptr(m));
             glDrawElements(GL_TRIANGLES, cube.count, GL_UNSIGNED_INT, 0);
         }
         glBindVertexArray(0);
 
+        // === HUD ===
+        long long sculptureTriangles = galleryMode ? gallery.stats.triangles
+                                     : streaming ? streamed.stats.triangles : (long long)instances * sculpture.triangles;
+        if (hud.visible) {
+            HudStats hs;
+            hs.drawCalls = (galleryMode ? gallery.stats.drawn : streaming ? streamed.stats.drawn : instances)
+                         + (int)lights.size() + 1;
+            hs.triangles = sculptureTriangles + (long long)lights.size() * cube.count / 3;
+            hs.lights = (int)lightBlock.size();
+            drawHud(hud, hs, w, h);
+        }
+        if (!screenshotPath.empty() && frameIndex == frameLimit && !writeFramePpm(screenshotPath, w, h))
+            std::cerr << "can't write " << screenshotPath << "\n";
+        if (headless) glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        endPerfPhase(g_perf, phaseDraw);
+
+        stats.cpuMs.push_back(processMs() - frameStart);
+        double swapStart = PROBE_ENABLED(swap) ? processMs() : 0.0;
         glfwSwapBuffers(win);
+        glCaptureFrame();
+        if (PROBE_ENABLED(swap)) PROBE2(swap, frameIndex - 1, (long long)((processMs() - swapStart) * 1e3));
+        PROBE3(frame_end, frameIndex - 1, (long long)(stats.cpuMs.back() * 1e3),
+               (long long)(stats.frameMs.empty() ? 0.0 : stats.frameMs.back() * 1e3));
+        if (telemetryOn) {
+            TelemetryRecord rec;
+            rec.frame = (uint64_t)(frameIndex - 1);
+            rec.timeS = processMs() * 1e-3;
+            rec.frameMs = stats.frameMs.empty() ? 0.0f : (float)stats.frameMs.back();
+            rec.cpuMs = (float)stats.cpuMs.back();
+            rec.gpuMs = stats.gpuMs.empty() ? 0.0f : (float)stats.gpuMs.back();
+            rec.lights = (uint32_t)lightBlock.size();
+            rec.triangles = (uint64_t)sculptureTriangles + (uint64_t)lights.size() * cube.count / 3;
+            rec.uploadBytes = uploadBytes;
+            rec.allocations = heapAllocations() - frameAllocations;
+            rec.gpuBytes = memoryUsage(MemDomain::Gpu).current;
+            rec.cpuBytes = memoryUsage(MemDomain::Cpu).current;
+            publishTelemetry(telemetry, rec);
+        }
+        endGpuTimer(gpuTimer); // after the swap so drivers that rasterize on flush (llvmpipe) are counted
+        if (frameIndex == 1) stats.startupMs = processMs();
+        pushHudFrame(hud, stats.frameMs.empty() ? 0.0f : (float)stats.frameMs.back(), (float)stats.cpuMs.back(),
+                     stats.gpuMs.empty() ? 0.0f : (float)stats.gpuMs.back());
         if (glfwGetKey(win, GLFW_KEY_ESCAPE) == GLFW_PRESS) glfwSetWindowShouldClose(win, 1);
+        bool hudKey = glfwGetKey(win, GLFW_KEY_H) == GLFW_PRESS;
+        if (hudKey && !hudKeyDown) hud.visible = !hud.visible;
+        hudKeyDown = hudKey;
+
+        // without --stats or --samples nobody reads the whole history; an installation runs for weeks
+        if (!printStats && samplesPath.empty() && stats.frameMs.size() >= 65536) {
+            stats.frameMs.clear(); stats.cpuMs.clear(); stats.gpuMs.clear();
+        }
+        ++soakWindowFrames;
+        if (soaking && processMs() - soakWindowStart >= soak.intervalS * 1000.0) {
+            SoakSample sample;
+            sample.step = soakStep;
+            sample.wallS = (processMs() - soakStartMs) * 1e-3;
+            sample.timelineS = frameIndex * soak.speed / 60.0;
+            sample.frames = soakWindowFrames;
+            sample.rssMb = sampleProcessMemory().rssBytes / (1024.0 * 1024.0);
+            sample.gpuObjects = memoryUsage(MemDomain::Gpu).objects;
+            sample.gpuMb = memoryUsage(MemDomain::Gpu).current / (1024.0 * 1024.0);
+            sample.cpuMb = memoryUsage(MemDomain::Cpu).current / (1024.0 * 1024.0);
+            SampleSummary frame = summarize(stats.frameMs);
+            sample.frameP50Ms = frame.p50; sample.frameP99Ms = frame.p99;
+            sample.clockErrorS = soakClockError;
+            sample.stepFrames = (nextafter(g_time, INFINITY) - g_time) * 60.0;
+            soakSamples.push_back(sample);
+            // each window is its own distribution; the vectors would otherwise grow for the whole run
+            stats.frameMs.clear(); stats.cpuMs.clear(); stats.gpuMs.clear();
+            soakWindowStart = processMs(); soakWindowFrames = 0; soakClockError = 0.0;
+            if (sample.wallS >= soak.durationS) break;
+
+            // every step sets the whole configuration, so a step always looks the same
+            soakStep = (SoakStep)(((int)soakStep + 1) % kSoakSteps);
+            if (!lodFixed) lodWanted = soakStep == SoakStep::Coarser ? 1 : 0;
+            int wantedLights = lightCount;
+            if (soakStep == SoakStep::MoreLights) {
+                wantedLights = lightCount * 4 > 16 ? lightCount * 4 : 16;
+                if (!lightTree && !shLights && wantedLights > kMaxShaderLights) wantedLights = kMaxShaderLights;
+            }
+            if ((int)lights.size() != wantedLights + fixedLights && !galleryMode) {
+                lights = makeLights(wantedLights, g_scene);
+                lightsChanged = true;
+            }
+            if (soakStep == SoakStep::Reload) prog = sculptureProgram();
+        }
+    }
+
+    if (printStats || !samplesPath.empty()) {
+        glFinish();
+        collectGpuTimer(gpuTimer, stats.gpuMs, true);
+    }
+    if (!samplesPath.empty() && !writeSamplesJson(stats, samplesPath, g_perf.open ? perfJson(g_perf) : std::string()))
+        std::cerr << "can't write " << samplesPath << "\n";
+    if (printStats) {
+        double meshMB = (double)sculpture.rows * sculpture.cols * 8 * sizeof(float) / (1024.0 * 1024.0)
+                      + (double)sculpture.indexCount * sizeof(unsigned int) / (1024.0 * 1024.0);
+        char extra[768];
+        snprintf(extra, sizeof(extra),
+                 "rows=%d cols=%d instances=%d lights=%d width=%d height=%d variant=%s triangles=%lld mesh_mb=%.3f threads=%d "
+                 "upload_path=%s buffer_pool_reused=%llu buffer_pool_created=%llu index_layout=%s topologies=%d "
+                 "topology_uploads=%llu stream=%d stream_resident=%d stream_slots=%d stream_uploads=%llu "
+                 "stream_evictions=%llu gallery=%d gallery_sectors=%d gallery_meshes=%d gallery_mesh_mb=%.3f "
+                 "gallery_mesh_uploads=%llu gallery_evictions=%llu gallery_drawn=%d",
+                 streaming ? streamed.settings.rows : sculpture.rows, streaming ? streamed.settings.cols : sculpture.cols, instances, (int)lights.size(), width, height,
+                 lightTree ? "lighttree" : shLights ? "shlights" : "default",
+                 (galleryMode ? gallery.stats.triangles
+                  : streaming ? streamed.stats.triangles : (long long)instances * sculpture.triangles)
+                     + (long long)lights.size() * cube.count / 3,
+                 meshMB, pool.size(), softBodyMode ? uploadPathName(uploadPath) : "none",
+                 (unsigned long long)meshBuffers.stats.reused, (unsigned long long)meshBuffers.stats.created,
+                 indexLayoutName(indexLayout), topologyStats().live, (unsigned long long)topologyStats().uploads, streaming,
+                 streamed.stats.resident, streamed.stats.slots, (unsigned long long)streamed.stats.uploaded,
+                 (unsigned long long)streamed.stats.evicted, galleryMode, gallery.stats.sectorsLoaded,
+                 gallery.stats.meshesResident, gallery.stats.meshBytes / (1024.0 * 1024.0),
+                 (unsigned long long)gallery.stats.meshUploads, (unsigned long long)gallery.stats.meshEvictions,
+                 gallery.stats.drawn);
+        std::cout << statsLine(stats, std::string(extra) + " " + memoryStats()) << std::endl;
+    }
+    if (!memoryReportPath.empty()) {
+        std::ofstream report(memoryReportPath);
+        if (!(report << memoryJson())) std::cerr << "can't write " << memoryReportPath << "\n";
+    }
+    bool soakFailed = false;
+    if (soaking) {
+        std::vector<SoakCheck> checks = evaluateSoak(soakSamples);
+        std::cout << soakSummary(checks) << std::flush;
+        if (!soak.reportPath.empty() && !writeSoakReport(soak, soakSamples, checks))
+            std::cerr << "can't write " << soak.reportPath << "\n";
+        soakFailed = !soakPassed(checks);
+    }
+    if (telemetryOn) stopTelemetry(telemetry);
+    stopGlCapture();
+    if (g_perf.open) {
+        std::cout << perfLines(g_perf) << std::flush;
+        closePerfCounters(g_perf);
     }
 
+    if (streaming) stopSculptureStream(streamed);
+    if (galleryMode) stopGallery(gallery);
+    destroyVertexStream(stream);
+    destroyHud(hud);
+    if (waveCpu) untrackCpu(&field);
+    if (softBodyMode) { untrackCpu(&waveVerts); untrackCpu(&simVerts); untrackCpu(&body); }
+    morphs = MorphTargets(); fieldGpu = WaveFieldGpu(); fieldCpuTex.reset(); lightUbo.reset();
+    sculpture = Mesh(); cube = LightCube();
+    destroyBufferPool(meshBuffers);
+    destroyGridTopologies();
+    prog.reset(); progLight.reset();
+    destroyGpuTimer(gpuTimer);
+    if (headless) destroyOffscreenTarget(offscreen);
     glfwDestroyWindow(win); glfwTerminate();
-    return 0;
+    return soakFailed ? 1 : 0;
 }
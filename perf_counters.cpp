@@ -0,0 +1,128 @@
+#include "perf_counters.h"
+
+#include <cstring>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char* kNames[kPerfEventCount] = { "cycles", "instructions", "cache_misses", "branch_misses", "page_faults" };
+
+#ifdef __linux__
+// value scaled up for the time the counter was multiplexed out
+uint64_t readCounter(int fd) {
+    uint64_t v[3] = { 0, 0, 0 }; // value, time enabled, time running
+    if (fd < 0 || read(fd, v, sizeof(v)) != (ssize_t)sizeof(v) || v[2] == 0) return 0;
+    return v[2] < v[1] ? (uint64_t)((double)v[0] * v[1] / v[2]) : v[0];
+}
+#endif
+
+void readAll(const PerfCounters& pc, uint64_t* out) {
+#ifdef __linux__
+    for (int e = 0; e < kPerfEventCount; ++e) out[e] = readCounter(pc.fd[e]);
+#else
+    (void)pc;
+    for (int e = 0; e < kPerfEventCount; ++e) out[e] = 0;
+#endif
+}
+
+} // namespace
+
+const char* perfEventName(PerfEvent e) { return kNames[e]; }
+
+bool openPerfCounters(PerfCounters& pc) {
+#ifdef __linux__
+    const struct { uint32_t type; uint64_t config; } events[kPerfEventCount] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },   // last-level cache on most PMUs
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+    };
+    for (int e = 0; e < kPerfEventCount; ++e) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[e].type;
+        attr.config = events[e].config;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.inherit = 1;           // threads created from now on; reads sum over them
+        attr.exclude_kernel = 1;    // allowed at perf_event_paranoid 2
+        attr.exclude_hv = 1;
+        pc.fd[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        pc.open = pc.open || pc.fd[e] >= 0;
+    }
+#endif
+    return pc.open;
+}
+
+void closePerfCounters(PerfCounters& pc) {
+#ifdef __linux__
+    for (int& fd : pc.fd) {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+#endif
+    pc.open = false;
+}
+
+int perfPhase(PerfCounters& pc, const char* name) {
+    for (size_t i = 0; i < pc.phases.size(); ++i)
+        if (pc.phases[i].name == name) return (int)i;
+    pc.phases.push_back(PerfPhase());
+    pc.phases.back().name = name;
+    return (int)pc.phases.size() - 1;
+}
+
+void beginPerfPhase(PerfCounters& pc, int phase) {
+    if (pc.open) readAll(pc, pc.phases[phase].start);
+}
+
+void endPerfPhase(PerfCounters& pc, int phase) {
+    if (!pc.open) return;
+    uint64_t now[kPerfEventCount];
+    readAll(pc, now);
+    PerfPhase& p = pc.phases[phase];
+    for (int e = 0; e < kPerfEventCount; ++e) p.total[e] += now[e] > p.start[e] ? now[e] - p.start[e] : 0;
+    ++p.calls;
+}
+
+std::string perfLines(const PerfCounters& pc) {
+    std::ostringstream o;
+    o.precision(3);
+    o << std::fixed;
+    for (const PerfPhase& p : pc.phases) {
+        if (!p.calls) continue;
+        o << "perf phase=" << p.name << " calls=" << p.calls;
+        for (int e = 0; e < kPerfEventCount; ++e)
+            if (pc.fd[e] >= 0) o << ' ' << kNames[e] << '=' << (double)p.total[e] / p.calls;
+        // instructions per cycle and LLC misses per 1000 instructions: low IPC with high MPKI is memory-bound
+        double cyc = (double)p.total[PerfCycles], ins = (double)p.total[PerfInstructions];
+        if (pc.fd[PerfCycles] >= 0 && pc.fd[PerfInstructions] >= 0 && cyc > 0.0) o << " ipc=" << ins / cyc;
+        if (pc.fd[PerfCacheMisses] >= 0 && pc.fd[PerfInstructions] >= 0 && ins > 0.0)
+            o << " llc_mpki=" << p.total[PerfCacheMisses] * 1000.0 / ins;
+        o << '\n';
+    }
+    return o.str();
+}
+
+std::string perfJson(const PerfCounters& pc) {
+    std::ostringstream o;
+    o << "\"perf\": {";
+    bool first = true;
+    for (const PerfPhase& p : pc.phases) {
+        if (!p.calls) continue;
+        o << (first ? "\n" : ",\n") << "    \"" << p.name << "\": {\"calls\": " << p.calls;
+        for (int e = 0; e < kPerfEventCount; ++e)
+            if (pc.fd[e] >= 0) o << ", \"" << kNames[e] << "\": " << p.total[e];
+        o << "}";
+        first = false;
+    }
+    o << (first ? "}" : "\n  }");
+    return o.str();
+}
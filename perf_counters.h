@@ -0,0 +1,39 @@
+#pragma once
+// === hardware counters per CPU phase (perf_event_open, Linux only) ===
+// Cycles, instructions, cache misses, branch misses and page faults, user space only, for the calling
+// thread and every thread created after openPerfCounters(): open them before the ThreadPool so the
+// mesh kernels running on the workers are counted, and after the GL context so driver threads aren't.
+// Counters the kernel or VM doesn't offer are left out; off Linux nothing ever opens.
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum PerfEvent { PerfCycles, PerfInstructions, PerfCacheMisses, PerfBranchMisses, PerfPageFaults, kPerfEventCount };
+
+struct PerfPhase {
+    std::string name;
+    uint64_t total[kPerfEventCount] = {};
+    uint64_t start[kPerfEventCount] = {};
+    int calls = 0;
+};
+struct PerfCounters {
+    int fd[kPerfEventCount] = { -1, -1, -1, -1, -1 };
+    bool open = false;
+    std::vector<PerfPhase> phases;
+};
+
+const char* perfEventName(PerfEvent e);
+// false if no counter could be opened (not Linux, perf_event_paranoid > 2, no PMU in the VM)
+bool openPerfCounters(PerfCounters& pc);
+void closePerfCounters(PerfCounters& pc);
+
+// index of the named phase, added on first use; look it up once, outside the frame loop
+int perfPhase(PerfCounters& pc, const char* name);
+// bracket one run of a phase; no-ops while nothing is open. Phases may nest but not interleave.
+void beginPerfPhase(PerfCounters& pc, int phase);
+void endPerfPhase(PerfCounters& pc, int phase);
+
+// one "perf phase=NAME calls=N cycles=... ipc=... llc_mpki=..." line per phase, counts averaged per call
+std::string perfLines(const PerfCounters& pc);
+// "\"perf\": {...}" member with the per-phase totals, for the --samples JSON
+std::string perfJson(const PerfCounters& pc);
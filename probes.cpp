@@ -0,0 +1,13 @@
+#include "probes.h"
+
+#ifdef KINETIC_USDT
+// the semaphores live in .probes, where the tracer looks for them
+#define KINETIC_PROBE_SEMAPHORE(name) \
+    extern "C" { __attribute__((section(".probes"), used)) unsigned short kinetic_##name##_semaphore = 0; }
+KINETIC_PROBE_SEMAPHORE(frame_begin)
+KINETIC_PROBE_SEMAPHORE(frame_end)
+KINETIC_PROBE_SEMAPHORE(swap)
+KINETIC_PROBE_SEMAPHORE(mesh_regen)
+KINETIC_PROBE_SEMAPHORE(shader_compile)
+KINETIC_PROBE_SEMAPHORE(buffer_upload)
+#endif
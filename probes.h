@@ -0,0 +1,50 @@
+#pragma once
+// === USDT probes, provider "kinetic", for bpftrace / SystemTap on a live renderer ===
+//   bpftrace -e 'usdt:./multiple_lights:kinetic:frame_end { @cpu_us = hist(arg1); }' -p PID
+//
+// With <sys/sdt.h> (systemtap-sdt-dev) each probe is a nop plus an ELF note, and arguments that are
+// already in hand cost nothing. Arguments that need extra work (timing a swap, a compile, an upload)
+// are computed only while PROBE_ENABLED(name) says a tracer is attached: every probe has a semaphore
+// the tracer bumps on attach. Without the header everything compiles away.
+//
+//   frame_begin(frame)
+//   frame_end(frame, cpu_us, frame_us)          cpu_us: frame start to before swap; frame_us: previous frame
+//   swap(frame, swap_us)
+//   mesh_regen(rows, cols, bytes, us)           makeSculpture() and the per-frame soft-body surface
+//   shader_compile(stage, source_bytes, us, ok) stage is GL_VERTEX_SHADER etc., 0 for a link
+//   buffer_upload(kind, bytes, us)              kind is a string: "lights", "vertex-stream:subdata", ...
+//
+// Include this before anything else that might pull in <sys/sdt.h> so the semaphores are wired up.
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define KINETIC_USDT 1
+#endif
+#endif
+
+#ifdef KINETIC_USDT
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+// one per probe, defined in probes.cpp; the tracer increments it while attached
+#define KINETIC_PROBE_SEMAPHORE(name) extern "C" unsigned short kinetic_##name##_semaphore;
+KINETIC_PROBE_SEMAPHORE(frame_begin)
+KINETIC_PROBE_SEMAPHORE(frame_end)
+KINETIC_PROBE_SEMAPHORE(swap)
+KINETIC_PROBE_SEMAPHORE(mesh_regen)
+KINETIC_PROBE_SEMAPHORE(shader_compile)
+KINETIC_PROBE_SEMAPHORE(buffer_upload)
+#undef KINETIC_PROBE_SEMAPHORE
+
+#define PROBE_ENABLED(name) __builtin_expect(kinetic_##name##_semaphore != 0, 0)
+#define PROBE1(name, a) STAP_PROBE1(kinetic, name, a)
+#define PROBE2(name, a, b) STAP_PROBE2(kinetic, name, a, b)
+#define PROBE3(name, a, b, c) STAP_PROBE3(kinetic, name, a, b, c)
+#define PROBE4(name, a, b, c, d) STAP_PROBE4(kinetic, name, a, b, c, d)
+#else
+// the arguments are named but never evaluated, so values kept only for a probe still count as used
+#define PROBE_ENABLED(name) false
+#define PROBE1(name, a) do { if (0) { (void)(a); } } while (0)
+#define PROBE2(name, a, b) do { if (0) { (void)(a); (void)(b); } } while (0)
+#define PROBE3(name, a, b, c) do { if (0) { (void)(a); (void)(b); (void)(c); } } while (0)
+#define PROBE4(name, a, b, c, d) do { if (0) { (void)(a); (void)(b); (void)(c); (void)(d); } } while (0)
+#endif
@@ -0,0 +1,329 @@
+#include "scene_config.h"
+
+#include <sys/stat.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+const int kMaxDimension = 16384;            // window and grid sides
+const size_t kMaxFixedLights = 4096;
+const int kMaxAnimatedLights = 65536;
+const char* const kProfileNames[] = { "straight", "vase", "hourglass", "bulb" };
+
+// a key taking a fixed count of numbers; `light` and shape.profile are handled apart
+struct Field {
+    SceneKey key;
+    int count;                              // numbers the key takes
+    void (*set)(SceneConfig&, const float*);
+    void (*get)(const SceneConfig&, float*);
+    bool whole = false;                     // counts and sizes: whole numbers only
+};
+
+void setVec(glm::vec3& v, const float* x) { v = glm::vec3(x[0], x[1], x[2]); }
+void getVec(const glm::vec3& v, float* x) { x[0] = v.x; x[1] = v.y; x[2] = v.z; }
+
+#define SCALAR(member) [](SceneConfig& c, const float* x) { c.member = x[0]; }, \
+                       [](const SceneConfig& c, float* x) { x[0] = (float)c.member; }
+#define VEC3(member) [](SceneConfig& c, const float* x) { setVec(c.member, x); }, \
+                     [](const SceneConfig& c, float* x) { getVec(c.member, x); }
+
+const Field kFields[] = {
+    { { "window", "WIDTH HEIGHT: output size", false }, 2,
+      [](SceneConfig& c, const float* x) { c.width = (int)x[0]; c.height = (int)x[1]; },
+      [](const SceneConfig& c, float* x) { x[0] = (float)c.width; x[1] = (float)c.height; }, true },
+    { { "res", "RINGS SEGMENTS: sculpture grid", false }, 2,
+      [](SceneConfig& c, const float* x) { c.rows = (int)x[0]; c.cols = (int)x[1]; },
+      [](const SceneConfig& c, float* x) { x[0] = (float)c.rows; x[1] = (float)c.cols; }, true },
+    { { "shape.a", "superellipse radius along x", true }, 1, SCALAR(shape.a) },
+    { { "shape.b", "superellipse radius along z", true }, 1, SCALAR(shape.b) },
+    { { "shape.n", "superellipse exponent", true }, 1, SCALAR(shape.n) },
+    { { "shape.twist", "cross-section rotation bottom to top, radians", true }, 1, SCALAR(shape.twist) },
+    { { "wave", "AMPLITUDE U V SPEED: travelling wave over the surface", true }, 4,
+      [](SceneConfig& c, const float* x) { c.shape.waveAmp = x[0]; c.shape.waveU = x[1]; c.shape.waveV = x[2]; c.shape.waveSpeed = x[3]; },
+      [](const SceneConfig& c, float* x) { x[0] = c.shape.waveAmp; x[1] = c.shape.waveU; x[2] = c.shape.waveV; x[3] = c.shape.waveSpeed; } },
+    { { "spin", "sculpture turn, rad/s", true }, 1, SCALAR(spinSpeed) },
+    { { "camera.radius", "orbit radius (pulled back for --instances)", true }, 1, SCALAR(camRadius) },
+    { { "camera.height", "eye height", true }, 1, SCALAR(camHeight) },
+    { { "camera.speed", "orbit, rad/s", true }, 1, SCALAR(camSpeed) },
+    { { "camera.fov", "vertical field of view, degrees", true }, 1, SCALAR(fov) },
+    { { "camera.near", "near plane", true }, 1, SCALAR(nearPlane) },
+    { { "material.ambient", "R G B", true }, 3, VEC3(matAmbient) },
+    { { "material.diffuse", "R G B", true }, 3, VEC3(matDiffuse) },
+    { { "material.specular", "R G B", true }, 3, VEC3(matSpecular) },
+    { { "material.shininess", "specular exponent", true }, 1, SCALAR(shininess) },
+    { { "sun.direction", "X Y Z: directional light, towards the scene", true }, 3, VEC3(sunDirection) },
+    { { "sun.ambient", "R G B", true }, 3, VEC3(sunAmbient) },
+    { { "sun.diffuse", "R G B", true }, 3, VEC3(sunDiffuse) },
+    { { "sun.specular", "R G B", true }, 3, VEC3(sunSpecular) },
+    { { "lights", "animated point lights (--lights)", false }, 1,
+      [](SceneConfig& c, const float* x) { c.lightCount = (int)x[0]; },
+      [](const SceneConfig& c, float* x) { x[0] = (float)c.lightCount; }, true },
+    { { "orbit.ambient", "R G B of the four orbiting lights", true }, 3, VEC3(orbitLight.ambient) },
+    { { "orbit.diffuse", "R G B", true }, 3, VEC3(orbitLight.diffuse) },
+    { { "orbit.specular", "R G B", true }, 3, VEC3(orbitLight.specular) },
+    { { "attenuation", "CONSTANT LINEAR QUADRATIC of every animated light", true }, 3,
+      [](SceneConfig& c, const float* x) { c.orbitLight.constant = x[0]; c.orbitLight.linear = x[1]; c.orbitLight.quadratic = x[2]; },
+      [](const SceneConfig& c, float* x) { x[0] = c.orbitLight.constant; x[1] = c.orbitLight.linear; x[2] = c.orbitLight.quadratic; } },
+    { { "orbit.radius", "of the four orbiting lights", true }, 1, SCALAR(orbitRadius) },
+    { { "orbit.speed", "rad/s", true }, 1, SCALAR(orbitSpeed) },
+    { { "orbit.height", "centre height", true }, 1, SCALAR(orbitHeight) },
+    { { "orbit.bob", "HEIGHT SPEED: vertical bobbing", true }, 2,
+      [](SceneConfig& c, const float* x) { c.bobHeight = x[0]; c.bobSpeed = x[1]; },
+      [](const SceneConfig& c, float* x) { x[0] = c.bobHeight; x[1] = c.bobSpeed; } },
+    { { "drift.speed", "scales the extra lights' drift", true }, 1, SCALAR(driftSpeed) },
+};
+#undef SCALAR
+#undef VEC3
+const int kMaxNumbers = 8;
+
+// "key=a,b,c" -> "key", { "a", "b", "c" }
+std::vector<std::string> tokens(std::string line) {
+    size_t hash = line.find('#');
+    if (hash != std::string::npos) line.resize(hash);
+    for (char& ch : line) if (ch == '=' || ch == ',' || ch == '\t' || ch == '\r') ch = ' ';
+    std::vector<std::string> out;
+    std::istringstream in(line);
+    for (std::string t; in >> t;) out.push_back(t);
+    return out;
+}
+
+bool number(const std::string& s, float& out) {
+    char* end = nullptr;
+    out = strtof(s.c_str(), &end);
+    return end != s.c_str() && *end == 0 && std::isfinite(out);
+}
+
+// no fractions or exponents; anything past 2^24 (far beyond every bound validateScene() checks) is
+// clamped there so the value stays exact as a float and the int cast is defined
+bool wholeNumber(const std::string& s, float& out) {
+    char* end = nullptr;
+    long v = strtol(s.c_str(), &end, 10);
+    if (end == s.c_str() || *end != 0) return false;
+    const long limit = 1L << 24;
+    out = (float)(v < -limit ? -limit : v > limit ? limit : v);
+    return true;
+}
+
+std::string numberList(const float* x, int n) {
+    std::string s;
+    char buf[32];
+    for (int i = 0; i < n; ++i) {
+        // the shortest form that reads back as the same float
+        for (int digits = 6; digits <= 9; ++digits) {
+            snprintf(buf, sizeof(buf), "%.*g", digits, x[i]);
+            if (strtof(buf, nullptr) == x[i]) break;
+        }
+        s += (i ? " " : "") + std::string(buf);
+    }
+    return s;
+}
+
+bool sameLights(const std::vector<PointLight>& a, const std::vector<PointLight>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].position != b[i].position || a[i].diffuse != b[i].diffuse || a[i].linear != b[i].linear
+            || a[i].quadratic != b[i].quadratic)
+            return false;
+    }
+    return true;
+}
+
+bool colour(const glm::vec3& v) { return v.x >= 0.0f && v.y >= 0.0f && v.z >= 0.0f; }
+
+} // namespace
+
+const std::vector<SceneKey>& sceneKeys() {
+    static const std::vector<SceneKey> keys = [] {
+        std::vector<SceneKey> k;
+        for (const Field& f : kFields) {
+            k.push_back(f.key);
+            if (!strcmp(f.key.name, "shape.n"))
+                k.push_back({ "shape.profile", "straight|vase|hourglass|bulb: radius along the height", true });
+        }
+        k.push_back({ "light", "X Y Z R G B [LINEAR QUADRATIC]: a fixed point light (repeatable)", true });
+        return k;
+    }();
+    return keys;
+}
+
+bool applySceneSetting(SceneConfig& c, const std::string& line, std::string& error) {
+    std::vector<std::string> t = tokens(line);
+    if (t.empty()) return true;
+    const std::string& key = t[0];
+    int n = (int)t.size() - 1;
+    if (key == "shape.profile") {
+        for (int p = 0; p < 4; ++p) {
+            if (n == 1 && t[1] == kProfileNames[p]) { c.shape.profile = (Profile)p; return true; }
+        }
+        error = "shape.profile is straight, vase, hourglass or bulb";
+        return false;
+    }
+    const Field* field = nullptr;
+    for (const Field& f : kFields) {
+        if (key == f.key.name) field = &f;
+    }
+    float x[kMaxNumbers] = {};
+    if (n > kMaxNumbers) { error = key + ": too many values"; return false; }
+    for (int i = 0; i < n; ++i) {
+        if (field && field->whole) {
+            if (!wholeNumber(t[i + 1], x[i])) { error = key + ": '" + t[i + 1] + "' is not a whole number"; return false; }
+        } else if (!number(t[i + 1], x[i])) {
+            error = key + ": '" + t[i + 1] + "' is not a number";
+            return false;
+        }
+    }
+    if (key == "light") {
+        if (n != 6 && n != 8) { error = "light takes X Y Z R G B [LINEAR QUADRATIC]"; return false; }
+        PointLight L;
+        L.position = glm::vec3(x[0], x[1], x[2]);
+        L.ambient = glm::vec3(0.0f);
+        L.diffuse = L.specular = glm::vec3(x[3], x[4], x[5]);
+        if (n == 8) { L.linear = x[6]; L.quadratic = x[7]; }
+        c.fixedLights.push_back(L);
+        return true;
+    }
+    if (!field) {
+        error = "unknown key '" + key + "'";
+        return false;
+    }
+    if (n != field->count) {
+        error = key + " takes " + std::to_string(field->count) + (field->count == 1 ? " value" : " values");
+        return false;
+    }
+    field->set(c, x);
+    return true;
+}
+
+bool loadSceneFile(const std::string& path, SceneConfig& c, std::vector<std::string>& problems) {
+    std::ifstream in(path);
+    if (!in) {
+        problems.push_back("can't read " + path);
+        return false;
+    }
+    bool ok = true;
+    int lineNo = 0;
+    for (std::string line; std::getline(in, line);) {
+        ++lineNo;
+        std::string error;
+        if (!applySceneSetting(c, line, error)) {
+            problems.push_back(path + ":" + std::to_string(lineNo) + ": " + error);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool loadScene(const std::string& path, const std::vector<std::string>& overrides, SceneConfig& out,
+               std::vector<std::string>& problems) {
+    SceneConfig c;
+    bool ok = path.empty() || loadSceneFile(path, c, problems);
+    for (const std::string& o : overrides) {
+        std::string error;
+        if (!applySceneSetting(c, o, error)) {
+            problems.push_back("--set " + o + ": " + error);
+            ok = false;
+        }
+    }
+    if (!ok || !validateScene(c, problems)) return false;
+    out = c;
+    return true;
+}
+
+bool validateScene(const SceneConfig& c, std::vector<std::string>& problems) {
+    size_t before = problems.size();
+    auto check = [&](bool ok, const char* what) { if (!ok) problems.push_back(what); };
+    check(c.width >= 1 && c.height >= 1 && c.width <= kMaxDimension && c.height <= kMaxDimension,
+          "window: each side 1..16384");
+    check(c.rows >= 2 && c.cols >= 3 && c.rows <= kMaxDimension && c.cols <= kMaxDimension,
+          "res: at least 2 rings and 3 segments, at most 16384 each");
+    check(c.shape.a > 0.0f && c.shape.b > 0.0f, "shape.a, shape.b: positive");
+    check(c.shape.n > 0.0f, "shape.n: positive");
+    check(c.shape.waveAmp > -1.0f && c.shape.waveAmp < 1.0f, "wave: amplitude within (-1, 1), or the surface folds");
+    check(c.camRadius > 0.0f, "camera.radius: positive");
+    check(c.fov > 1.0f && c.fov < 179.0f, "camera.fov: between 1 and 179 degrees");
+    check(c.nearPlane > 0.0f && c.nearPlane < 10.0f, "camera.near: within (0, 10)");
+    check(colour(c.matAmbient) && colour(c.matDiffuse) && colour(c.matSpecular), "material: colours can't be negative");
+    check(c.shininess > 0.0f, "material.shininess: positive");
+    check(glm::length(c.sunDirection) > 1e-6f, "sun.direction: not zero");
+    check(colour(c.sunAmbient) && colour(c.sunDiffuse) && colour(c.sunSpecular), "sun: colours can't be negative");
+    check(c.lightCount >= 0 && c.lightCount <= kMaxAnimatedLights, "lights: 0..65536");
+    check(colour(c.orbitLight.ambient) && colour(c.orbitLight.diffuse) && colour(c.orbitLight.specular),
+          "orbit: colours can't be negative");
+    const PointLight& o = c.orbitLight;
+    check(o.constant >= 0.0f && o.linear >= 0.0f && o.quadratic >= 0.0f && o.constant + o.linear + o.quadratic > 0.0f,
+          "attenuation: non-negative, not all zero");
+    check(c.fixedLights.size() <= kMaxFixedLights, "light: at most 4096 fixed lights");
+    for (const PointLight& L : c.fixedLights) {
+        if (!colour(L.diffuse) || L.linear < 0.0f || L.quadratic < 0.0f) {
+            problems.push_back("light: colours and attenuation can't be negative");
+            break;
+        }
+    }
+    return problems.size() == before;
+}
+
+std::string sceneText(const SceneConfig& c) {
+    std::string s;
+    float x[kMaxNumbers];
+    for (const Field& f : kFields) {
+        f.get(c, x);
+        s += std::string(f.key.name) + " " + numberList(x, f.count) + "\n";
+        if (!strcmp(f.key.name, "shape.n"))
+            s += std::string("shape.profile ") + kProfileNames[(int)c.shape.profile] + "\n";
+    }
+    for (const PointLight& L : c.fixedLights) {
+        float v[8] = { L.position.x, L.position.y, L.position.z, L.diffuse.x, L.diffuse.y, L.diffuse.z, L.linear, L.quadratic };
+        s += "light " + numberList(v, 8) + "\n";
+    }
+    return s;
+}
+
+SceneReload reloadScene(SceneConfig& running, const SceneConfig& before, const SceneConfig& after) {
+    SceneReload r;
+    float a[kMaxNumbers], b[kMaxNumbers];
+    for (const Field& f : kFields) {
+        f.get(before, a);
+        f.get(after, b);
+        if (!memcmp(a, b, sizeof(float) * f.count)) continue;
+        if (!f.key.live) { r.restart.push_back(f.key.name); continue; }
+        f.set(running, b);
+        const char* k = f.key.name;
+        if (!strncmp(k, "shape.", 6) || !strcmp(k, "wave")) r.shape = true;
+        // positions and speeds are read every frame; colours and attenuation are baked into the light set
+        if (!strcmp(k, "orbit.ambient") || !strcmp(k, "orbit.diffuse") || !strcmp(k, "orbit.specular")
+            || !strcmp(k, "attenuation"))
+            r.lights = true;
+    }
+    if (before.shape.profile != after.shape.profile) {
+        running.shape.profile = after.shape.profile;
+        r.shape = true;
+    }
+    if (!sameLights(before.fixedLights, after.fixedLights)) {
+        running.fixedLights = after.fixedLights;
+        r.lights = true;
+    }
+    return r;
+}
+
+void watchScene(SceneWatch& w, const std::string& path) {
+    w = SceneWatch();
+    w.path = path;
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) w.mtime = st.st_mtim;
+}
+
+bool sceneChanged(SceneWatch& w, double nowMs, double intervalMs) {
+    if (w.path.empty() || nowMs < w.nextCheckMs) return false;
+    w.nextCheckMs = nowMs + intervalMs;
+    struct stat st;
+    if (stat(w.path.c_str(), &st) != 0) return false;      // mid-save; the next poll sees it
+    if (st.st_mtim.tv_sec == w.mtime.tv_sec && st.st_mtim.tv_nsec == w.mtime.tv_nsec) return false;
+    w.mtime = st.st_mtim;
+    return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+// === scene description: everything the renderer used to hard-code, from a file and the command line ===
+// GL-free. A scene file is one setting per line, `key value...`, `#` starts a comment; numbers may be
+// separated by spaces or commas. Anything left out keeps its default, and the defaults are the original
+// scene, so an empty file changes nothing:
+//
+//   window 1280 720                        # output size
+//   res 140 180                            # sculpture rings x segments
+//   material.diffuse 0.7, 0.75, 0.8
+//   light 0 4 0  1 0.8 0.6  0.09 0.032     # a fixed light: position, colour [, linear, quadratic]
+//
+// sceneKeys() lists every key; `--print-scene` writes the effective configuration in this syntax.
+//
+// `--scene FILE` loads one at startup and `--set key=value` overrides single keys on top (repeatable, in
+// order); the explicit flags (--size, --res, --lights) override both. The result is validated before
+// anything is created. While running, the file is polled: settings marked live (camera, animation
+// speeds, material, lights, the shape) take effect on the next frame, the others are reported as
+// needing a restart. A file that fails to parse or validate is ignored until it is fixed.
+#include <glm/glm.hpp>
+
+#include "lights.h"
+#include "sculpture_geometry.h"
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+struct SceneConfig {
+    int width = 1280, height = 720;
+    int rows = 140, cols = 180;
+    SculptureShape shape;
+    float spinSpeed = 0.25f;                        // sculpture turn, rad/s
+
+    // orbit camera
+    float camRadius = 6.5f, camHeight = 3.0f, camSpeed = 0.3f;
+    float fov = 45.0f, nearPlane = 0.1f;            // degrees; the far plane follows the scene size
+
+    glm::vec3 matAmbient = glm::vec3(0.15f), matDiffuse = glm::vec3(0.7f, 0.75f, 0.8f), matSpecular = glm::vec3(0.9f);
+    float shininess = 48.0f;
+
+    glm::vec3 sunDirection = glm::vec3(-0.2f, -1.0f, -0.3f);
+    glm::vec3 sunAmbient = glm::vec3(0.04f, 0.04f, 0.05f), sunDiffuse = glm::vec3(0.25f, 0.25f, 0.3f);
+    glm::vec3 sunSpecular = glm::vec3(0.3f, 0.3f, 0.35f);
+
+    // `lightCount` animated lights: the first four orbit the sculpture in `orbitLight` colours, the rest
+    // are dim coloured extras drifting through a shell; all of them take its attenuation
+    int lightCount = 4;
+    PointLight orbitLight;
+    float orbitRadius = 1.8f, orbitSpeed = 0.7f;
+    float orbitHeight = 1.0f, bobHeight = 0.4f, bobSpeed = 1.3f;
+    float driftSpeed = 1.0f;                        // scales the extras' drift
+    std::vector<PointLight> fixedLights;            // after the animated ones, never moved
+};
+
+struct SceneKey {
+    const char* name;
+    const char* help;
+    bool live;                                      // can change while running
+};
+// every key a scene file or --set accepts, in file order
+const std::vector<SceneKey>& sceneKeys();
+
+// one `key value...` setting; false with a message in `error`
+bool applySceneSetting(SceneConfig& c, const std::string& line, std::string& error);
+// applies the file on top of `c`; problems are "FILE:LINE: ..." and leave `c` partly updated
+bool loadSceneFile(const std::string& path, SceneConfig& c, std::vector<std::string>& problems);
+// defaults, then the file (if any), then each `key=value` override, validated; `out` is only written on success
+bool loadScene(const std::string& path, const std::vector<std::string>& overrides, SceneConfig& out,
+               std::vector<std::string>& problems);
+// ranges and consistency; one message per problem
+bool validateScene(const SceneConfig& c, std::vector<std::string>& problems);
+// the whole configuration in file syntax, every key
+std::string sceneText(const SceneConfig& c);
+
+// what a reload changed in the running configuration
+struct SceneReload {
+    bool lights = false, shape = false;             // the light set and the mesh need rebuilding
+    std::vector<std::string> restart;               // keys that changed but only take effect on restart
+};
+// copies the live settings that differ between `before` and `after` (two loads of the same sources) into
+// `running`, which may also hold command-line overrides of the restart-only ones
+SceneReload reloadScene(SceneConfig& running, const SceneConfig& before, const SceneConfig& after);
+
+// polls a file's modification time; cheap enough to call every frame
+struct SceneWatch {
+    std::string path;
+    timespec mtime = {};
+    double nextCheckMs = 0.0;
+};
+void watchScene(SceneWatch& w, const std::string& path);
+// true once per change, at most every `intervalMs`
+bool sceneChanged(SceneWatch& w, double nowMs, double intervalMs = 500.0);
@@ -1,4 +1,15 @@
 #version 330 core
+// variant switches, injected as #defines after the #version line (--define, --bench-shaders);
+// the defaults are the reference shading
+#ifndef SPEC_BLINN
+#define SPEC_BLINN 0     // 1: Blinn-Phong half vector, exponent x4 to keep the highlight size
+#endif
+#ifndef SPEC_FASTPOW
+#define SPEC_FASTPOW 0   // 1: Schlick's x / (n - n*x + x) instead of pow(x, n)
+#endif
+#ifndef ATT_CUTOFF
+#define ATT_CUTOFF 0     // 1: branch out of lights whose attenuated colour is below 1/512
+#endif
 struct Material {
     vec3 ambient;
     vec3 diffuse;
@@ -11,21 +22,30 @@ struct DirLight {
     vec3 diffuse;
     vec3 specular;
 };
+// std140 layout, 64 bytes: mirrored by GpuPointLight in lights.h
 struct PointLight {
     vec3 position;
     float constant;
-    float linear;
-    float quadratic;
     vec3 ambient;
+    float linear;
     vec3 diffuse;
+    float quadratic;
     vec3 specular;
 };
 
 uniform Material material;
 uniform DirLight dirLight;
-uniform PointLight pointLights[4];
+layout(std140) uniform PointLights {
+    PointLight pointLights[256];
+};
+uniform int uPointLightCount;
 uniform vec3 uViewPos;
 
+// distant/dim lights as L2 spherical-harmonic irradiance (cosine lobe already applied on the CPU)
+uniform bool uShEnabled;
+uniform vec3 uShIrradiance[9];
+uniform vec3 uShAmbient;
+
 in VS_OUT{
     vec3 FragPos;
     vec3 Normal;
@@ -33,30 +53,56 @@ in VS_OUT{
 
 out vec4 FragColor;
 
+float specular(vec3 Ldir, vec3 N, vec3 V){
+#if SPEC_BLINN
+    float x = max(dot(N, normalize(Ldir + V)), 0.0);
+    float n = material.shininess * 4.0;
+#else
+    vec3 R = reflect(-Ldir, N);
+    float x = max(dot(V, R),0.0);
+    float n = material.shininess;
+#endif
+#if SPEC_FASTPOW
+    return x / (n - n*x + x);
+#else
+    return pow(x, n);
+#endif
+}
+
 vec3 calcDir(DirLight L, vec3 N, vec3 V){
     vec3 Ldir = normalize(-L.direction);
     float diff = max(dot(N, Ldir), 0.0);
-    vec3 R = reflect(-Ldir, N);
-    float spec = pow(max(dot(V, R),0.0), material.shininess);
+    float spec = specular(Ldir, N, V);
     return L.ambient*material.ambient + L.diffuse*diff*material.diffuse + L.specular*spec*material.specular;
 }
 vec3 calcPoint(PointLight L, vec3 N, vec3 V){
-    vec3 Ldir = normalize(L.position - fs_in.FragPos);
-    float diff = max(dot(N, Ldir), 0.0);
-    vec3 R = reflect(-Ldir, N);
-    float spec = pow(max(dot(V, R),0.0), material.shininess);
     float d = length(L.position - fs_in.FragPos);
     float att = 1.0 / (L.constant + L.linear*d + L.quadratic*d*d);
+#if ATT_CUTOFF
+    vec3 peak = L.ambient + L.diffuse + L.specular;
+    if (att * max(peak.r, max(peak.g, peak.b)) < 1.0 / 512.0) return vec3(0.0);
+#endif
+    vec3 Ldir = normalize(L.position - fs_in.FragPos);
+    float diff = max(dot(N, Ldir), 0.0);
+    float spec = specular(Ldir, N, V);
     vec3 col = L.ambient*material.ambient + L.diffuse*diff*material.diffuse + L.specular*spec*material.specular;
     return col * att;
 }
 
+vec3 evalSH(vec3 n){
+    return uShIrradiance[0]
+         + uShIrradiance[1]*n.y + uShIrradiance[2]*n.z + uShIrradiance[3]*n.x
+         + uShIrradiance[4]*(n.x*n.y) + uShIrradiance[5]*(n.y*n.z) + uShIrradiance[6]*(3.0*n.z*n.z - 1.0)
+         + uShIrradiance[7]*(n.x*n.z) + uShIrradiance[8]*(n.x*n.x - n.y*n.y);
+}
+
 void main(){
     vec3 N = normalize(fs_in.Normal);
     vec3 V = normalize(uViewPos - fs_in.FragPos);
 
     vec3 color = calcDir(dirLight,N,V);
-    for(int i=0;i<4;i++) color += calcPoint(pointLights[i],N,V);
+    for(int i=0;i<uPointLightCount;i++) color += calcPoint(pointLights[i],N,V);
+    if (uShEnabled) color += max(evalSH(N), 0.0)*material.diffuse + uShAmbient*material.ambient;
 
     // subtle tint
     color *= vec3(0.95, 0.98, 1.00);
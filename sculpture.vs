@@ -5,14 +5,57 @@ layout(location=2) in vec2 aTex;
 
 uniform mat4 uModel, uView, uProj;
 
+// simulated wave field (rows x cols, one texel per vertex); aPos is then the undisplaced surface
+uniform bool uWaveTex;
+uniform sampler2D uWaveField;
+
+// morph targets: target i of vertex v is texel i * uMorphInfo.y + v (position bits, octahedral normal)
+layout(std140) uniform MorphWeights {
+    ivec4 uMorphInfo;          // x = target count (0 = use aPos/aNormal), y = vertices per target
+    vec4 uMorphWeights[4];     // up to 16 targets
+    vec4 uMorphWave[16];       // per target: travelling wave amplitude, u and v frequency, phase (radians)
+};
+uniform usamplerBuffer uMorphTargets;
+
 out VS_OUT{
     vec3 FragPos;
     vec3 Normal;
 } vs_out;
 
+vec3 decodeOct(uint bits){
+    // two snorm16, sign-extended
+    vec2 f = vec2(float(int(bits << 16) >> 16), float(int(bits) >> 16)) / 32767.0;
+    vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+    if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
 void main(){
-    vec4 world = uModel * vec4(aPos,1.0);
+    vec3 p = aPos;
+    vec3 nrm = aNormal;
+    if (uMorphInfo.x > 0) {
+        p = vec3(0.0); nrm = vec3(0.0);
+        for (int i = 0; i < uMorphInfo.x; i++) {
+            float w = uMorphWeights[i / 4][i % 4];
+            if (w == 0.0) continue;    // uniform across the draw, so idle targets cost no fetches
+            uvec4 t = texelFetch(uMorphTargets, i * uMorphInfo.y + gl_VertexID);
+            vec3 q = uintBitsToFloat(t.xyz);
+            // targets are stored undisplaced; a simulated field below replaces their analytic wave
+            if (!uWaveTex) {
+                vec4 wv = uMorphWave[i];
+                q.xz *= 1.0 + wv.x * sin(6.28318531 * (wv.y * aTex.x - wv.z * aTex.y) + wv.w);
+            }
+            p += w * q;
+            nrm += w * decodeOct(t.w);
+        }
+    }
+    if (uWaveTex) {
+        int cols = textureSize(uWaveField, 0).x;
+        float w = texelFetch(uWaveField, ivec2(gl_VertexID % cols, gl_VertexID / cols), 0).r;
+        p.xz *= 1.0 + w;
+    }
+    vec4 world = uModel * vec4(p,1.0);
     vs_out.FragPos = world.xyz;
-    vs_out.Normal  = mat3(transpose(inverse(uModel))) * aNormal;
+    vs_out.Normal  = mat3(transpose(inverse(uModel))) * nrm;
     gl_Position = uProj * uView * world;
 }
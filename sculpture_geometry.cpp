@@ -0,0 +1,298 @@
+#include "sculpture_geometry.h"
+#include "simd4.h"
+#include "thread_pool.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+#include <functional>
+
+namespace {
+
+// t * waveSpeed reduced to [0, 2pi) in double: the only place the time reaches the wave
+float wavePhase(double t, const SculptureShape& shape) {
+    return (float)fmod(t * shape.waveSpeed, glm::two_pi<double>());
+}
+
+// one ring of the original loop; also the Table/Simd fallback for twisted shapes
+void scalarRow(float* out, int r, int rows, int cols, float phase, const float* wave, const SculptureShape& shape) {
+    float vParam = (float)r / (rows - 1);        // 0..1 along Y
+    float y = (vParam - 0.5f) * 3.0f;          // height
+    for (int c = 0; c < cols; ++c) {
+        float uParam = (float)c / cols;        // 0..1 around
+        float theta = uParam * glm::two_pi<float>();
+
+        // time-varying radius: base superellipse + travelling wave
+        float a = shape.a, b = shape.b;          // superellipse radii
+        float n = shape.n;                      // superellipse exponent
+        // superellipse in 2D (r0 around y-axis), cross-section turned by the twist
+        float phi = theta - shape.twist * vParam;
+        float cx = powf(fabs(cos(phi)), 2 / n) * a * (cos(phi) >= 0 ? 1 : -1);
+        float cz = powf(fabs(sin(phi)), 2 / n) * b * (sin(phi) >= 0 ? 1 : -1);
+        float r0 = sqrtf(cx * cx + cz * cz) * profileScale(shape.profile, vParam);
+
+        float w = wave ? wave[r * cols + c]
+            : shape.waveAmp * sin(shape.waveU * uParam * glm::two_pi<float>() - shape.waveV * vParam * glm::two_pi<float>() + phase);
+        float radius = r0 * (1.0f + w);
+
+        float x = radius * cos(theta);
+        float z = radius * sin(theta);
+
+        // approximate normal via partial derivatives in parametric form
+        // For visual quality we can normalize (x,z) in the horizontal plane:
+        glm::vec3 tTheta(-radius * sin(theta), 0.0f, radius * cos(theta));
+        glm::vec3 tY(0.0f, 1.0f, 0.0f);
+        glm::vec3 nrm = glm::normalize(glm::cross(tTheta, tY)); // outward approx
+
+        float* o = out + (size_t)c * kVertexFloats;
+        o[0] = x; o[1] = y; o[2] = z;
+        o[3] = nrm.x; o[4] = nrm.y; o[5] = nrm.z;
+        o[6] = uParam; o[7] = vParam;
+    }
+}
+
+// per-column terms: angle, untwisted superellipse radius and the u half of the wave phase
+struct ColumnTable {
+    std::vector<float> cosT, sinT, r0, u, sinA, cosA;
+};
+// per-row terms: height, profile and the v/time half of the wave phase
+struct RowTable {
+    std::vector<float> v, y, scale, sinB, cosB;
+};
+
+void resizeTable(ColumnTable& T, int n) {
+    T.cosT.resize(n); T.sinT.resize(n); T.r0.resize(n); T.u.resize(n); T.sinA.resize(n); T.cosA.resize(n);
+}
+void columnTerms(ColumnTable& T, int i, float uParam, const SculptureShape& shape) {
+    float theta = uParam * glm::two_pi<float>();
+    float ct = cos(theta), st = sin(theta);
+    float cx = powf(fabs(ct), 2 / shape.n) * shape.a * (ct >= 0 ? 1 : -1);
+    float cz = powf(fabs(st), 2 / shape.n) * shape.b * (st >= 0 ? 1 : -1);
+    float A = shape.waveU * uParam * glm::two_pi<float>();
+    T.cosT[i] = ct; T.sinT[i] = st; T.r0[i] = sqrtf(cx * cx + cz * cz);
+    T.u[i] = uParam; T.sinA[i] = sin(A); T.cosA[i] = cos(A);
+}
+
+void resizeTable(RowTable& R, int n) {
+    R.v.resize(n); R.y.resize(n); R.scale.resize(n); R.sinB.resize(n); R.cosB.resize(n);
+}
+void rowTerms(RowTable& R, int i, float vParam, float phase, const SculptureShape& shape) {
+    // sin(A - B) with B = waveV * v * 2pi - phase
+    float B = shape.waveV * vParam * glm::two_pi<float>() - phase;
+    R.v[i] = vParam; R.y[i] = (vParam - 0.5f) * 3.0f;
+    R.scale[i] = profileScale(shape.profile, vParam);
+    R.sinB[i] = shape.waveAmp * sin(B); R.cosB[i] = shape.waveAmp * cos(B);
+}
+
+ColumnTable columnTable(int cols, const SculptureShape& shape) {
+    ColumnTable T;
+    resizeTable(T, cols);
+    for (int c = 0; c < cols; ++c) columnTerms(T, c, (float)c / cols, shape);
+    return T;
+}
+
+RowTable rowTable(int rows, float phase, const SculptureShape& shape) {
+    RowTable R;
+    resizeTable(R, rows);
+    for (int r = 0; r < rows; ++r) rowTerms(R, r, (float)r / (rows - 1), phase, shape);
+    return R;
+}
+
+// columns [c0, c1) of ring r
+void tableRow(float* out, int r, int c0, int c1, int cols, const float* wave, const ColumnTable& T, const RowTable& R) {
+    float y = R.y[r], vParam = R.v[r], scale = R.scale[r], sB = R.sinB[r], cB = R.cosB[r];
+    const float* w = wave ? wave + (size_t)r * cols : nullptr;
+    for (int c = c0; c < c1; ++c) {
+        float wv = w ? w[c] : T.sinA[c] * cB - T.cosA[c] * sB;
+        float radius = T.r0[c] * scale * (1.0f + wv);
+        // cross(tTheta, up) normalised is -(cos, 0, sin) for a positive radius
+        float s = radius >= 0.0f ? -1.0f : 1.0f;
+        float* o = out + (size_t)c * kVertexFloats;
+        o[0] = radius * T.cosT[c]; o[1] = y; o[2] = radius * T.sinT[c];
+        o[3] = s * T.cosT[c]; o[4] = 0.0f; o[5] = s * T.sinT[c];
+        o[6] = T.u[c]; o[7] = vParam;
+    }
+}
+
+void simdRow(float* out, int r, int cols, const float* wave, const ColumnTable& T, const RowTable& R) {
+    float y = R.y[r], vParam = R.v[r];
+    F4 scale(R.scale[r]), sB(R.sinB[r]), cB(R.cosB[r]), one(1.0f), zero(0.0f), neg(-1.0f), pos(1.0f);
+    const float* w = wave ? wave + (size_t)r * cols : nullptr;
+    int c = 0;
+    for (; c + 4 <= cols; c += 4) {
+        F4 wv = w ? F4::load(w + c) : F4::load(&T.sinA[c]) * cB - F4::load(&T.cosA[c]) * sB;
+        F4 radius = F4::load(&T.r0[c]) * scale * (one + wv);
+        F4 ct = F4::load(&T.cosT[c]), st = F4::load(&T.sinT[c]);
+        F4 s = select4(greater4(zero, radius), pos, neg);
+        alignas(16) float x[4], z[4], nx[4], nz[4];
+        (radius * ct).store(x); (radius * st).store(z);
+        (s * ct).store(nx); (s * st).store(nz);
+        for (int k = 0; k < 4; ++k) {
+            float* o = out + (size_t)(c + k) * kVertexFloats;
+            o[0] = x[k]; o[1] = y; o[2] = z[k];
+            o[3] = nx[k]; o[4] = 0.0f; o[5] = nz[k];
+            o[6] = T.u[c + k]; o[7] = vParam;
+        }
+    }
+    tableRow(out, r, c, cols, cols, wave, T, R); // leftover columns
+}
+
+void runRows(int rows, ThreadPool* pool, const std::function<void(int, int)>& fn) {
+    if (pool) pool->parallelFor(rows, 8, fn);
+    else fn(0, rows);
+}
+
+} // namespace
+
+float profileScale(Profile p, float vParam) {
+    switch (p) {
+    case Profile::Vase:      return 0.75f + 0.45f * sin(vParam * glm::pi<float>() * 1.2f);
+    case Profile::Hourglass: return 0.55f + 1.8f * (vParam - 0.5f) * (vParam - 0.5f);
+    case Profile::Bulb:      return 0.5f + 0.7f * exp(-12.0f * (vParam - 0.35f) * (vParam - 0.35f));
+    default:                 return 1.0f;
+    }
+}
+
+void sculptureVertices(std::vector<float>& v, int rows, int cols, double t, const float* wave,
+                       const SculptureShape& shape, GeometryKernel kernel, ThreadPool* pool) {
+    v.resize((size_t)rows * cols * kVertexFloats);
+    float* out = v.data();
+    size_t rowFloats = (size_t)cols * kVertexFloats;
+    if (kernel == GeometryKernel::Scalar || shape.twist != 0.0f) {
+        runRows(rows, kernel == GeometryKernel::Scalar ? nullptr : pool, [&](int r0, int r1) {
+            for (int r = r0; r < r1; ++r) scalarRow(out + r * rowFloats, r, rows, cols, wavePhase(t, shape), wave, shape);
+        });
+        return;
+    }
+    ColumnTable T = columnTable(cols, shape);
+    RowTable R = rowTable(rows, wavePhase(t, shape), shape);
+    runRows(rows, pool, [&](int r0, int r1) {
+        for (int r = r0; r < r1; ++r) {
+            if (kernel == GeometryKernel::Simd) simdRow(out + r * rowFloats, r, cols, wave, T, R);
+            else tableRow(out + r * rowFloats, r, 0, cols, cols, wave, T, R);
+        }
+    });
+}
+
+void sculptureIndices(std::vector<unsigned int>& idx, int rows, int cols, ThreadPool* pool) {
+    idx.resize(rows > 1 ? (size_t)(rows - 1) * cols * 6 : 0);
+    unsigned int* out = idx.data();
+    runRows(rows - 1, pool, [&](int r0, int r1) {
+        for (int r = r0; r < r1; ++r) {
+            unsigned int* o = out + (size_t)r * cols * 6;
+            unsigned int row = (unsigned int)(r * cols), next = row + cols;
+            for (int c = 0; c < cols; ++c) {
+                // same winding as the original toIndex() version: i0,i2,i1  i1,i2,i3
+                unsigned int c1 = c + 1 < cols ? c + 1 : 0;
+                unsigned int i0 = row + c, i1 = row + c1, i2 = next + c, i3 = next + c1;
+                o[0] = i0; o[1] = i2; o[2] = i1;
+                o[3] = i1; o[4] = i2; o[5] = i3;
+                o += 6;
+            }
+        }
+    });
+}
+
+void sculptureStripIndices(std::vector<unsigned int>& idx, int rows, int cols, ThreadPool* pool) {
+    size_t band = (size_t)cols * 2 + 4;
+    idx.resize(rows > 1 ? (size_t)(rows - 1) * band - 2 : 0);
+    unsigned int* out = idx.data();
+    runRows(rows - 1, pool, [&](int r0, int r1) {
+        for (int r = r0; r < r1; ++r) {
+            unsigned int* o = out + (size_t)r * band;
+            unsigned int row = (unsigned int)(r * cols), next = row + cols;
+            // r0c0 r1c0 r0c1 r1c1 ...: (i0,i2,i1) then, flipped by the strip, (i1,i2,i3) as in sculptureIndices
+            for (int c = 0; c <= cols; ++c) {
+                unsigned int cc = c < cols ? c : 0;
+                *o++ = row + cc;
+                *o++ = next + cc;
+            }
+            if (r + 2 < rows) {
+                *o++ = next;            // last of this band (column 0 again)
+                *o++ = next;            // first of the next one
+            }
+        }
+    });
+}
+
+// grid vertex of the k-th border vertex of an (n + 1)^2 patch, walking the border once around
+static int patchBorder(int n, int k) {
+    int side = k / n, s = k % n, w = n + 1;
+    switch (side) {
+    case 0:  return s;                          // first ring, along the segments
+    case 1:  return s * w + n;                  // last segment, up the rings
+    case 2:  return n * w + (n - s);            // last ring, back
+    default: return (n - s) * w;                // first segment, down
+    }
+}
+
+void sculpturePatch(float* out, int rows, int cols, int r0, int r1, int c0, int c1, int n, double t, float skirt,
+                    const SculptureShape& shape) {
+    // twist isn't in the tables; a patch is only ever made of untwisted shapes
+    ColumnTable T;
+    RowTable R;
+    resizeTable(T, n + 1);
+    resizeTable(R, n + 1);
+    // integer grid positions, so neighbours at the same level agree on their shared edge exactly
+    for (int j = 0; j <= n; ++j)
+        columnTerms(T, j, (float)(c0 + (long long)(c1 - c0) * j / n) / cols, shape);
+    for (int i = 0; i <= n; ++i)
+        rowTerms(R, i, (float)(r0 + (long long)(r1 - r0) * i / n) / (rows - 1), wavePhase(t, shape), shape);
+    for (int i = 0; i <= n; ++i) tableRow(out + (size_t)i * (n + 1) * kVertexFloats, i, 0, n + 1, n + 1, nullptr, T, R);
+
+    // skirt: the border again, pulled `skirt` towards the axis to hide cracks against coarser neighbours
+    float* s = out + (size_t)(n + 1) * (n + 1) * kVertexFloats;
+    for (int k = 0; k < 4 * n; ++k, s += kVertexFloats) {
+        const float* b = out + (size_t)patchBorder(n, k) * kVertexFloats;
+        float radius = sqrtf(b[0] * b[0] + b[2] * b[2]);
+        float f = radius > skirt ? (radius - skirt) / radius : 0.0f;
+        for (int e = 0; e < kVertexFloats; ++e) s[e] = b[e];
+        s[0] *= f; s[2] *= f;
+    }
+}
+
+void sculpturePatchIndices(std::vector<unsigned int>& idx, int n) {
+    idx.clear();
+    idx.reserve((size_t)n * n * 6 + (size_t)n * 24);
+    unsigned int w = (unsigned int)n + 1;
+    for (unsigned int r = 0; r < (unsigned int)n; ++r) {
+        for (unsigned int c = 0; c < (unsigned int)n; ++c) {
+            unsigned int i0 = r * w + c, i1 = i0 + 1, i2 = i0 + w, i3 = i2 + 1;
+            unsigned int q[6] = { i0, i2, i1, i1, i2, i3 };
+            idx.insert(idx.end(), q, q + 6);
+        }
+    }
+    unsigned int base = w * w, ring = 4u * n;
+    for (unsigned int k = 0; k < ring; ++k) {
+        unsigned int a = (unsigned int)patchBorder(n, (int)k), b = (unsigned int)patchBorder(n, (int)((k + 1) % ring));
+        unsigned int sa = base + k, sb = base + (k + 1) % ring;
+        unsigned int q[6] = { a, b, sa, b, sb, sa };
+        idx.insert(idx.end(), q, q + 6);
+    }
+}
+
+unsigned int packOctNormal(float nx, float ny, float nz) {
+    float l1 = fabs(nx) + fabs(ny) + fabs(nz);
+    float ox = nx / l1, oy = ny / l1;
+    if (nz < 0.0f) {
+        float px = ox;
+        ox = (1.0f - fabs(oy)) * (px >= 0.0f ? 1.0f : -1.0f);
+        oy = (1.0f - fabs(px)) * (oy >= 0.0f ? 1.0f : -1.0f);
+    }
+    auto snorm16 = [](float f) { return (unsigned int)(int)lroundf(glm::clamp(f, -1.0f, 1.0f) * 32767.0f) & 0xffffu; };
+    return snorm16(ox) | (snorm16(oy) << 16);
+}
+
+CubeGeometry lightCubeGeometry(float s) {
+    return {
+        {
+            -s,-s,-s,  s,-s,-s,  s, s,-s,  -s, s,-s,
+            -s,-s, s,  s,-s, s,  s, s, s,  -s, s, s
+        },
+        {
+            0,1,2, 2,3,0, 1,5,6, 6,2,1, 5,4,7, 7,6,5,
+            4,0,3, 3,7,4, 3,2,6, 6,7,3, 4,5,1, 1,0,4
+        }
+    };
+}
@@ -0,0 +1,61 @@
+#pragma once
+// === CPU side of the sculpture and light-cube meshes, no GL ===
+// Everything the renderer uploads is generated here so it can be benchmarked and reused headlessly.
+// Vertex layout is interleaved pos(3) normal(3) tex(2), ring-major: vertex (r, c) is r * cols + c.
+#include <vector>
+
+struct ThreadPool;
+
+// generator parameters; the defaults are the original sculpture
+enum class Profile { Straight, Vase, Hourglass, Bulb };
+struct SculptureShape {
+    float a = 1.0f, b = 0.5f;        // superellipse radii
+    float n = 2.5f;                  // superellipse exponent
+    Profile profile = Profile::Straight;
+    float twist = 0.0f;              // cross-section rotation bottom to top (radians)
+    float waveAmp = 0.25f, waveU = 6.0f, waveV = 4.0f, waveSpeed = 1.5f;
+};
+
+// Scalar: the original per-vertex loop, kept as the reference.
+// Table: per-column and per-row terms computed once, the wave's sine split with the angle-sum identity,
+//        so the inner loop has no transcendental calls. Rows run across the pool.
+// Simd: the table kernel 4 columns at a time.
+// Table/Simd fall back to the scalar loop row by row when the shape has a twist (the superellipse then
+// changes every row) and agree with Scalar to float rounding otherwise.
+enum class GeometryKernel { Scalar, Table, Simd };
+
+const int kVertexFloats = 8;
+
+// radius multiplier along the height
+float profileScale(Profile p, float vParam);
+
+// fills v with rows*cols vertices of the surface at time t; wave (rows*cols, optional) replaces the
+// analytic travelling wave with a simulated field. pool is only used by Table/Simd. t stays double up to
+// the wave's phase, which is reduced to one period first, so late times are as smooth as early ones.
+void sculptureVertices(std::vector<float>& v, int rows, int cols, double t, const float* wave = nullptr,
+                       const SculptureShape& shape = SculptureShape(),
+                       GeometryKernel kernel = GeometryKernel::Scalar, ThreadPool* pool = nullptr);
+// two triangles per quad, wrapping around in columns: (rows - 1) * cols * 6 indices
+void sculptureIndices(std::vector<unsigned int>& idx, int rows, int cols, ThreadPool* pool = nullptr);
+// the same triangles as one GL_TRIANGLE_STRIP: a band of 2 * (cols + 1) indices per ring pair, joined by
+// two repeated indices (degenerate triangles, even count so the winding holds) -> (rows - 1) * (2 * cols + 4) - 2
+void sculptureStripIndices(std::vector<unsigned int>& idx, int rows, int cols, ThreadPool* pool = nullptr);
+
+// one chunk of the rows x cols surface for out-of-core rendering (sculpture_stream.h): (n + 1)^2 vertices
+// at rings r0..r1 and segments c0..c1 (c1 may be cols: the seam again, with u = 1), spread evenly, then a
+// skirt of 4n border copies moved `skirt` towards the axis. Untwisted shapes only. out holds
+// patchVertices(n) * kVertexFloats floats.
+inline int patchVertices(int n) { return (n + 1) * (n + 1) + 4 * n; }
+void sculpturePatch(float* out, int rows, int cols, int r0, int r1, int c0, int c1, int n, double t, float skirt,
+                    const SculptureShape& shape = SculptureShape());
+// the patch's quads (same winding as sculptureIndices) and its skirt: 6n^2 + 24n indices
+void sculpturePatchIndices(std::vector<unsigned int>& idx, int n);
+
+// octahedral unit normal as two snorm16 (x in the low half), for packed vertex formats
+unsigned int packOctNormal(float nx, float ny, float nz);
+
+struct CubeGeometry {
+    float verts[8 * 3];
+    unsigned int idx[36];
+};
+CubeGeometry lightCubeGeometry(float halfSize = 0.08f);
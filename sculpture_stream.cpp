@@ -0,0 +1,316 @@
+#include "sculpture_stream.h"
+
+#include "frustum.h"
+#include "memory_registry.h"
+#include "sculpture_geometry.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+// the top of the tree: 4 chunks around, 2 up; each level halves both
+const int kRootsAround = 4, kRootsUp = 2, kRoots = kRootsAround * kRootsUp;
+const int kAheadPriority = 100;             // per predicted view, after everything the current one needs
+const size_t kMaxBounds = 1 << 16;
+const size_t kMaxQueue = 1024;
+
+uint64_t nodeKey(int level, int i, int j) { return (uint64_t)level << 48 | (uint64_t)i << 24 | (uint64_t)j; }
+int keyLevel(uint64_t k) { return (int)(k >> 48); }
+int keyI(uint64_t k) { return (int)(k >> 24 & 0xffffff); }
+int keyJ(uint64_t k) { return (int)(k & 0xffffff); }
+
+// grid rings [r0, r1] and segments [c0, c1] a node covers
+struct NodeRange {
+    int r0, r1, c0, c1;
+};
+NodeRange nodeRange(const SculptureStream& s, uint64_t key) {
+    int level = keyLevel(key);
+    long long around = (long long)kRootsAround << level, up = (long long)kRootsUp << level;
+    long long i = keyI(key), j = keyJ(key);
+    long long rows = s.settings.rows - 1, cols = s.settings.cols;
+    return { (int)(rows * j / up), (int)(rows * (j + 1) / up), (int)(cols * i / around), (int)(cols * (i + 1) / around) };
+}
+
+bool isLeaf(const SculptureStream& s, uint64_t key) {
+    NodeRange r = nodeRange(s, key);
+    return keyLevel(key) >= s.maxLevel || (r.r1 - r.r0 <= s.settings.chunkQuads && r.c1 - r.c0 <= s.settings.chunkQuads);
+}
+
+// rough world size of a chunk's quads (radius ~1, height 3), for the skirt
+float quadSize(const NodeRange& r, const StreamSettings& st) {
+    float du = (float)(r.c1 - r.c0) / st.cols * glm::two_pi<float>(), dv = (float)(r.r1 - r.r0) / (st.rows - 1) * 3.0f;
+    return std::max(du, dv) / st.chunkQuads;
+}
+
+// from a 3 x 3 sample of the surface, padded for what bulges between the samples
+StreamBounds nodeBounds(SculptureStream& s, uint64_t key) {
+    auto it = s.bounds.find(key);
+    if (it != s.bounds.end()) return it->second;
+    if (s.bounds.size() >= kMaxBounds) s.bounds.clear();
+    NodeRange r = nodeRange(s, key);
+    float v[32 * kVertexFloats];
+    sculpturePatch(v, s.settings.rows, s.settings.cols, r.r0, r.r1, r.c0, r.c1, 2, s.settings.time, 0.0f, s.settings.shape);
+    glm::vec3 lo(1e30f), hi(-1e30f);
+    for (int k = 0; k < 9; ++k) {
+        glm::vec3 p(v[k * kVertexFloats], v[k * kVertexFloats + 1], v[k * kVertexFloats + 2]);
+        lo = glm::min(lo, p); hi = glm::max(hi, p);
+    }
+    StreamBounds b;
+    b.center = (lo + hi) * 0.5f;
+    b.extent = glm::length(hi - lo);
+    b.radius = b.extent * 0.75f + 0.05f;
+    return s.bounds[key] = b;
+}
+
+bool visible(const Frustum& f, const StreamBounds& b) { return sphereVisible(f, b.center, b.radius); }
+
+struct Walk {
+    Frustum frustum;
+    glm::vec3 eye;              // object space
+    float pixelScale;           // world size at distance 1 -> pixels
+    bool draw;
+    float priority;
+    std::vector<StreamRequest>* requests;
+};
+
+Walk makeWalk(const StreamView& v, bool draw, float priority, std::vector<StreamRequest>* requests) {
+    Walk w;
+    w.frustum = frustumOf(v.proj * v.view * v.model);  // object space
+    w.eye = glm::vec3(glm::inverse(v.view * v.model) * glm::vec4(0, 0, 0, 1));
+    w.pixelScale = v.viewportHeight * 0.5f * v.proj[1][1];
+    w.draw = draw;
+    w.priority = priority;
+    w.requests = requests;
+    return w;
+}
+
+void request(SculptureStream& s, Walk& w, uint64_t key) {
+    if (!s.resident.count(key)) w.requests->push_back({ key, w.priority + keyLevel(key) });
+}
+
+bool wantsChildren(SculptureStream& s, const Walk& w, uint64_t key, const StreamBounds& b) {
+    if (isLeaf(s, key)) return false;
+    float dist = std::max(glm::length(w.eye - b.center) - b.radius, 0.01f);
+    return b.extent / s.settings.chunkQuads * w.pixelScale / dist > s.settings.pixelsPerQuad;
+}
+
+void walk(SculptureStream& s, Walk& w, uint64_t key) {
+    StreamBounds b = nodeBounds(s, key);
+    if (!visible(w.frustum, b)) return;
+    auto res = s.resident.find(key);
+    if (res != s.resident.end()) s.slotUsed[res->second] = s.frame;     // ancestors of what's drawn stay warm
+    int level = keyLevel(key), i = keyI(key), j = keyJ(key);
+    if (wantsChildren(s, w, key, b)) {
+        uint64_t kids[4] = { nodeKey(level + 1, 2 * i, 2 * j), nodeKey(level + 1, 2 * i + 1, 2 * j),
+                             nodeKey(level + 1, 2 * i, 2 * j + 1), nodeKey(level + 1, 2 * i + 1, 2 * j + 1) };
+        bool ready = true;
+        for (uint64_t k : kids) {
+            if (s.resident.count(k) || !visible(w.frustum, nodeBounds(s, k))) continue;
+            ready = false;
+            request(s, w, k);
+        }
+        // prefetch looks past what's resident; drawing only descends once the visible children are all in
+        if (ready || !w.draw) {
+            for (uint64_t k : kids) walk(s, w, k);
+            return;
+        }
+    }
+    if (!w.draw) {
+        request(s, w, key);     // the level this view wants
+        return;
+    }
+    if (res != s.resident.end()) s.drawList.push_back(res->second);
+    else request(s, w, key);
+}
+
+int takeSlot(SculptureStream& s) {
+    if (!s.freeSlots.empty()) {
+        int slot = s.freeSlots.back();
+        s.freeSlots.pop_back();
+        return slot;
+    }
+    // least recently visited, never a root and never one this frame's walk touched
+    int best = -1;
+    for (int slot = 0; slot < (int)s.slotKey.size(); ++slot) {
+        if (keyLevel(s.slotKey[slot]) == 0 || s.slotUsed[slot] == s.frame) continue;
+        if (best < 0 || s.slotUsed[slot] < s.slotUsed[best]) best = slot;
+    }
+    if (best >= 0) {
+        s.resident.erase(s.slotKey[best]);
+        ++s.stats.evicted;
+    }
+    return best;
+}
+
+void workerLoop(SculptureStream* s) {
+    std::unique_lock<std::mutex> lock(s->mtx);
+    for (;;) {
+        s->wake.wait(lock, [&] { return s->quit || (!s->queue.empty() && !s->freeStaging.empty()); });
+        if (s->quit) return;
+        StreamRequest rq = s->queue.back();
+        s->queue.pop_back();
+        if (s->inFlight.count(rq.key)) continue;
+        int buf = s->freeStaging.back();
+        s->freeStaging.pop_back();
+        s->inFlight.insert(rq.key);
+        lock.unlock();
+
+        NodeRange r = nodeRange(*s, rq.key);
+        const StreamSettings& st = s->settings;
+        // deep enough for the crack against a neighbour one level coarser
+        float skirt = quadSize(r, st) * 2.0f;
+        sculpturePatch(s->staging[buf].data(), st.rows, st.cols, r.r0, r.r1, r.c0, r.c1, st.chunkQuads, st.time, skirt, st.shape);
+
+        lock.lock();
+        s->ready.push_back({ rq.key, buf });
+        ++s->generated;
+    }
+}
+
+} // namespace
+
+bool startSculptureStream(SculptureStream& s, const StreamSettings& settings) {
+    s.settings = settings;
+    StreamSettings& st = s.settings;
+    st.rows = std::max(st.rows, 2);
+    st.cols = std::max(st.cols, 3);
+    st.chunkQuads = std::max(st.chunkQuads, 2);
+    // deepest level: the chunks cover at most n quads each way, i.e. at least the grid's own spacing
+    while ((long long)(st.cols / kRootsAround >> s.maxLevel) > st.chunkQuads ||
+           (long long)((st.rows - 1) / kRootsUp >> s.maxLevel) > st.chunkQuads)
+        ++s.maxLevel;
+
+    s.vertsPerChunk = patchVertices(st.chunkQuads);
+    s.chunkBytes = (size_t)s.vertsPerChunk * kVertexFloats * sizeof(float);
+    int slots = (int)(st.gpuBytes / s.chunkBytes);
+    if (slots < kRoots * 2) {
+        std::cerr << "a " << st.gpuBytes / (1024 * 1024) << " MB stream pool can't hold " << kRoots * 2 << " chunks of "
+                  << s.chunkBytes / 1024 << " KB\n";
+        return false;
+    }
+    s.slotKey.assign(slots, 0);
+    s.slotUsed.assign(slots, 0);
+    for (int i = slots - 1; i >= 0; --i) s.freeSlots.push_back(i);
+    s.stats.slots = slots;
+
+    s.topology = acquireGridTopology(st.chunkQuads, st.chunkQuads, IndexLayout::Patch);
+    s.vao = genVertexArray();
+    s.vbo = genBuffer();
+    glBindVertexArray(s.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, s.vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(s.chunkBytes * slots), nullptr, GL_DYNAMIC_DRAW);
+    GLsizei stride = kVertexFloats * sizeof(float);
+    glEnableVertexAttribArray(0); glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glEnableVertexAttribArray(1); glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(2); glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s.topology->ebo);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    trackGpu(GpuObject::Buffer, s.vbo, MemTag::Sculpture, s.chunkBytes * slots);
+
+    int workers = st.workers > 0 ? st.workers : (int)std::thread::hardware_concurrency() / 2;
+    if (workers < 1) workers = 1;
+    s.staging.resize(workers * 2 + 2);
+    for (int i = 0; i < (int)s.staging.size(); ++i) {
+        s.staging[i].resize((size_t)s.vertsPerChunk * kVertexFloats);
+        s.freeStaging.push_back(i);
+    }
+    trackCpu(&s.staging, MemTag::Sculpture, s.staging.size() * s.chunkBytes);
+    for (int i = 0; i < workers; ++i) s.workers.emplace_back(workerLoop, &s);
+    return true;
+}
+
+void updateSculptureStream(SculptureStream& s, const StreamView& now, const std::vector<StreamView>& ahead) {
+    ++s.frame;
+    std::vector<std::pair<uint64_t, int>> done;
+    {
+        std::lock_guard<std::mutex> lock(s.mtx);
+        size_t n = std::min(s.ready.size(), (size_t)s.settings.uploadsPerFrame);
+        done.assign(s.ready.begin(), s.ready.begin() + n);
+        s.ready.erase(s.ready.begin(), s.ready.begin() + n);
+        s.stats.generated = s.generated;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, s.vbo);
+    for (auto& d : done) {
+        int slot = takeSlot(s);
+        if (slot < 0) {
+            ++s.stats.dropped;      // everything is in use this frame; asked for again later
+            continue;
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(s.chunkBytes * slot), (GLsizeiptr)s.chunkBytes, s.staging[d.second].data());
+        s.slotKey[slot] = d.first;
+        s.slotUsed[slot] = s.frame;
+        s.resident[d.first] = slot;
+        ++s.stats.uploaded;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    std::vector<StreamRequest> requests;
+    s.drawList.clear();
+    Walk w = makeWalk(now, true, 0.0f, &requests);
+    for (int j = 0; j < kRootsUp; ++j)
+        for (int i = 0; i < kRootsAround; ++i) {
+            uint64_t key = nodeKey(0, i, j);
+            // the roots are what everything falls back to: always wanted, visible or not
+            if (!s.resident.count(key)) requests.push_back({ key, -1.0f });
+            walk(s, w, key);
+        }
+    for (size_t k = 0; k < ahead.size(); ++k) {
+        Walk a = makeWalk(ahead[k], false, (float)(kAheadPriority * (k + 1)), &requests);
+        for (int j = 0; j < kRootsUp; ++j)
+            for (int i = 0; i < kRootsAround; ++i) walk(s, a, nodeKey(0, i, j));
+    }
+
+    // best last, one entry per node
+    std::sort(requests.begin(), requests.end(), [](const StreamRequest& a, const StreamRequest& b) {
+        return a.key != b.key ? a.key < b.key : a.priority < b.priority;
+    });
+    requests.erase(std::unique(requests.begin(), requests.end(),
+                               [](const StreamRequest& a, const StreamRequest& b) { return a.key == b.key; }),
+                   requests.end());
+    std::sort(requests.begin(), requests.end(),
+              [](const StreamRequest& a, const StreamRequest& b) { return a.priority > b.priority; });
+    if (requests.size() > kMaxQueue) requests.erase(requests.begin(), requests.end() - kMaxQueue);
+    {
+        std::lock_guard<std::mutex> lock(s.mtx);
+        for (auto& d : done) {
+            s.inFlight.erase(d.first);
+            s.freeStaging.push_back(d.second);
+        }
+        s.queue.clear();
+        for (const StreamRequest& r : requests)
+            if (!s.inFlight.count(r.key)) s.queue.push_back(r);
+        s.stats.pending = (int)(s.queue.size() + s.inFlight.size());
+    }
+    s.wake.notify_all();
+
+    s.stats.resident = (int)s.resident.size();
+    s.stats.drawn = (int)s.drawList.size();
+    s.stats.triangles = (long long)s.drawList.size() * s.topology->triangles;
+}
+
+void drawSculptureStream(SculptureStream& s) {
+    glBindVertexArray(s.vao);
+    for (int slot : s.drawList)
+        glDrawElementsBaseVertex(GL_TRIANGLES, s.topology->indexCount, GL_UNSIGNED_INT, 0, slot * s.vertsPerChunk);
+    glBindVertexArray(0);
+}
+
+void stopSculptureStream(SculptureStream& s) {
+    {
+        std::lock_guard<std::mutex> lock(s.mtx);
+        s.quit = true;
+    }
+    s.wake.notify_all();
+    for (std::thread& t : s.workers) t.join();
+    s.workers.clear();
+    untrackCpu(&s.staging);
+    s.staging.clear();
+    s.vao.reset();
+    s.vbo.reset();
+    s.topology.reset();
+}
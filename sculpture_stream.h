@@ -0,0 +1,99 @@
+#pragma once
+// === out-of-core sculpture: chunks of a huge grid streamed through a fixed GPU pool ===
+// A 50k x 50k grid is 80 GB of vertices, so it is never built. The surface is a quadtree of chunks,
+// each n x n quads spaced as its level needs, plus a skirt over the cracks between levels. Every frame
+// the tree is walked for the view, refining while a chunk's quads would cover more than
+// `pixelsPerQuad` pixels, and the finest chunks that are resident and cover the view are drawn. The
+// roots stay resident, so something can always be drawn. Missing chunks are generated on worker threads
+// into a bounded set of staging buffers. A few per frame are uploaded into slots of one fixed-size vertex
+// buffer, evicting the slot visited longest ago. Views a little further along the camera path are walked
+// too, so chunks tend to arrive before they're needed.
+// GPU memory is the pool and CPU memory the staging set, whatever the grid size. The geometry is frozen
+// at one time; the default sculpture isn't re-animated on the CPU either.
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "gl_resources.h"
+#include "grid_topology.h"
+#include "sculpture_geometry.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct StreamSettings {
+    int rows = 0, cols = 0;             // the virtual grid
+    size_t gpuBytes = 64u << 20;        // vertex pool
+    int chunkQuads = 64;                // n: quads per chunk side
+    float pixelsPerQuad = 2.0f;         // refine while a chunk's quads are bigger than this on screen
+    float time = 0.0f;                  // the frozen pose
+    SculptureShape shape;               // untwisted
+    int workers = 0;                    // 0 = half the hardware threads, at least one
+    int uploadsPerFrame = 8;
+};
+
+struct StreamView {
+    glm::mat4 proj, view, model;
+    float viewportHeight = 720.0f;
+};
+
+struct StreamStats {
+    uint64_t generated = 0, uploaded = 0, evicted = 0, dropped = 0;
+    int resident = 0, slots = 0, drawn = 0, pending = 0;
+    long long triangles = 0;            // drawn this frame, skirts not counted
+};
+
+struct StreamBounds {
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f, extent = 0.0f; // bounding sphere; extent = box diagonal, for the LOD metric
+};
+
+struct StreamRequest {
+    uint64_t key = 0;
+    float priority = 0.0f;              // lower first
+};
+
+struct SculptureStream {
+    StreamSettings settings;
+    int maxLevel = 0, vertsPerChunk = 0;
+    size_t chunkBytes = 0;
+    GlVertexArray vao;
+    GlBuffer vbo;
+    GridTopologyRef topology;
+
+    // main thread: which node each slot holds and when a walk last visited it
+    std::unordered_map<uint64_t, int> resident;
+    std::vector<uint64_t> slotKey, slotUsed;
+    std::vector<int> freeSlots;
+    std::vector<int> drawList;
+    std::unordered_map<uint64_t, StreamBounds> bounds;     // cleared when it gets large
+    uint64_t frame = 0;
+    StreamStats stats;
+
+    // shared with the workers, under mtx
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::vector<StreamRequest> queue;                       // replaced every frame, best last
+    std::unordered_set<uint64_t> inFlight;                  // being generated or waiting for upload
+    std::vector<std::vector<float>> staging;
+    std::vector<int> freeStaging;
+    std::vector<std::pair<uint64_t, int>> ready;            // node, staging buffer
+    uint64_t generated = 0;
+    bool quit = false;
+    std::vector<std::thread> workers;
+};
+
+// sizes the pool, uploads nothing yet and starts the workers; false if the pool can't hold the roots
+bool startSculptureStream(SculptureStream& s, const StreamSettings& settings);
+// once per frame before drawing: uploads finished chunks, walks `now` for the draw list and `ahead`
+// (predicted views, nearest first) for prefetch requests
+void updateSculptureStream(SculptureStream& s, const StreamView& now, const std::vector<StreamView>& ahead);
+// the draw list with the sculpture program bound and its uModel set to the view's model
+void drawSculptureStream(SculptureStream& s);
+// joins the workers and frees the pool
+void stopSculptureStream(SculptureStream& s);
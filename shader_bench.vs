@@ -0,0 +1,14 @@
+#version 330 core
+// full-screen triangle standing in for the sculpture in --bench-shaders: a 4x4 patch in the z = 0
+// plane, normals fanned out so every pixel sees a different mix of diffuse and specular
+out VS_OUT{
+    vec3 FragPos;
+    vec3 Normal;
+} vs_out;
+
+void main(){
+    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    gl_Position = vec4(p, 0.0, 1.0);
+    vs_out.FragPos = vec3(p * 2.0, 0.0);
+    vs_out.Normal = vec3(p * 0.6, 1.0);
+}
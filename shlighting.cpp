@@ -0,0 +1,120 @@
+#include "shlighting.h"
+#include "simd4.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int kGrain = 1024;
+
+// the shader evaluates bare polynomials, so each basis normalisation appears squared here
+// (projection and evaluation), together with the clamped-cosine convolution (pi, 2pi/3, pi/4)
+const float kPi = 3.14159265358979323846f;
+const float kB0 = 0.282095f * 0.282095f * kPi;
+const float kB1 = 0.488603f * 0.488603f * 2.0f * kPi / 3.0f;
+const float kB2 = 1.092548f * 1.092548f * kPi / 4.0f;
+const float kB20 = 0.315392f * 0.315392f * kPi / 4.0f;
+const float kB22 = 0.546274f * 0.546274f * kPi / 4.0f;
+
+float luminance(glm::vec3 c) { return 0.2126f * c.x + 0.7152f * c.y + 0.0722f * c.z; }
+
+float boxDistance(glm::vec3 p, glm::vec3 bmin, glm::vec3 bmax) {
+    glm::vec3 gap = glm::max(glm::max(bmin - p, p - bmax), glm::vec3(0.0f));
+    return sqrtf(glm::dot(gap, gap));
+}
+
+// 27 colour sums plus the ambient, kept 4 lanes wide until the end of a chunk
+struct Acc {
+    F4 r[9], g[9], b[9];
+    F4 ar, ag, ab;
+};
+
+void projectRange(const std::vector<PointLight>& lights, glm::vec3 probe, int begin, int end, ShProbe& out) {
+    Acc acc;
+    int i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const PointLight* L = &lights[i];
+        F4 dx(L[0].position.x - probe.x, L[1].position.x - probe.x, L[2].position.x - probe.x, L[3].position.x - probe.x);
+        F4 dy(L[0].position.y - probe.y, L[1].position.y - probe.y, L[2].position.y - probe.y, L[3].position.y - probe.y);
+        F4 dz(L[0].position.z - probe.z, L[1].position.z - probe.z, L[2].position.z - probe.z, L[3].position.z - probe.z);
+        F4 d = max4(sqrt4(dx * dx + dy * dy + dz * dz), F4(1e-6f));
+        F4 inv = F4(1.0f) / d;
+        F4 x = dx * inv, y = dy * inv, z = dz * inv;
+        F4 att = F4(1.0f) / (F4(L[0].constant, L[1].constant, L[2].constant, L[3].constant)
+                           + F4(L[0].linear, L[1].linear, L[2].linear, L[3].linear) * d
+                           + F4(L[0].quadratic, L[1].quadratic, L[2].quadratic, L[3].quadratic) * d * d);
+        F4 basis[9] = {
+            F4(kB0), F4(kB1) * y, F4(kB1) * z, F4(kB1) * x,
+            F4(kB2) * x * y, F4(kB2) * y * z, F4(kB20) * (F4(3.0f) * z * z - F4(1.0f)),
+            F4(kB2) * x * z, F4(kB22) * (x * x - y * y)
+        };
+        F4 cr = F4(L[0].diffuse.x, L[1].diffuse.x, L[2].diffuse.x, L[3].diffuse.x) * att;
+        F4 cg = F4(L[0].diffuse.y, L[1].diffuse.y, L[2].diffuse.y, L[3].diffuse.y) * att;
+        F4 cb = F4(L[0].diffuse.z, L[1].diffuse.z, L[2].diffuse.z, L[3].diffuse.z) * att;
+        for (int k = 0; k < 9; ++k) {
+            acc.r[k] = acc.r[k] + basis[k] * cr;
+            acc.g[k] = acc.g[k] + basis[k] * cg;
+            acc.b[k] = acc.b[k] + basis[k] * cb;
+        }
+        acc.ar = acc.ar + F4(L[0].ambient.x, L[1].ambient.x, L[2].ambient.x, L[3].ambient.x) * att;
+        acc.ag = acc.ag + F4(L[0].ambient.y, L[1].ambient.y, L[2].ambient.y, L[3].ambient.y) * att;
+        acc.ab = acc.ab + F4(L[0].ambient.z, L[1].ambient.z, L[2].ambient.z, L[3].ambient.z) * att;
+    }
+    auto hsum = [](F4 v) { return v[0] + v[1] + v[2] + v[3]; };
+    for (int k = 0; k < 9; ++k) out.irradiance[k] += glm::vec3(hsum(acc.r[k]), hsum(acc.g[k]), hsum(acc.b[k]));
+    out.ambient += glm::vec3(hsum(acc.ar), hsum(acc.ag), hsum(acc.ab));
+
+    for (; i < end; ++i) {
+        const PointLight& L = lights[i];
+        glm::vec3 dir = L.position - probe;
+        float d = std::max(glm::length(dir), 1e-6f);
+        dir /= d;
+        float att = attenuation(L, d);
+        float basis[9] = {
+            kB0, kB1 * dir.y, kB1 * dir.z, kB1 * dir.x,
+            kB2 * dir.x * dir.y, kB2 * dir.y * dir.z, kB20 * (3.0f * dir.z * dir.z - 1.0f),
+            kB2 * dir.x * dir.z, kB22 * (dir.x * dir.x - dir.y * dir.y)
+        };
+        for (int k = 0; k < 9; ++k) out.irradiance[k] += L.diffuse * (basis[k] * att);
+        out.ambient += L.ambient * att;
+    }
+}
+
+} // namespace
+
+void splitLights(const std::vector<PointLight>& lights, glm::vec3 omin, glm::vec3 omax, const ShSplitSettings& s,
+                 std::vector<PointLight>& exact, std::vector<PointLight>& far) {
+    exact.clear(); far.clear();
+    std::vector<std::pair<float, int>> near; // best-case contribution, light index
+    for (int i = 0; i < (int)lights.size(); ++i) {
+        const PointLight& L = lights[i];
+        float d = boxDistance(L.position, omin, omax);
+        float best = luminance(L.ambient + L.diffuse + L.specular) * attenuation(L, d);
+        if (d > s.farDistance || best < s.minContribution) far.push_back(L);
+        else near.push_back({ best, i });
+    }
+    if ((int)near.size() > s.maxExact) {
+        std::nth_element(near.begin(), near.begin() + s.maxExact, near.end(),
+                         [](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.first > b.first; });
+        for (size_t k = s.maxExact; k < near.size(); ++k) far.push_back(lights[near[k].second]);
+        near.resize(s.maxExact);
+    }
+    for (const auto& n : near) exact.push_back(lights[n.second]);
+}
+
+void projectLightsSH(const std::vector<PointLight>& lights, glm::vec3 probe, ShProbe& out, ThreadPool& pool) {
+    out = ShProbe();
+    int n = (int)lights.size();
+    if (n == 0) return;
+    // one partial result per chunk, summed serially so the result doesn't depend on scheduling
+    std::vector<ShProbe> partial((n + kGrain - 1) / kGrain);
+    pool.parallelFor(n, kGrain, [&](int begin, int end) {
+        projectRange(lights, probe, begin, end, partial[begin / kGrain]);
+    });
+    for (const ShProbe& p : partial) {
+        for (int k = 0; k < 9; ++k) out.irradiance[k] += p.irradiance[k];
+        out.ambient += p.ambient;
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+// === distant and dim point lights folded into L2 spherical harmonics ===
+// Lights far from an object (or too dim to matter) only add a soft fill, so instead of looping over them
+// in sculpture.fs they are projected on the CPU into 9 RGB irradiance coefficients seen from a probe
+// point. The cosine lobe is already convolved in, so the shader just evaluates the 9 basis functions at
+// the normal. Their specular term is dropped; near lights keep the exact calcPoint path.
+#include "lights.h"
+
+#include <vector>
+
+struct ThreadPool;
+
+struct ShProbe {
+    glm::vec3 irradiance[9];    // order: l=0; l=1 (y, z, x); l=2 (xy, yz, 3z^2-1, xz, x^2-y^2)
+    glm::vec3 ambient = glm::vec3(0.0f); // summed, attenuated ambient terms of the projected lights
+    ShProbe() { for (glm::vec3& c : irradiance) c = glm::vec3(0.0f); }
+};
+
+struct ShSplitSettings {
+    float farDistance = 2.0f;       // lights further than this from the object's bounds go to SH
+    float minContribution = 0.02f;  // ...as do lights whose best-case luminance on the object is below this
+    int maxExact = kMaxShaderLights;// exact lights beyond this spill into SH, dimmest first
+};
+
+// splits lights for an object with world bounds [omin, omax] into exact and SH sets
+void splitLights(const std::vector<PointLight>& lights, glm::vec3 omin, glm::vec3 omax, const ShSplitSettings& s,
+                 std::vector<PointLight>& exact, std::vector<PointLight>& far);
+// projects `lights` as seen from `probe`, 4 lights per SIMD step, chunks spread over the pool
+void projectLightsSH(const std::vector<PointLight>& lights, glm::vec3 probe, ShProbe& out, ThreadPool& pool);
@@ -0,0 +1,56 @@
+#pragma once
+// === 4-wide float helper: SSE when the target has it, plain floats otherwise ===
+// kept deliberately tiny; only what the CPU kernels actually need
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD4_SSE 1
+#include <immintrin.h>
+#endif
+
+struct F4 {
+#ifdef SIMD4_SSE
+    __m128 v;
+    F4() : v(_mm_setzero_ps()) {}
+    F4(__m128 x) : v(x) {}
+    explicit F4(float s) : v(_mm_set1_ps(s)) {}
+    F4(float a, float b, float c, float d) : v(_mm_setr_ps(a, b, c, d)) {}
+    static F4 load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    float operator[](int i) const { alignas(16) float t[4]; _mm_store_ps(t, v); return t[i]; }
+#else
+    float v[4];
+    F4() : v{ 0, 0, 0, 0 } {}
+    explicit F4(float s) : v{ s, s, s, s } {}
+    F4(float a, float b, float c, float d) : v{ a, b, c, d } {}
+    static F4 load(const float* p) { return F4(p[0], p[1], p[2], p[3]); }
+    void store(float* p) const { for (int i = 0; i < 4; ++i) p[i] = v[i]; }
+    float operator[](int i) const { return v[i]; }
+#endif
+};
+
+#ifdef SIMD4_SSE
+inline F4 operator+(F4 a, F4 b) { return _mm_add_ps(a.v, b.v); }
+inline F4 operator-(F4 a, F4 b) { return _mm_sub_ps(a.v, b.v); }
+inline F4 operator*(F4 a, F4 b) { return _mm_mul_ps(a.v, b.v); }
+inline F4 operator/(F4 a, F4 b) { return _mm_div_ps(a.v, b.v); }
+inline F4 sqrt4(F4 a) { return _mm_sqrt_ps(a.v); }
+inline F4 min4(F4 a, F4 b) { return _mm_min_ps(a.v, b.v); }
+inline F4 max4(F4 a, F4 b) { return _mm_max_ps(a.v, b.v); }
+// mask ? a : b, mask from the compare helpers below
+inline F4 select4(F4 mask, F4 a, F4 b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+inline F4 greater4(F4 a, F4 b) { return _mm_cmpgt_ps(a.v, b.v); }
+inline F4 abs4(F4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+#else
+#define SIMD4_BINOP(op) \
+    inline F4 operator op(F4 a, F4 b) { return F4(a.v[0] op b.v[0], a.v[1] op b.v[1], a.v[2] op b.v[2], a.v[3] op b.v[3]); }
+SIMD4_BINOP(+) SIMD4_BINOP(-) SIMD4_BINOP(*) SIMD4_BINOP(/)
+#undef SIMD4_BINOP
+inline F4 sqrt4(F4 a) { return F4(std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3])); }
+inline F4 min4(F4 a, F4 b) { F4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+inline F4 max4(F4 a, F4 b) { F4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return r; }
+// scalar fallback uses 1.0/0.0 as the mask
+inline F4 select4(F4 mask, F4 a, F4 b) { F4 r; for (int i = 0; i < 4; ++i) r.v[i] = mask.v[i] != 0.0f ? a.v[i] : b.v[i]; return r; }
+inline F4 greater4(F4 a, F4 b) { F4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] > b.v[i] ? 1.0f : 0.0f; return r; }
+inline F4 abs4(F4 a) { return F4(std::fabs(a.v[0]), std::fabs(a.v[1]), std::fabs(a.v[2]), std::fabs(a.v[3])); }
+#endif
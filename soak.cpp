@@ -0,0 +1,164 @@
+#include "soak.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+const double kRssSlackMb = 8.0, kRssSlackFraction = 0.05;   // allocator and driver caches settle slowly
+const double kTrackedSlackMb = 1.0, kTrackedSlackFraction = 0.02;
+const double kObjectSlack = 0.5;                            // the count in a given step should be exact
+const double kFrameP99Ratio = 1.5;                          // late p99 vs early p99, same step
+const double kMaxStepFrames = 0.25;                          // of a 60 Hz frame: visible stutter past it
+const int kMinSamples = 3;                                  // per step, after the warm-up cycle
+
+// least-squares growth of y over the span of x
+double fittedGrowth(const std::vector<double>& x, const std::vector<double>& y) {
+    size_t n = x.size();
+    double mx = 0.0, my = 0.0;
+    for (size_t i = 0; i < n; ++i) { mx += x[i]; my += y[i]; }
+    mx /= n; my /= n;
+    double sxy = 0.0, sxx = 0.0;
+    for (size_t i = 0; i < n; ++i) { sxy += (x[i] - mx) * (y[i] - my); sxx += (x[i] - mx) * (x[i] - mx); }
+    return sxx > 0.0 ? sxy / sxx * (x.back() - x.front()) : 0.0;
+}
+
+double median(std::vector<double> v) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+// the samples of one step after the warm-up cycle
+std::vector<const SoakSample*> stepSamples(const std::vector<SoakSample>& samples, int step) {
+    std::vector<const SoakSample*> out;
+    for (size_t i = kSoakSteps; i < samples.size(); ++i)
+        if ((int)samples[i].step == step) out.push_back(&samples[i]);
+    return out;
+}
+
+// worst fitted growth over every step, against slack + fraction of that step's first value
+SoakCheck growthCheck(const char* name, const std::vector<SoakSample>& samples, double (*value)(const SoakSample&),
+                      double slack, double fraction) {
+    SoakCheck c;
+    c.name = name;
+    double worst = 0.0, limit = slack, first = 0.0, last = 0.0;
+    bool conclusive = true, any = false;
+    const char* worstStep = "none";
+    for (int step = 0; step < kSoakSteps; ++step) {
+        std::vector<const SoakSample*> s = stepSamples(samples, step);
+        if ((int)s.size() < kMinSamples) { conclusive = false; continue; }
+        std::vector<double> x, y;
+        for (const SoakSample* p : s) { x.push_back(p->wallS); y.push_back(value(*p)); }
+        double growth = fittedGrowth(x, y), stepLimit = slack + fraction * fabs(y.front());
+        // the step closest to (or furthest past) its limit
+        if (!any || growth - stepLimit > worst - limit) {
+            worst = growth; limit = stepLimit; first = y.front(); last = y.back();
+            worstStep = soakStepName((SoakStep)step);
+            any = true;
+        }
+    }
+    c.ok = conclusive && worst <= limit;
+    char buf[192];
+    snprintf(buf, sizeof(buf), "growth=%.3f limit=%.3f first=%.3f last=%.3f step=%s%s", worst, limit, first, last,
+             worstStep, conclusive ? "" : " inconclusive=1");
+    c.detail = buf;
+    return c;
+}
+
+} // namespace
+
+double minSoakSeconds(double intervalS) {
+    return (1 + kMinSamples) * kSoakSteps * intervalS;
+}
+
+const char* soakStepName(SoakStep s) {
+    static const char* names[kSoakSteps] = { "baseline", "coarser", "reload", "more-lights" };
+    return (int)s < kSoakSteps ? names[(int)s] : "?";
+}
+
+std::vector<SoakCheck> evaluateSoak(const std::vector<SoakSample>& samples) {
+    std::vector<SoakCheck> checks;
+    checks.push_back(growthCheck("rss_mb", samples, [](const SoakSample& s) { return s.rssMb; }, kRssSlackMb,
+                                 kRssSlackFraction));
+    checks.push_back(growthCheck("gpu_objects", samples, [](const SoakSample& s) { return (double)s.gpuObjects; },
+                                 kObjectSlack, 0.0));
+    checks.push_back(growthCheck("gpu_tracked_mb", samples, [](const SoakSample& s) { return s.gpuMb; }, kTrackedSlackMb,
+                                 kTrackedSlackFraction));
+    checks.push_back(growthCheck("cpu_tracked_mb", samples, [](const SoakSample& s) { return s.cpuMb; }, kTrackedSlackMb,
+                                 kTrackedSlackFraction));
+
+    // frame time: the last third of each step's samples against its first third
+    SoakCheck frame;
+    frame.name = "frame_p99_ms";
+    double worstRatio = 0.0, early = 0.0, late = 0.0;
+    bool conclusive = true;
+    for (int step = 0; step < kSoakSteps; ++step) {
+        std::vector<const SoakSample*> s = stepSamples(samples, step);
+        if ((int)s.size() < kMinSamples) { conclusive = false; continue; }
+        size_t third = s.size() / 3;
+        std::vector<double> a, b;
+        for (size_t i = 0; i < third; ++i) a.push_back(s[i]->frameP99Ms);
+        for (size_t i = s.size() - third; i < s.size(); ++i) b.push_back(s[i]->frameP99Ms);
+        double ratio = median(a) > 0.0 ? median(b) / median(a) : 0.0;
+        if (ratio > worstRatio) { worstRatio = ratio; early = median(a); late = median(b); }
+    }
+    frame.ok = conclusive && worstRatio <= kFrameP99Ratio;
+    char buf[192];
+    snprintf(buf, sizeof(buf), "ratio=%.3f limit=%.3f early=%.3f late=%.3f%s", worstRatio, kFrameP99Ratio, early, late,
+             conclusive ? "" : " inconclusive=1");
+    frame.detail = buf;
+    checks.push_back(frame);
+
+    // the clock: the timeline is a double and every animation reduces its phase before it becomes a float,
+    // so this only fails if something goes back to a float clock
+    SoakCheck clock;
+    clock.name = "clock";
+    double stepFrames = 0.0, clockError = 0.0, atS = 0.0;
+    for (const SoakSample& s : samples) {
+        if (s.stepFrames > stepFrames) { stepFrames = s.stepFrames; atS = s.timelineS; }
+        clockError = std::max(clockError, s.clockErrorS);
+    }
+    clock.ok = !samples.empty() && stepFrames <= kMaxStepFrames;
+    snprintf(buf, sizeof(buf), "step_frames=%.4f limit=%.4f clock_error_s=%.6f worst_at_timeline_s=%.0f%s", stepFrames,
+             kMaxStepFrames, clockError, atS, samples.empty() ? " inconclusive=1" : "");
+    clock.detail = buf;
+    checks.push_back(clock);
+    return checks;
+}
+
+bool soakPassed(const std::vector<SoakCheck>& checks) {
+    for (const SoakCheck& c : checks)
+        if (!c.ok) return false;
+    return true;
+}
+
+std::string soakSummary(const std::vector<SoakCheck>& checks) {
+    std::string out;
+    for (const SoakCheck& c : checks) out += "soak check=" + c.name + " result=" + (c.ok ? "ok " : "fail ") + c.detail + "\n";
+    out += std::string("soak result=") + (soakPassed(checks) ? "pass" : "fail") + "\n";
+    return out;
+}
+
+bool writeSoakReport(const SoakSettings& s, const std::vector<SoakSample>& samples, const std::vector<SoakCheck>& checks) {
+    std::ofstream f(s.reportPath);
+    if (!f) return false;
+    f << "{\n  \"duration_s\": " << s.durationS << ", \"speed\": " << s.speed << ", \"interval_s\": " << s.intervalS
+      << ", \"passed\": " << (soakPassed(checks) ? "true" : "false") << ",\n  \"checks\": [";
+    for (size_t i = 0; i < checks.size(); ++i)
+        f << (i ? ",\n    " : "\n    ") << "{\"name\": \"" << checks[i].name << "\", \"ok\": " << (checks[i].ok ? "true" : "false")
+          << ", \"detail\": \"" << checks[i].detail << "\"}";
+    f << "\n  ],\n  \"samples\": [";
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const SoakSample& p = samples[i];
+        f << (i ? ",\n    " : "\n    ") << "{\"step\": \"" << soakStepName(p.step) << "\", \"wall_s\": " << p.wallS
+          << ", \"timeline_s\": " << p.timelineS << ", \"frames\": " << p.frames << ", \"rss_mb\": " << p.rssMb
+          << ", \"gpu_objects\": " << p.gpuObjects << ", \"gpu_mb\": " << p.gpuMb << ", \"cpu_mb\": " << p.cpuMb
+          << ", \"frame_p50_ms\": " << p.frameP50Ms << ", \"frame_p99_ms\": " << p.frameP99Ms
+          << ", \"clock_error_s\": " << p.clockErrorS << ", \"step_frames\": " << p.stepFrames << "}";
+    }
+    f << "\n  ]\n}\n";
+    return (bool)f;
+}
@@ -0,0 +1,51 @@
+#pragma once
+// === soak runs: hours of accelerated timeline with periodic reconfiguration, checked for unbounded growth ===
+// GL-free. The renderer switches its configuration every interval (see kSoakSteps), and records one
+// SoakSample per interval: memory, tracked GPU objects, the frame-time distribution over the window and
+// how far the float phases handed to the renderer are from exact ones. evaluateSoak() only compares samples
+// taken in the same configuration step, skipping the first cycle so pools, caches and driver state can
+// warm up. Then it fits a line through each quantity and fails when the fitted growth over the run passes
+// the tolerance. Whatever is still climbing after the warm-up cycle counts as a leak.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct SoakSettings {
+    double durationS = 0.0;         // wall seconds; 0 = no soak
+    double speed = 60.0;            // timeline acceleration: g_time advances speed / 60 s per frame
+    double intervalS = 15.0;        // wall seconds between reconfigurations, one sample each
+    std::string reportPath;         // JSON report; the summary always goes to stdout
+};
+
+// what the renderer changes between intervals; one cycle is kSoakSteps intervals
+enum class SoakStep { Baseline, Coarser, Reload, MoreLights };
+const int kSoakSteps = 4;
+const char* soakStepName(SoakStep s);
+
+struct SoakSample {
+    SoakStep step = SoakStep::Baseline;     // configuration during the window
+    double wallS = 0.0, timelineS = 0.0;    // at the end of the window
+    long long frames = 0;                   // in the window
+    double rssMb = 0.0;
+    int gpuObjects = 0;                     // buffers, textures, renderbuffers and programs in memory_registry.h
+    double gpuMb = 0.0, cpuMb = 0.0;        // tracked bytes
+    double frameP50Ms = 0.0, frameP99Ms = 0.0;
+    double clockErrorS = 0.0;               // largest error of the spin's float phase in the window, as time
+    double stepFrames = 0.0;                // timeline resolution at the window's end, in 60 Hz frames: what a
+                                            // real-time run reaching this timeline would step its animation by
+};
+
+struct SoakCheck {
+    std::string name;
+    bool ok = true;
+    std::string detail;                     // "key=value ..." for the summary and the report
+};
+
+// the shortest run evaluateSoak() can judge: the warm-up cycle plus enough samples per step after it
+double minSoakSeconds(double intervalS);
+// one check per tracked quantity; too few samples to tell fail with "inconclusive" in the detail
+std::vector<SoakCheck> evaluateSoak(const std::vector<SoakSample>& samples);
+bool soakPassed(const std::vector<SoakCheck>& checks);
+// "soak check=NAME result=ok|fail ..." per check plus a closing "soak result=..." line
+std::string soakSummary(const std::vector<SoakCheck>& checks);
+bool writeSoakReport(const SoakSettings& s, const std::vector<SoakSample>& samples, const std::vector<SoakCheck>& checks);
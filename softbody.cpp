@@ -0,0 +1,200 @@
+#include "softbody.h"
+#include "simd4.h"
+#include "thread_pool.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+const int kGrain = 2048; // constraints / particles per pool chunk
+
+struct Edge { int a, b; float k; };
+
+// PBD stiffness is applied once per iteration, so spread it to get the same result per step
+float iterationStiffness(float k, int iterations) {
+    return 1.0f - powf(1.0f - k, 1.0f / (float)iterations);
+}
+
+void solveRange(SoftBody& sb, int begin, int end) {
+    float* qx = sb.qx.data(); float* qy = sb.qy.data(); float* qz = sb.qz.data();
+    const int* ca = sb.ca.data(); const int* cb = sb.cb.data();
+    int i = begin;
+    // 4 constraints at a time; inside one colour no two constraints share a particle,
+    // so the gather/scatter below never races
+    for (; i + 4 <= end; i += 4) {
+        int a0 = ca[i], a1 = ca[i + 1], a2 = ca[i + 2], a3 = ca[i + 3];
+        int b0 = cb[i], b1 = cb[i + 1], b2 = cb[i + 2], b3 = cb[i + 3];
+        F4 ax(qx[a0], qx[a1], qx[a2], qx[a3]), ay(qy[a0], qy[a1], qy[a2], qy[a3]), az(qz[a0], qz[a1], qz[a2], qz[a3]);
+        F4 bx(qx[b0], qx[b1], qx[b2], qx[b3]), by(qy[b0], qy[b1], qy[b2], qy[b3]), bz(qz[b0], qz[b1], qz[b2], qz[b3]);
+        F4 dx = bx - ax, dy = by - ay, dz = bz - az;
+        F4 len = max4(sqrt4(dx * dx + dy * dy + dz * dz), F4(1e-6f));
+        // equal masses: each end moves half of the correction
+        F4 s = F4::load(&sb.stiff[i]) * (len - F4::load(&sb.rest[i])) / len * F4(0.5f);
+        ax = ax + dx * s; ay = ay + dy * s; az = az + dz * s;
+        bx = bx - dx * s; by = by - dy * s; bz = bz - dz * s;
+        alignas(16) float t[4];
+        ax.store(t); qx[a0] = t[0]; qx[a1] = t[1]; qx[a2] = t[2]; qx[a3] = t[3];
+        ay.store(t); qy[a0] = t[0]; qy[a1] = t[1]; qy[a2] = t[2]; qy[a3] = t[3];
+        az.store(t); qz[a0] = t[0]; qz[a1] = t[1]; qz[a2] = t[2]; qz[a3] = t[3];
+        bx.store(t); qx[b0] = t[0]; qx[b1] = t[1]; qx[b2] = t[2]; qx[b3] = t[3];
+        by.store(t); qy[b0] = t[0]; qy[b1] = t[1]; qy[b2] = t[2]; qy[b3] = t[3];
+        bz.store(t); qz[b0] = t[0]; qz[b1] = t[1]; qz[b2] = t[2]; qz[b3] = t[3];
+    }
+    for (; i < end; ++i) {
+        int a = ca[i], b = cb[i];
+        float dx = qx[b] - qx[a], dy = qy[b] - qy[a], dz = qz[b] - qz[a];
+        float len = sqrtf(dx * dx + dy * dy + dz * dz);
+        if (len < 1e-6f) len = 1e-6f;
+        float s = sb.stiff[i] * (len - sb.rest[i]) / len * 0.5f;
+        qx[a] += dx * s; qy[a] += dy * s; qz[a] += dz * s;
+        qx[b] -= dx * s; qy[b] -= dy * s; qz[b] -= dz * s;
+    }
+}
+
+} // namespace
+
+SoftBody makeSoftBody(const float* verts, int stride, int rows, int cols, const SoftBodySettings& s) {
+    SoftBody sb;
+    sb.rows = rows; sb.cols = cols; sb.settings = s;
+    int n = rows * cols;
+    sb.px.resize(n); sb.py.resize(n); sb.pz.resize(n);
+    for (int i = 0; i < n; ++i) {
+        sb.px[i] = verts[i * stride + 0];
+        sb.py[i] = verts[i * stride + 1];
+        sb.pz[i] = verts[i * stride + 2];
+    }
+    sb.vx.assign(n, 0.0f); sb.vy.assign(n, 0.0f); sb.vz.assign(n, 0.0f);
+    sb.qx = sb.px; sb.qy = sb.py; sb.qz = sb.pz;
+
+    auto at = [cols](int r, int c) { return r * cols + (c + cols) % cols; };
+    float kStruct = iterationStiffness(s.structural, s.iterations);
+    float kShear = iterationStiffness(s.shear, s.iterations);
+    float kBend = iterationStiffness(s.bend, s.iterations);
+
+    // structural along rings and columns, shear across each quad, bend skipping one vertex
+    std::vector<Edge> edges;
+    edges.reserve((size_t)n * 6);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            if (cols > 1) edges.push_back({ at(r, c), at(r, c + 1), kStruct });
+            if (r + 1 < rows) {
+                edges.push_back({ at(r, c), at(r + 1, c), kStruct });
+                if (cols > 1) {
+                    edges.push_back({ at(r, c), at(r + 1, c + 1), kShear });
+                    edges.push_back({ at(r, c), at(r + 1, c - 1), kShear });
+                }
+            }
+            if (cols > 2) edges.push_back({ at(r, c), at(r, c + 2), kBend });
+            if (r + 2 < rows) edges.push_back({ at(r, c), at(r + 2, c), kBend });
+        }
+    }
+
+    // greedy colouring: each vertex remembers which colours already touch it
+    std::vector<uint64_t> used(n, 0);
+    std::vector<int> colour(edges.size());
+    int colours = 0;
+    for (size_t e = 0; e < edges.size(); ++e) {
+        uint64_t busy = used[edges[e].a] | used[edges[e].b];
+        int k = 0;
+        while (k < 63 && (busy >> k) & 1) ++k;
+        colour[e] = k;
+        used[edges[e].a] |= 1ull << k;
+        used[edges[e].b] |= 1ull << k;
+        if (k + 1 > colours) colours = k + 1;
+    }
+
+    // counting sort into batches; generation order inside a batch keeps particle access mostly linear
+    sb.batchStart.assign(colours + 1, 0);
+    for (int k : colour) ++sb.batchStart[k + 1];
+    for (int k = 0; k < colours; ++k) sb.batchStart[k + 1] += sb.batchStart[k];
+    std::vector<int> fill(sb.batchStart.begin(), sb.batchStart.end() - 1);
+    size_t m = edges.size();
+    sb.ca.resize(m); sb.cb.resize(m); sb.rest.resize(m); sb.stiff.resize(m);
+    for (size_t e = 0; e < m; ++e) {
+        int slot = fill[colour[e]]++;
+        int a = edges[e].a, b = edges[e].b;
+        float dx = sb.px[b] - sb.px[a], dy = sb.py[b] - sb.py[a], dz = sb.pz[b] - sb.pz[a];
+        sb.ca[slot] = a; sb.cb[slot] = b;
+        sb.rest[slot] = sqrtf(dx * dx + dy * dy + dz * dz);
+        sb.stiff[slot] = edges[e].k;
+    }
+    return sb;
+}
+
+void stepSoftBody(SoftBody& sb, const float* target, int stride, float dt, ThreadPool& pool) {
+    if (dt <= 0.0f) return;
+    int n = sb.rows * sb.cols;
+    float drive = dt * sb.settings.drive;
+    float keep = 1.0f - sb.settings.damping;
+
+    // predict: external wave force, damping, explicit position step
+    pool.parallelFor(n, kGrain, [&](int begin, int end) {
+        F4 fDrive(drive), fKeep(keep), fDt(dt);
+        int i = begin;
+        for (; i + 4 <= end; i += 4) {
+            const float* t = target + (size_t)i * stride;
+            F4 tx(t[0], t[stride], t[2 * stride], t[3 * stride]);
+            F4 ty(t[1], t[stride + 1], t[2 * stride + 1], t[3 * stride + 1]);
+            F4 tz(t[2], t[stride + 2], t[2 * stride + 2], t[3 * stride + 2]);
+            F4 x = F4::load(&sb.px[i]), y = F4::load(&sb.py[i]), z = F4::load(&sb.pz[i]);
+            F4 vx = (F4::load(&sb.vx[i]) + fDrive * (tx - x)) * fKeep;
+            F4 vy = (F4::load(&sb.vy[i]) + fDrive * (ty - y)) * fKeep;
+            F4 vz = (F4::load(&sb.vz[i]) + fDrive * (tz - z)) * fKeep;
+            vx.store(&sb.vx[i]); vy.store(&sb.vy[i]); vz.store(&sb.vz[i]);
+            (x + vx * fDt).store(&sb.qx[i]); (y + vy * fDt).store(&sb.qy[i]); (z + vz * fDt).store(&sb.qz[i]);
+        }
+        for (; i < end; ++i) {
+            const float* t = target + (size_t)i * stride;
+            sb.vx[i] = (sb.vx[i] + drive * (t[0] - sb.px[i])) * keep;
+            sb.vy[i] = (sb.vy[i] + drive * (t[1] - sb.py[i])) * keep;
+            sb.vz[i] = (sb.vz[i] + drive * (t[2] - sb.pz[i])) * keep;
+            sb.qx[i] = sb.px[i] + sb.vx[i] * dt; sb.qy[i] = sb.py[i] + sb.vy[i] * dt; sb.qz[i] = sb.pz[i] + sb.vz[i] * dt;
+        }
+    });
+
+    // project constraints colour by colour; each colour is one parallel sweep
+    int colours = (int)sb.batchStart.size() - 1;
+    for (int it = 0; it < sb.settings.iterations; ++it) {
+        for (int k = 0; k < colours; ++k) {
+            int first = sb.batchStart[k];
+            pool.parallelFor(sb.batchStart[k + 1] - first, kGrain, [&](int begin, int end) {
+                solveRange(sb, first + begin, first + end);
+            });
+        }
+    }
+
+    // velocities from the corrected positions
+    float invDt = 1.0f / dt;
+    pool.parallelFor(n, kGrain, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            sb.vx[i] = (sb.qx[i] - sb.px[i]) * invDt;
+            sb.vy[i] = (sb.qy[i] - sb.py[i]) * invDt;
+            sb.vz[i] = (sb.qz[i] - sb.pz[i]) * invDt;
+            sb.px[i] = sb.qx[i]; sb.py[i] = sb.qy[i]; sb.pz[i] = sb.qz[i];
+        }
+    });
+}
+
+void writeSoftBodyVertices(const SoftBody& sb, float* verts, int stride, ThreadPool& pool) {
+    int rows = sb.rows, cols = sb.cols;
+    pool.parallelFor(rows, 8, [&](int r0, int r1) {
+        for (int r = r0; r < r1; ++r) {
+            int rUp = r + 1 < rows ? r + 1 : r, rDn = r > 0 ? r - 1 : r;
+            for (int c = 0; c < cols; ++c) {
+                int i = r * cols + c;
+                int cl = r * cols + (c + cols - 1) % cols, cr = r * cols + (c + 1) % cols;
+                int up = rUp * cols + c, dn = rDn * cols + c;
+                // same orientation as makeSculpture(): cross(d/du, d/dv)
+                float ux = sb.px[cr] - sb.px[cl], uy = sb.py[cr] - sb.py[cl], uz = sb.pz[cr] - sb.pz[cl];
+                float vx = sb.px[up] - sb.px[dn], vy = sb.py[up] - sb.py[dn], vz = sb.pz[up] - sb.pz[dn];
+                float nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+                float len = sqrtf(nx * nx + ny * ny + nz * nz);
+                float inv = len > 1e-12f ? 1.0f / len : 0.0f;
+                float* o = verts + (size_t)i * stride;
+                o[0] = sb.px[i]; o[1] = sb.py[i]; o[2] = sb.pz[i];
+                o[3] = nx * inv; o[4] = ny * inv; o[5] = nz * inv;
+            }
+        }
+    });
+}
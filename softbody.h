@@ -0,0 +1,36 @@
+#pragma once
+// === optional soft-body mode: the sculpture grid as a position-based-dynamics lattice ===
+// The analytic wave from makeSculpture() becomes an external force: every particle is pulled toward
+// where the wave wants it, while structural/shear/bend constraints along rings and columns keep the skin
+// together. Constraints are graph-coloured into independent batches so each batch can be solved by all
+// threads at once without atomics. GL-free; main() streams the result into the sculpture VBO.
+#include <vector>
+
+struct ThreadPool;
+
+struct SoftBodySettings {
+    int iterations = 4;
+    float structural = 0.9f, shear = 0.5f, bend = 0.15f; // PBD stiffness in [0,1], per step
+    float drive = 40.0f;                                  // pull toward the wave surface (1/s^2)
+    float damping = 0.04f;                                // velocity loss per step
+};
+
+struct SoftBody {
+    int rows = 0, cols = 0;
+    SoftBodySettings settings;
+    std::vector<float> px, py, pz; // positions (SoA)
+    std::vector<float> vx, vy, vz; // velocities
+    std::vector<float> qx, qy, qz; // predicted positions while solving
+    // constraints sorted by colour; colour k is [batchStart[k], batchStart[k+1])
+    std::vector<int> ca, cb;
+    std::vector<float> rest, stiff;
+    std::vector<int> batchStart;
+};
+
+// verts: interleaved vertex array (position at offset 0), `stride` floats per vertex, rows*cols vertices
+// laid out like makeSculpture() (ring-major, columns wrap around). Rest lengths come from this shape.
+SoftBody makeSoftBody(const float* verts, int stride, int rows, int cols, const SoftBodySettings& s = SoftBodySettings());
+// target: the analytic surface for this frame in the same layout
+void stepSoftBody(SoftBody& sb, const float* target, int stride, float dt, ThreadPool& pool);
+// writes position (offset 0) and a lattice normal (offset 3), leaves the rest of each vertex alone
+void writeSoftBodyVertices(const SoftBody& sb, float* verts, int stride, ThreadPool& pool);
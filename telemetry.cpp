@@ -0,0 +1,226 @@
+#include "telemetry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::atomic<uint64_t> g_heapAllocations{ 0 };
+
+const double kBucketMs[kTelemetryBuckets] = { 4.0, 8.0, 16.7, 20.0, 33.3, 50.0, 100.0, 250.0 };
+
+void metric(std::ostream& o, const char* name, const char* type, const char* help, double value) {
+    o << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n' << name << ' ' << value << '\n';
+}
+
+bool writeMetrics(const Telemetry& t) {
+    std::ostringstream o;
+    o.precision(15); // counters stay exact well past 1e9
+    metric(o, "kinetic_frames_total", "counter", "Frames rendered.", (double)t.frames.load(std::memory_order_relaxed));
+    o << "# HELP kinetic_frame_seconds Frame time, frame start to next frame start.\n# TYPE kinetic_frame_seconds histogram\n";
+    uint64_t cumulative = 0;
+    for (int b = 0; b <= kTelemetryBuckets; ++b) {
+        cumulative += t.frameBuckets[b].load(std::memory_order_relaxed);
+        if (b < kTelemetryBuckets) o << "kinetic_frame_seconds_bucket{le=\"" << kBucketMs[b] * 1e-3 << "\"} " << cumulative << '\n';
+        else o << "kinetic_frame_seconds_bucket{le=\"+Inf\"} " << cumulative << '\n';
+    }
+    o << "kinetic_frame_seconds_sum " << t.frameUsSum.load(std::memory_order_relaxed) * 1e-6 << '\n'
+      << "kinetic_frame_seconds_count " << cumulative << '\n';
+    metric(o, "kinetic_cpu_frame_seconds", "gauge", "CPU time of the latest frame, before swap.",
+           t.lastCpuUs.load(std::memory_order_relaxed) * 1e-6);
+    metric(o, "kinetic_gpu_frame_seconds", "gauge", "GPU time of the latest finished frame.",
+           t.lastGpuUs.load(std::memory_order_relaxed) * 1e-6);
+    metric(o, "kinetic_triangles", "gauge", "Triangles drawn in the latest frame.", (double)t.lastTriangles.load(std::memory_order_relaxed));
+    metric(o, "kinetic_triangles_total", "counter", "Triangles drawn.", (double)t.triangles.load(std::memory_order_relaxed));
+    metric(o, "kinetic_lights_evaluated", "gauge", "Point lights the sculpture shader evaluated in the latest frame.",
+           (double)t.lastLights.load(std::memory_order_relaxed));
+    metric(o, "kinetic_gpu_tracked_bytes", "gauge", "GPU buffers, textures and programs the renderer holds (requested sizes).",
+           (double)t.lastGpuBytes.load(std::memory_order_relaxed));
+    metric(o, "kinetic_cpu_tracked_bytes", "gauge", "Large CPU arrays the renderer holds.",
+           (double)t.lastCpuBytes.load(std::memory_order_relaxed));
+    metric(o, "kinetic_upload_bytes_total", "counter", "Bytes uploaded to buffers and textures.",
+           (double)t.uploadBytes.load(std::memory_order_relaxed));
+    metric(o, "kinetic_allocations_total", "counter", "operator new calls made during frames.",
+           (double)t.allocations.load(std::memory_order_relaxed));
+    if (t.ring)
+        metric(o, "kinetic_telemetry_dropped_total", "counter", "Frame records dropped because the shared-memory ring was full.",
+               (double)t.ring->dropped.load(std::memory_order_relaxed));
+
+    // the collector must never see half a file
+    std::string tmp = t.metricsPath + ".tmp";
+    {
+        std::ofstream f(tmp);
+        if (!(f << o.str())) return false;
+    }
+    return std::rename(tmp.c_str(), t.metricsPath.c_str()) == 0;
+}
+
+void exporterLoop(Telemetry* t) {
+    auto next = std::chrono::steady_clock::now();
+    auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(t->metricsIntervalS));
+    bool warned = false;
+    while (!t->stop.load(std::memory_order_acquire)) {
+        next += interval;
+        // short naps so stopTelemetry() doesn't wait out a whole interval
+        while (!t->stop.load(std::memory_order_acquire) && std::chrono::steady_clock::now() < next)
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (!writeMetrics(*t) && !warned) {
+            std::cerr << "can't write metrics file " << t->metricsPath << "\n";
+            warned = true;
+        }
+    }
+}
+
+} // namespace
+
+// counted replacement; the array and nothrow forms forward here
+void* operator new(std::size_t n) {
+    g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+uint64_t heapAllocations() { return g_heapAllocations.load(std::memory_order_relaxed); }
+
+bool startTelemetry(Telemetry& t, const TelemetrySettings& s) {
+    bool ok = true;
+    if (!s.shmName.empty()) {
+#ifdef __linux__
+        uint32_t capacity = s.capacity > 0 ? s.capacity : 1;
+        size_t bytes = sizeof(TelemetryRingHeader) + (size_t)capacity * sizeof(TelemetryRecord);
+        int fd = shm_open(s.shmName.c_str(), O_CREAT | O_RDWR, 0600);
+        void* p = MAP_FAILED;
+        if (fd >= 0 && ftruncate(fd, (off_t)bytes) == 0)
+            p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (fd >= 0) close(fd);
+        if (p != MAP_FAILED) {
+            // zeroed every run; the magic goes in last so a reader never sees a half-built header
+            memset(p, 0, bytes);
+            t.ring = new (p) TelemetryRingHeader();
+            t.ring->recordSize = sizeof(TelemetryRecord);
+            t.ring->capacity = capacity;
+            t.ring->version = kTelemetryVersion;
+            t.slots = (TelemetryRecord*)((char*)p + sizeof(TelemetryRingHeader));
+            t.mapBytes = bytes;
+            t.shmName = s.shmName;
+            t.ring->magic.store(kTelemetryMagic, std::memory_order_release);
+        } else {
+            std::cerr << "can't create telemetry ring " << s.shmName << "\n";
+            ok = false;
+        }
+#else
+        std::cerr << "telemetry ring needs POSIX shared memory\n";
+        ok = false;
+#endif
+    }
+    if (!s.metricsPath.empty()) {
+        t.metricsPath = s.metricsPath;
+        t.metricsIntervalS = s.metricsIntervalS > 0.05 ? s.metricsIntervalS : 0.05;
+        t.stop.store(false);
+        t.exporter = std::thread(exporterLoop, &t);
+    }
+    return ok;
+}
+
+void publishTelemetry(Telemetry& t, const TelemetryRecord& r) {
+    const auto relaxed = std::memory_order_relaxed;
+    t.frames.fetch_add(1, relaxed);
+    t.triangles.fetch_add(r.triangles, relaxed);
+    t.uploadBytes.fetch_add(r.uploadBytes, relaxed);
+    t.allocations.fetch_add(r.allocations, relaxed);
+    t.lastTriangles.store(r.triangles, relaxed);
+    t.lastLights.store(r.lights, relaxed);
+    t.lastGpuBytes.store(r.gpuBytes, relaxed);
+    t.lastCpuBytes.store(r.cpuBytes, relaxed);
+    t.lastCpuUs.store((uint32_t)(r.cpuMs * 1e3f), relaxed);
+    t.lastGpuUs.store((uint32_t)(r.gpuMs * 1e3f), relaxed);
+    if (r.frameMs > 0.0f) {
+        int b = 0;
+        while (b < kTelemetryBuckets && r.frameMs > kBucketMs[b]) ++b;
+        t.frameBuckets[b].fetch_add(1, relaxed);
+        t.frameUsSum.fetch_add((uint64_t)(r.frameMs * 1e3f), relaxed);
+    }
+
+    if (!t.ring) return;
+    uint64_t head = t.ring->head.load(relaxed);
+    if (head - t.ring->tail.load(std::memory_order_acquire) >= t.ring->capacity) {
+        t.ring->dropped.fetch_add(1, relaxed);
+        return;
+    }
+    t.slots[head % t.ring->capacity] = r;
+    t.ring->head.store(head + 1, std::memory_order_release);
+}
+
+void stopTelemetry(Telemetry& t) {
+    if (t.exporter.joinable()) {
+        t.stop.store(true, std::memory_order_release);
+        t.exporter.join();
+    }
+#ifdef __linux__
+    if (t.ring) {
+        munmap(t.ring, t.mapBytes);
+        shm_unlink(t.shmName.c_str());
+    }
+#endif
+    t.ring = nullptr; t.slots = nullptr;
+}
+
+bool openTelemetryReader(TelemetryReader& r, const std::string& shmName) {
+#ifdef __linux__
+    int fd = shm_open(shmName.c_str(), O_RDWR, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    void* p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(TelemetryRingHeader))
+        p = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    TelemetryRingHeader* h = (TelemetryRingHeader*)p;
+    // acquire pairs with the renderer's release: version, capacity and the zeroed ring are visible past it
+    if (h->magic.load(std::memory_order_acquire) != kTelemetryMagic || h->version != kTelemetryVersion ||
+        h->recordSize != sizeof(TelemetryRecord) ||
+        sizeof(TelemetryRingHeader) + (size_t)h->capacity * sizeof(TelemetryRecord) > (size_t)st.st_size) {
+        munmap(p, (size_t)st.st_size);
+        return false;
+    }
+    r.ring = h;
+    r.slots = (const TelemetryRecord*)((char*)p + sizeof(TelemetryRingHeader));
+    r.mapBytes = (size_t)st.st_size;
+    return true;
+#else
+    (void)r; (void)shmName;
+    return false;
+#endif
+}
+
+size_t readTelemetry(TelemetryReader& r, TelemetryRecord* out, size_t max) {
+    if (!r.ring) return 0;
+    uint64_t tail = r.ring->tail.load(std::memory_order_relaxed);
+    uint64_t head = r.ring->head.load(std::memory_order_acquire);
+    size_t n = 0;
+    for (; tail + n < head && n < max; ++n) out[n] = r.slots[(tail + n) % r.ring->capacity];
+    r.ring->tail.store(tail + n, std::memory_order_release);
+    return n;
+}
+
+void closeTelemetryReader(TelemetryReader& r) {
+#ifdef __linux__
+    if (r.ring) munmap(r.ring, r.mapBytes);
+#endif
+    r.ring = nullptr; r.slots = nullptr;
+}
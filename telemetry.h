@@ -0,0 +1,91 @@
+#pragma once
+// === production telemetry: per-frame records to a shared-memory ring, Prometheus textfile snapshots ===
+// The render thread only calls publishTelemetry(): relaxed atomics plus one record copied into a
+// single-producer/single-consumer ring in POSIX shared memory. No locks, no syscalls, no I/O.
+// A full ring drops the new record and counts it, the renderer never waits for the reader.
+// The metrics file is written by a background thread (tmp file + rename, for node_exporter's textfile
+// collector), from counters the render thread bumps.
+//
+// Sidecar side: openTelemetryReader() + readTelemetry() on the same shm name (bench/telemetry_tail.cpp).
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+struct TelemetryRecord {
+    uint64_t frame = 0;
+    double timeS = 0.0;             // process time at the end of the frame
+    float frameMs = 0.0f;           // previous frame start to this frame start
+    float cpuMs = 0.0f;             // frame start to before swap
+    float gpuMs = 0.0f;             // latest finished GPU frame, a few frames behind
+    uint32_t lights = 0;            // lights the sculpture shader evaluated
+    uint64_t triangles = 0;
+    uint64_t uploadBytes = 0;       // buffer and texture uploads this frame
+    uint64_t allocations = 0;       // operator new calls this frame, all threads
+    uint64_t gpuBytes = 0;          // tracked GPU memory (memory_registry.h) at the end of the frame
+    uint64_t cpuBytes = 0;          // tracked CPU arrays
+};
+
+const uint32_t kTelemetryMagic = 0x4b54454cu; // "KTEL"
+const uint32_t kTelemetryVersion = 2;
+
+// start of the shared-memory object; `capacity` records follow at offset sizeof(TelemetryRingHeader)
+struct TelemetryRingHeader {
+    std::atomic<uint32_t> magic;                // stored last with release; a reader acquires it before the rest
+    uint32_t version, recordSize, capacity;
+    alignas(64) std::atomic<uint64_t> head;     // records written, only the renderer stores
+    alignas(64) std::atomic<uint64_t> tail;     // records consumed, only the reader stores
+    alignas(64) std::atomic<uint64_t> dropped;  // records the renderer threw away because the ring was full
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "the ring is shared across processes");
+
+struct TelemetrySettings {
+    std::string shmName;            // e.g. "/kinetic-telemetry"; empty = no ring
+    uint32_t capacity = 1024;       // records; about 17 s at 60 fps
+    std::string metricsPath;        // Prometheus textfile; empty = none
+    double metricsIntervalS = 5.0;
+};
+
+// frame time histogram buckets for the metrics file, upper bounds in milliseconds
+const int kTelemetryBuckets = 8;
+
+struct Telemetry {
+    TelemetryRingHeader* ring = nullptr;
+    TelemetryRecord* slots = nullptr;
+    size_t mapBytes = 0;
+    std::string shmName;
+
+    // totals for the exporter thread; written by the render thread only
+    std::atomic<uint64_t> frames{ 0 }, triangles{ 0 }, uploadBytes{ 0 }, allocations{ 0 };
+    std::atomic<uint64_t> frameUsSum{ 0 }, frameBuckets[kTelemetryBuckets + 1] = {};
+    std::atomic<uint64_t> lastTriangles{ 0 }, lastLights{ 0 }, lastGpuBytes{ 0 }, lastCpuBytes{ 0 };
+    std::atomic<uint32_t> lastGpuUs{ 0 }, lastCpuUs{ 0 };
+
+    std::string metricsPath;
+    double metricsIntervalS = 5.0;
+    std::thread exporter;
+    std::atomic<bool> stop{ false };
+};
+
+// operator new calls since process start, every thread (counted by telemetry.cpp's replacement)
+uint64_t heapAllocations();
+
+// creates the shm ring and/or starts the metrics thread; false if a requested part couldn't be set up
+bool startTelemetry(Telemetry& t, const TelemetrySettings& s);
+// render thread, once per frame
+void publishTelemetry(Telemetry& t, const TelemetryRecord& r);
+// joins the exporter (one last snapshot), unmaps and unlinks the ring
+void stopTelemetry(Telemetry& t);
+
+// === reader side ===
+struct TelemetryReader {
+    TelemetryRingHeader* ring = nullptr;
+    const TelemetryRecord* slots = nullptr;
+    size_t mapBytes = 0;
+};
+bool openTelemetryReader(TelemetryReader& r, const std::string& shmName);
+// copies up to `max` unread records in order, returns how many
+size_t readTelemetry(TelemetryReader& r, TelemetryRecord* out, size_t max);
+void closeTelemetryReader(TelemetryReader& r);
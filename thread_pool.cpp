@@ -0,0 +1,58 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+    for (int i = 1; i < threads; ++i) workers.emplace_back([this] { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+    { std::lock_guard<std::mutex> lk(mtx); quit = true; }
+    wake.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+void ThreadPool::runChunks() {
+    for (;;) {
+        int begin = nextChunk.fetch_add(jobGrain);
+        if (begin >= jobCount) break;
+        int end = begin + jobGrain < jobCount ? begin + jobGrain : jobCount;
+        (*job)(begin, end);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    unsigned seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(mtx);
+            wake.wait(lk, [&] { return quit || generation != seen; });
+            if (quit) return;
+            seen = generation;
+        }
+        runChunks();
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            if (--busy == 0) done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(int count, int grain, const std::function<void(int, int)>& fn) {
+    if (count <= 0) return;
+    if (grain < 1) grain = 1;
+    // not worth waking anyone for a single chunk
+    if (workers.empty() || count <= grain) { fn(0, count); return; }
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        job = &fn; jobCount = count; jobGrain = grain;
+        nextChunk.store(0);
+        busy = (int)workers.size();
+        ++generation;
+    }
+    wake.notify_all();
+    runChunks();
+    std::unique_lock<std::mutex> lk(mtx);
+    done.wait(lk, [&] { return busy == 0; });
+    job = nullptr;
+}
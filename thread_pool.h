@@ -0,0 +1,34 @@
+#pragma once
+// === minimal fork/join pool: the calling thread joins in, no per-call allocation ===
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ThreadPool {
+    // threads <= 0 -> hardware_concurrency
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // runs fn(begin, end) over [0, count) in chunks of `grain`, returns when all chunks are done
+    void parallelFor(int count, int grain, const std::function<void(int, int)>& fn);
+    int size() const { return (int)workers.size() + 1; }
+
+private:
+    void workerLoop();
+    void runChunks();
+
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable wake, done;
+    const std::function<void(int, int)>* job = nullptr;
+    int jobCount = 0, jobGrain = 1;
+    std::atomic<int> nextChunk{ 0 };
+    int busy = 0;
+    unsigned generation = 0;
+    bool quit = false;
+};
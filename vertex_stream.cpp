@@ -0,0 +1,189 @@
+#include "vertex_stream.h"
+#include "frame_stats.h"
+#include "memory_registry.h"
+#include "probes.h"
+
+#include <cstring>
+#include <string>
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace {
+
+typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+BufferStorageProc g_bufferStorage = nullptr;
+
+const char* kNames[kUploadPathCount] = { "orphan", "subdata", "map-invalidate", "map-ring", "persistent" };
+const char* kProbeKinds[kUploadPathCount] = { "vertex-stream:orphan", "vertex-stream:subdata", "vertex-stream:map-invalidate",
+                                              "vertex-stream:map-ring", "vertex-stream:persistent" };
+
+// waits until the GPU is done with the region about to be overwritten
+void waitRegion(VertexStream& s) {
+    GLsync& f = s.fences[s.next];
+    if (!f) return;
+    while (glClientWaitSync(f, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull) == GL_TIMEOUT_EXPIRED) {}
+    glDeleteSync(f);
+    f = nullptr;
+}
+
+} // namespace
+
+const char* uploadPathName(UploadPath p) { return kNames[(int)p]; }
+
+bool parseUploadPath(const char* name, UploadPath& out) {
+    for (int i = 0; i < kUploadPathCount; ++i)
+        if (!strcmp(name, kNames[i])) { out = (UploadPath)i; return true; }
+    return false;
+}
+
+void initVertexStreams(GLADloadproc load) {
+    GLint major = 0, minor = 0, count = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool has = major > 4 || (major == 4 && minor >= 4);
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int i = 0; i < count && !has; ++i)
+        has = !strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_buffer_storage");
+    g_bufferStorage = has ? (BufferStorageProc)load("glBufferStorage") : nullptr;
+}
+
+bool uploadPathAvailable(UploadPath p) {
+    return p != UploadPath::Persistent || g_bufferStorage;
+}
+
+VertexStream makeVertexStream(UploadPath path, size_t bytes) {
+    VertexStream s;
+    s.path = uploadPathAvailable(path) ? path : UploadPath::SubData;
+    s.bytes = bytes;
+    bool ring = s.path == UploadPath::MapRing || s.path == UploadPath::Persistent;
+    s.regions = ring ? kRingRegions : 1;
+    glGenBuffers(1, &s.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, s.vbo);
+    GLsizeiptr total = (GLsizeiptr)(bytes * s.regions);
+    if (s.path == UploadPath::Persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        g_bufferStorage(GL_ARRAY_BUFFER, total, nullptr, flags);
+        s.mapped = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, total, flags);
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, total, nullptr, s.path == UploadPath::SubData ? GL_DYNAMIC_DRAW : GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    trackGpu(GpuObject::Buffer, s.vbo, MemTag::VertexStream, (size_t)total);
+    return s;
+}
+
+size_t uploadVertexStream(VertexStream& s, const void* data) {
+    size_t offset = (size_t)s.next * s.bytes;
+    double t0 = PROBE_ENABLED(buffer_upload) ? processMs() : 0.0;
+    glBindBuffer(GL_ARRAY_BUFFER, s.vbo);
+    switch (s.path) {
+    case UploadPath::Orphan:
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)s.bytes, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)s.bytes, data);
+        break;
+    case UploadPath::SubData:
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)s.bytes, data);
+        break;
+    case UploadPath::MapInvalidate:
+        if (void* p = glMapBufferRange(GL_ARRAY_BUFFER, 0, (GLsizeiptr)s.bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT)) {
+            memcpy(p, data, s.bytes);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        break;
+    case UploadPath::MapRing:
+        waitRegion(s);
+        if (void* p = glMapBufferRange(GL_ARRAY_BUFFER, (GLintptr)offset, (GLsizeiptr)s.bytes,
+                                       GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT)) {
+            memcpy(p, data, s.bytes);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        break;
+    case UploadPath::Persistent:
+        waitRegion(s);
+        if (s.mapped) memcpy(s.mapped + offset, data, s.bytes);
+        break;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (PROBE_ENABLED(buffer_upload))
+        PROBE3(buffer_upload, kProbeKinds[(int)s.path], (long long)s.bytes, (long long)((processMs() - t0) * 1e3));
+    return offset;
+}
+
+void fenceVertexStream(VertexStream& s) {
+    if (s.regions == 1) return;
+    if (s.fences[s.next]) glDeleteSync(s.fences[s.next]);
+    s.fences[s.next] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    s.next = (s.next + 1) % s.regions;
+}
+
+void destroyVertexStream(VertexStream& s) {
+    for (GLsync& f : s.fences) if (f) { glDeleteSync(f); f = nullptr; }
+    if (s.mapped) {
+        glBindBuffer(GL_ARRAY_BUFFER, s.vbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        s.mapped = nullptr;
+    }
+    untrackGpu(GpuObject::Buffer, s.vbo);
+    if (s.vbo) glDeleteBuffers(1, &s.vbo);
+    s.vbo = 0;
+}
+
+std::vector<UploadTiming> measureUploadPaths(size_t bytes, int frames) {
+    std::vector<UploadTiming> out;
+    std::vector<unsigned char> src(bytes);
+    for (size_t i = 0; i < bytes; ++i) src[i] = (unsigned char)(i * 131u);
+    GLuint sink;
+    glGenBuffers(1, &sink);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, sink);
+    glBufferData(GL_COPY_WRITE_BUFFER, 64, nullptr, GL_STREAM_COPY);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    for (int p = 0; p < kUploadPathCount; ++p) {
+        if (!uploadPathAvailable((UploadPath)p)) continue;
+        VertexStream s = makeVertexStream((UploadPath)p, bytes);
+        std::vector<double> callMs;
+        glFinish();
+        double t0 = processMs();
+        for (int f = 0; f < frames; ++f) {
+            double c0 = processMs();
+            size_t at = uploadVertexStream(s, src.data());
+            callMs.push_back(processMs() - c0);
+            // stands in for the draw: the GPU has to read what was just written
+            glBindBuffer(GL_COPY_READ_BUFFER, s.vbo);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, sink);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)(at + bytes - 64), 0, 64);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            fenceVertexStream(s);
+        }
+        glFinish();
+        double ms = processMs() - t0;
+        UploadTiming t;
+        t.path = s.path;
+        t.mbPerS = ms > 0.0 ? (double)bytes * frames / (1024.0 * 1024.0) / (ms * 1e-3) : 0.0;
+        SampleSummary sum = summarize(callMs);
+        t.p50Ms = sum.p50; t.p99Ms = sum.p99;
+        out.push_back(t);
+        destroyVertexStream(s);
+    }
+    glDeleteBuffers(1, &sink);
+    return out;
+}
+
+UploadPath probeUploadPath(size_t bytes, std::vector<UploadTiming>* timings) {
+    // whole-pipeline throughput, not the call time: a cheap call that defers the stall to the draw
+    // (orphaning on some drivers) must not win
+    std::vector<UploadTiming> t = measureUploadPaths(bytes, 12);
+    UploadPath best = UploadPath::SubData;
+    double bestRate = 0.0;
+    for (const UploadTiming& u : t)
+        if (u.mbPerS > bestRate) { bestRate = u.mbPerS; best = u.path; }
+    if (timings) *timings = t;
+    return best;
+}
@@ -0,0 +1,54 @@
+#pragma once
+// === per-frame vertex uploads behind one interface ===
+// Which way of streaming a buffer is fast differs wildly between drivers, so every path GL offers is
+// here and the renderer probes them at startup for its real stream size (probeUploadPath) and keeps
+// the fastest. Ring paths write to a different region each frame: draw with the returned offset
+// (glDrawElementsBaseVertex) and fence once the frame's draws are issued.
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+enum class UploadPath {
+    Orphan,         // glBufferData(nullptr) then glBufferSubData: the driver hands out fresh storage
+    SubData,        // glBufferSubData into the same storage; may stall behind the previous frame
+    MapInvalidate,  // glMapBufferRange with INVALIDATE_BUFFER, memcpy, unmap
+    MapRing,        // three regions, UNSYNCHRONIZED map of the one the fence says is free
+    Persistent      // ARB_buffer_storage: three regions mapped once, coherent, fenced
+};
+const int kUploadPathCount = 5;
+const int kRingRegions = 3;
+
+const char* uploadPathName(UploadPath p);
+bool parseUploadPath(const char* name, UploadPath& out);
+
+// fetches glBufferStorage if the context has it; call once after GL is loaded
+void initVertexStreams(GLADloadproc load);
+bool uploadPathAvailable(UploadPath p);
+
+struct VertexStream {
+    UploadPath path = UploadPath::SubData;
+    GLuint vbo = 0;
+    size_t bytes = 0;               // one frame
+    int regions = 1, next = 0;      // ring paths: region the next upload goes to
+    GLsync fences[kRingRegions] = {};
+    unsigned char* mapped = nullptr;// persistent: the whole ring
+};
+// unavailable paths fall back to SubData; the stream's path says what you got
+VertexStream makeVertexStream(UploadPath path, size_t bytes);
+// copies one frame in and returns the byte offset it landed at (0 unless ringed)
+size_t uploadVertexStream(VertexStream& s, const void* data);
+// after the draws reading the latest upload have been issued
+void fenceVertexStream(VertexStream& s);
+void destroyVertexStream(VertexStream& s);
+
+struct UploadTiming {
+    UploadPath path;
+    double mbPerS = 0.0;            // frames * bytes over wall time, glFinish at the end included
+    double p50Ms = 0.0, p99Ms = 0.0;// CPU time of the upload call itself
+};
+// `frames` uploads per available path, each followed by a small GPU copy out of the buffer so the
+// driver can't skip the synchronisation a real draw would need
+std::vector<UploadTiming> measureUploadPaths(size_t bytes, int frames);
+// short run of measureUploadPaths; highest throughput wins
+UploadPath probeUploadPath(size_t bytes, std::vector<UploadTiming>* timings = nullptr);
@@ -0,0 +1,32 @@
+#version 330 core
+// one substep of the damped wave equation; must match stepRow()/applyEmitters() in wavefield.cpp
+uniform sampler2D uCur, uPrev;
+uniform vec2 uCourant2;      // (Cu^2, Cv^2)
+uniform float uGamma;        // damping * dt
+uniform int uEmitterCount;
+uniform vec4 uEmitters[8];   // u, v, dt^2 * amplitude * sin(wt), sigma
+
+out float FragField;
+
+void main(){
+    ivec2 size = textureSize(uCur, 0);
+    ivec2 p = ivec2(gl_FragCoord.xy);
+    // periodic in u (x), mirrored at the top/bottom rings (y)
+    float l = texelFetch(uCur, ivec2((p.x + size.x - 1) % size.x, p.y), 0).r;
+    float r = texelFetch(uCur, ivec2((p.x + 1) % size.x, p.y), 0).r;
+    float d = texelFetch(uCur, ivec2(p.x, max(p.y - 1, 0)), 0).r;
+    float u = texelFetch(uCur, ivec2(p.x, min(p.y + 1, size.y - 1)), 0).r;
+    float m = texelFetch(uCur, p, 0).r;
+    float lap = uCourant2.x * (l + r - 2.0 * m) + uCourant2.y * (u + d - 2.0 * m);
+    float next = (2.0 - uGamma) * m - (1.0 - uGamma) * texelFetch(uPrev, p, 0).r + lap;
+
+    vec2 uv = vec2(float(p.x) / float(size.x), float(p.y) / float(max(size.y - 1, 1)));
+    for (int i = 0; i < uEmitterCount; i++) {
+        vec4 e = uEmitters[i];
+        vec2 dp = uv - e.xy;
+        dp.x -= floor(dp.x + 0.5);
+        if (abs(dp.x) <= 3.0 * e.w && abs(dp.y) <= 3.0 * e.w)
+            next += e.z * exp(-dot(dp, dp) / (2.0 * e.w * e.w));
+    }
+    FragField = next;
+}
@@ -0,0 +1,120 @@
+#include "wavefield.h"
+#include "simd4.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const float kTwoPi = 6.28318530717958647692f;
+const float kMaxCourant = 0.7f; // < 1/sqrt(2) keeps the 5-point stencil stable
+
+// one row of the update; the two wrap-around columns are done scalar, the rest 4-wide
+void stepRow(const float* prev, const float* cur, const float* up, const float* dn, float* next,
+             int cols, float cu2, float cv2, float gamma) {
+    float a = 2.0f - gamma, b = 1.0f - gamma;
+    auto scalar = [&](int c, int l, int r) {
+        float m = cur[c];
+        float lap = cu2 * (cur[l] + cur[r] - 2.0f * m) + cv2 * (up[c] + dn[c] - 2.0f * m);
+        next[c] = a * m - b * prev[c] + lap;
+    };
+    if (cols < 3) {
+        for (int c = 0; c < cols; ++c) scalar(c, (c + cols - 1) % cols, (c + 1) % cols);
+        return;
+    }
+    scalar(0, cols - 1, 1);
+    F4 fa(a), fb(b), fcu(cu2), fcv(cv2), two(2.0f);
+    int c = 1;
+    for (; c + 4 <= cols - 1; c += 4) {
+        F4 m = F4::load(cur + c);
+        F4 lap = fcu * (F4::load(cur + c - 1) + F4::load(cur + c + 1) - two * m)
+               + fcv * (F4::load(up + c) + F4::load(dn + c) - two * m);
+        (fa * m - fb * F4::load(prev + c) + lap).store(next + c);
+    }
+    for (; c < cols - 1; ++c) scalar(c, c - 1, c + 1);
+    scalar(cols - 1, cols - 2, 0);
+}
+
+// adds each emitter's gaussian source into f.next
+void applyEmitters(WaveField& f, float dtSub, double time) {
+    for (const WaveEmitter& e : f.settings.emitters) {
+        // cycles reduced in double before the phase becomes a float
+        float s = dtSub * dtSub * e.amplitude * sinf(kTwoPi * (float)fmod(e.frequency * time, 1.0));
+        float inv2s2 = 1.0f / (2.0f * e.sigma * e.sigma);
+        float vScale = f.rows > 1 ? (float)(f.rows - 1) : 1.0f;
+        // 3 sigma covers everything visible
+        int reachU = (int)ceilf(3.0f * e.sigma * f.cols), reachV = (int)ceilf(3.0f * e.sigma * vScale);
+        int cu = (int)lroundf(e.u * f.cols), cv = (int)lroundf(e.v * vScale);
+        reachU = std::min(reachU, f.cols / 2);
+        for (int r = std::max(0, cv - reachV); r <= std::min(f.rows - 1, cv + reachV); ++r) {
+            float dv = r / vScale - e.v;
+            for (int k = -reachU; k <= reachU; ++k) {
+                int c = ((cu + k) % f.cols + f.cols) % f.cols;
+                // periodic distance in u
+                float du = (float)c / f.cols - e.u;
+                du -= floorf(du + 0.5f);
+                f.next[(size_t)r * f.cols + c] += s * expf(-(du * du + dv * dv) * inv2s2);
+            }
+        }
+    }
+}
+
+} // namespace
+
+WaveFieldSettings defaultWaveSettings() {
+    WaveFieldSettings s;
+    s.emitters.push_back({ 0.00f, 0.25f, 2.0f, 0.45f, 0.05f });
+    s.emitters.push_back({ 0.33f, 0.55f, 1.6f, 0.60f, 0.04f });
+    s.emitters.push_back({ 0.66f, 0.80f, 1.8f, 0.35f, 0.06f });
+    return s;
+}
+
+WaveField makeWaveField(int rows, int cols, const WaveFieldSettings& s) {
+    WaveField f;
+    f.rows = rows; f.cols = cols; f.settings = s;
+    size_t n = (size_t)rows * cols;
+    f.prev.assign(n, 0.0f); f.cur.assign(n, 0.0f); f.next.assign(n, 0.0f);
+    return f;
+}
+
+void waveCoefficients(int rows, int cols, float speed, float damping, float dtSub,
+                      float& courantU2, float& courantV2, float& gamma) {
+    // parametric spacing: u spans cols cells, v spans rows-1 cells
+    float cu = speed * dtSub * cols, cv = speed * dtSub * (rows > 1 ? rows - 1 : 1);
+    courantU2 = cu * cu; courantV2 = cv * cv;
+    gamma = std::min(damping * dtSub, 1.0f);
+}
+
+int waveSubsteps(int rows, int cols, float speed, float dt) {
+    float cu = speed * dt * cols, cv = speed * dt * (rows > 1 ? rows - 1 : 1);
+    return std::max(1, (int)ceilf(sqrtf(cu * cu + cv * cv) / kMaxCourant));
+}
+
+void waveKernel(WaveField& f, float cu2, float cv2, float gamma, ThreadPool& pool) {
+    int rows = f.rows, cols = f.cols;
+    int grain = std::max(1, rows / (pool.size() * 4));
+    pool.parallelFor(rows, grain, [&](int r0, int r1) {
+        for (int r = r0; r < r1; ++r) {
+            // mirrored neighbours at the ends: the wave reflects off the top and bottom rings
+            size_t row = (size_t)r * cols;
+            size_t up = (size_t)(r + 1 < rows ? r + 1 : r) * cols, dn = (size_t)(r > 0 ? r - 1 : r) * cols;
+            stepRow(&f.prev[row], &f.cur[row], &f.cur[up], &f.cur[dn], &f.next[row], cols, cu2, cv2, gamma);
+        }
+    });
+}
+
+void stepWaveField(WaveField& f, float dt, double time, ThreadPool& pool) {
+    if (dt <= 0.0f) return;
+    int steps = waveSubsteps(f.rows, f.cols, f.settings.speed, dt);
+    float dtSub = dt / steps;
+    float cu2, cv2, gamma;
+    waveCoefficients(f.rows, f.cols, f.settings.speed, f.settings.damping, dtSub, cu2, cv2, gamma);
+    for (int s = 0; s < steps; ++s) {
+        waveKernel(f, cu2, cv2, gamma, pool);
+        applyEmitters(f, dtSub, time - dt + (s + 1) * (double)dtSub);
+        // rotate prev <- cur <- next without copying
+        std::swap(f.prev, f.cur);
+        std::swap(f.cur, f.next);
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+// === simulated wave field over the sculpture's (u, v) grid ===
+// Damped 2D wave equation, finite differences on rows x cols cells laid out like the mesh (r * cols + c).
+// Periodic in u (around the sculpture), reflective at the top and bottom rings. The field value is the
+// relative radius displacement that makeSculpture() used to get from its single analytic sine.
+#include <vector>
+
+struct ThreadPool;
+
+struct WaveEmitter {
+    float u = 0.0f, v = 0.5f;   // position in parametric space
+    float amplitude = 1.0f;     // source acceleration
+    float frequency = 1.0f;     // Hz
+    float sigma = 0.04f;        // gaussian footprint, parametric units
+};
+
+struct WaveFieldSettings {
+    float speed = 0.35f;        // parametric units per second
+    float damping = 0.6f;       // 1/s
+    std::vector<WaveEmitter> emitters;
+};
+
+struct WaveField {
+    int rows = 0, cols = 0;
+    WaveFieldSettings settings;
+    std::vector<float> prev, cur, next;
+};
+
+// a few emitters that give roughly the amplitude and look of the old travelling wave
+WaveFieldSettings defaultWaveSettings();
+WaveField makeWaveField(int rows, int cols, const WaveFieldSettings& s = defaultWaveSettings());
+
+// substeps needed to keep the explicit scheme stable for this dt
+int waveSubsteps(int rows, int cols, float speed, float dt);
+// per-substep constants shared with the GPU path
+void waveCoefficients(int rows, int cols, float speed, float damping, float dtSub,
+                      float& courantU2, float& courantV2, float& gamma);
+
+// advances by dt (split into substeps); time is the simulation time at the end of the step
+void stepWaveField(WaveField& f, float dt, double time, ThreadPool& pool);
+// one raw substep, no emitters; exposed for benchmarking the kernel alone
+void waveKernel(WaveField& f, float courantU2, float courantV2, float gamma, ThreadPool& pool);
+
+inline const float* waveDisplacement(const WaveField& f) { return f.cur.data(); }